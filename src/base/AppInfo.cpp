@@ -69,12 +69,36 @@ bool AppInfo::ParseAppInfo(Json::Value &root)
         stream_timeout_time = sttObj.asUInt();
     }      
 
+    // 从 JSON 对象中获取 "replica_players" 字段，如果存在，将其值赋给 replica_players
+    Json::Value rpObj = root["replica_players"];
+    if(!rpObj.isNull())
+    {
+        replica_players = rpObj.asUInt();
+    }
+
+    // 从 JSON 对象中获取 "replica_egress_kbps" 字段，如果存在，将其值赋给 replica_egress_kbps，单位为 kbps
+    Json::Value reObj = root["replica_egress_kbps"];
+    if(!reObj.isNull())
+    {
+        replica_egress_kbps = reObj.asUInt();
+    }
+
+    // 从 JSON 对象中获取 "replica_scope" 字段，如果存在，将其值赋给 replica_scope
+    Json::Value rsObj = root["replica_scope"];
+    if(!rsObj.isNull())
+    {
+        replica_scope = rsObj.asString();
+    }
+
     // 输出日志，显示应用程序的相关信息
     LOG_INFO << " app name : " << app_name
             << " max_buffer : " << max_buffer
             << " content_latency : " << content_latency
             << " stream_idle_time : "<< stream_idle_time
             << " stream_timeout_time : " << stream_timeout_time
+            << " replica_players : " << replica_players
+            << " replica_egress_kbps : " << replica_egress_kbps
+            << " replica_scope : " << replica_scope
             << " rtmp_support : " << rtmp_support
             << " flv_support : " << flv_support
             << " hls_support : " << hls_support;
@@ -50,6 +50,15 @@ namespace lss
             
             // 无符号 32 位整型成员变量，表示流的超时时间，单位为毫秒，默认值为 30000 毫秒（30 秒）
             uint32_t stream_timeout_time{30*1000};
+
+            // 播放用户达到该数量时，为其他事件循环上的播放用户创建流的副本，0 表示不按播放用户数量创建
+            uint32_t replica_players{0};
+
+            // 流的码率乘以播放用户数量达到该值时创建流的副本，单位为 kbps，0 表示不按出口带宽创建
+            uint32_t replica_egress_kbps{0};
+
+            // 副本的共享范围，"loop" 每个事件循环一个副本，"node" 同一个 NUMA 节点上的事件循环共享一个副本
+            std::string replica_scope{"loop"};
         };
     }
 }
\ No newline at end of file
@@ -69,6 +69,48 @@ bool Config::LoadConfig(const std::string &file)
         thread_nums_ = threadsObj.asInt();
     }
 
+    // 解析 "poller" 字段，如果存在，设置事件循环使用的多路复用后端（epoll 或 io_uring）
+    Json::Value pollerObj = root["poller"];
+    if (!pollerObj.isNull())
+    {
+        poller_ = pollerObj.asString();
+    }
+
+    // 解析 "placement" 字段，如果存在，设置新连接选择事件循环的策略
+    Json::Value placementObj = root["placement"];
+    if (!placementObj.isNull())
+    {
+        placement_ = placementObj.asString();
+    }
+
+    // 解析 "numa" 字段，如果存在，设置是否按 NUMA 节点分配事件循环的 CPU 和内存
+    Json::Value numaObj = root["numa"];
+    if (!numaObj.isNull())
+    {
+        numa_ = numaObj.asString();
+    }
+
+    // 解析 "reuseport_steering" 字段，如果存在，设置同一端口的监听套接字之间分配新连接的方式
+    Json::Value steeringObj = root["reuseport_steering"];
+    if (!steeringObj.isNull())
+    {
+        reuseport_steering_ = steeringObj.asString();
+    }
+
+    // 解析 "stream_affinity" 字段，如果存在，设置是否把同一个流的连接迁移到同一个事件循环
+    Json::Value affinityObj = root["stream_affinity"];
+    if (!affinityObj.isNull())
+    {
+        stream_affinity_ = affinityObj.asString();
+    }
+
+    // 解析 "affinity_players" 字段，如果存在，设置发布者所在的事件循环上同一个流最多容纳的播放端数量
+    Json::Value affinityPlayersObj = root["affinity_players"];
+    if (!affinityPlayersObj.isNull())
+    {
+        affinity_players_ = affinityPlayersObj.asInt();
+    }
+
     // 解析 "log" 字段，如果日志字段存在，调用 ParseLogInfo 方法解析日志信息
     Json::Value logObj = root["log"];
     if (!logObj.isNull())
@@ -209,9 +251,11 @@ bool Config::ParseServiceInfo(const Json::Value &serviceObj)
         sinfo->port = s.get("port", "0").asInt();
         sinfo->protocol = s.get("protocol", "rtmp").asString();
         sinfo->transport = s.get("transport", "tcp").asString();
+        sinfo->idle_timeout = s.get("idle_timeout", 30).asInt();
+        sinfo->zerocopy_threshold = s.get("zerocopy_threshold", 0).asUInt();
 
         // 记录解析的服务信息
-        LOG_INFO << " service info addr : " << sinfo->addr << " port : " << sinfo->port << " protocol : " << sinfo->protocol << " transport : " << sinfo->transport;
+        LOG_INFO << " service info addr : " << sinfo->addr << " port : " << sinfo->port << " protocol : " << sinfo->protocol << " transport : " << sinfo->transport << " idle_timeout : " << sinfo->idle_timeout << " zerocopy_threshold : " << sinfo->zerocopy_threshold;
 
         // 将解析后的服务信息添加到 services_ 容器中
         services_.emplace_back(sinfo);
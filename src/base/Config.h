@@ -50,6 +50,12 @@ namespace lss
 
             // 服务的传输层协议，例如 "TCP" 或 "UDP"
             string transport;
+
+            // 连接的最大空闲时间，单位：秒，小于等于 0 时不检查空闲超时
+            int32_t idle_timeout{30};
+
+            // 零拷贝发送的阈值，单位：字节，待发送的数据不少于该值时使用 MSG_ZEROCOPY，为 0 时不使用
+            uint32_t zerocopy_threshold{0};
         };
 
         // 使用智能指针来管理 ServiceInfo 对象，避免手动管理内存泄漏
@@ -110,6 +116,24 @@ namespace lss
             // 线程数
             int32_t thread_nums_{1};
 
+            // 事件循环的多路复用后端，"epoll" 或 "io_uring"，io_uring 不可用时退回 epoll
+            std::string poller_{"epoll"};
+
+            // 新连接选择事件循环的策略，"round_robin" 轮询或 "least_loaded" 选择负载最低的事件循环
+            std::string placement_{"round_robin"};
+
+            // 同一端口的多个监听套接字之间分配新连接的方式，"none" 不挂载程序，由内核按哈希分配，"cpu" 由收到 SYN 的 CPU 上的事件循环接受
+            std::string reuseport_steering_{"none"};
+
+            // 是否按 NUMA 节点分配事件循环的 CPU 和内存，"on" 或 "off"
+            std::string numa_{"off"};
+
+            // 流的亲和性，"none" 不迁移连接，"publisher" 在播放或发布命令之后把同一个流的播放端和发布端迁移到同一个事件循环
+            std::string stream_affinity_{"none"};
+
+            // 按流的亲和性迁移时，发布者所在的事件循环上同一个流最多容纳的播放端数量，超出的播放端留在线程池分配的事件循环上，为 0 时不限制
+            int32_t affinity_players_{0};
+
             // CPU数
             int32_t cpus_{1};
 
@@ -0,0 +1,90 @@
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/mempolicy.h>
+#include "NumaUtils.h"
+#include "StringUtils.h"
+
+using namespace lss::base;
+
+namespace
+{
+    // 每个节点包含的 CPU，下标为节点编号
+    std::vector<std::vector<int>> load_nodes()
+    {
+        std::vector<std::vector<int>> nodes;
+        for (int node = 0; ; node++)
+        {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!in)
+            {
+                break;
+            }
+
+            // 格式如 "0-3,8-11"
+            std::string line;
+            std::getline(in, line);
+
+            std::vector<int> cpus;
+            for (auto &range : StringUtils::SplitString(line, ","))
+            {
+                if (range.empty())
+                {
+                    continue;
+                }
+
+                auto pos = range.find('-');
+                int first = std::stoi(range.substr(0, pos));
+                int last = pos == std::string::npos ? first : std::stoi(range.substr(pos + 1));
+                for (int cpu = first; cpu <= last; cpu++)
+                {
+                    cpus.push_back(cpu);
+                }
+            }
+            nodes.push_back(std::move(cpus));
+        }
+
+        return nodes;
+    }
+
+    // 节点信息在进程运行期间不变，只读取一次
+    const std::vector<std::vector<int>> &nodes()
+    {
+        static std::vector<std::vector<int>> nodes = load_nodes();
+        return nodes;
+    }
+}
+
+int NumaUtils::Nodes()
+{
+    return nodes().empty() ? 1 : static_cast<int>(nodes().size());
+}
+
+int NumaUtils::NodeOfCpu(int cpu)
+{
+    auto &list = nodes();
+    for (size_t node = 0; node < list.size(); node++)
+    {
+        for (auto c : list[node])
+        {
+            if (c == cpu)
+            {
+                return static_cast<int>(node);
+            }
+        }
+    }
+
+    return -1;
+}
+
+bool NumaUtils::PreferNode(int node)
+{
+    if (node < 0 || node >= 64)
+    {
+        return false;
+    }
+
+    unsigned long mask = 1UL << node;
+    return ::syscall(SYS_set_mempolicy, MPOL_PREFERRED, &mask, sizeof(mask) * 8) == 0;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+
+namespace lss
+{
+    namespace base
+    {
+        // NUMA 节点信息，从 /sys/devices/system/node 读取，不依赖 libnuma
+        class NumaUtils
+        {
+        public:
+            // 在线的 NUMA 节点数量，读取失败时为 1
+            static int Nodes();
+
+            // CPU 所在的 NUMA 节点，未知时返回 -1
+            static int NodeOfCpu(int cpu);
+
+            // 当前线程之后分配的内存优先放在 node 节点上，成功返回 true
+            // 线程已经绑定在该节点的 CPU 上时，缺页时本来就在本地分配，显式设置之后 malloc 复用的内存也不会落到远端
+            static bool PreferNode(int node);
+        };
+    }
+}
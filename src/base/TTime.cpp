@@ -21,6 +21,15 @@ int64_t TTime::Now()
     return tv.tv_sec;
 }
 
+// 单调时钟，单位：ns
+int64_t TTime::MonotonicNS()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
 // 表示当前时间，返回当前的年月日时分秒
 int64_t TTime::Now(int& year, int& month, int& day, int& hour, int& minute, int& second)
 {
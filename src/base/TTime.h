@@ -17,6 +17,9 @@ namespace lss
             // 表示当前UTC时间，单位：s
             static int64_t Now();
 
+            // 单调时钟，不受系统时间调整的影响，用于计算时间间隔，单位：ns
+            static int64_t MonotonicNS();
+
             // 表示当前时间，返回当前的年月日时分秒
             static int64_t Now(int& year, int& month, int& day, int& hour, int& minute, int& second);
             
@@ -15,76 +15,45 @@ CodecHeader::CodecHeader()
 
 PacketPtr CodecHeader::Meta(int idx)
 {
-    // 如果传入的索引小于等于0，直接返回当前保存的meta_元数据包
-    if (idx <= 0)
-    {
-        return meta_;
-    }
-
-    // 反向迭代meta_packets_，从最后一个元素开始
-    auto iter = meta_packets_.rbegin();
-
-    // 遍历meta_packets_，找到索引小于等于idx的包
-    for (; iter != meta_packets_.rend(); iter++)
-    {
-        // 获取当前包
-        PacketPtr pkt = *iter;
-
-        // 如果当前包的索引小于等于传入的idx，则返回该包
-        if (pkt->Index() <= idx)
-        {
-            return pkt;
-        }
-    }
-
-    // 如果遍历完所有包都没有找到，返回meta_
-    return meta_;
+    // 在元数据包环形缓冲区中查找
+    return FindHeader(meta_packets_, meta_version_, idx);
 }
 
 PacketPtr CodecHeader::VideoHeader(int idx)
 {
-    // 如果传入的索引小于等于0，直接返回当前保存的视频头信息包
-    if (idx <= 0)
-    {
-        return video_header_;
-    }
-
-    // 反向迭代video_header_packets_，从最后一个元素开始
-    auto iter = video_header_packets_.rbegin();
-
-    // 遍历video_header_packets_，找到索引小于等于idx的包
-    for (; iter != video_header_packets_.rend(); iter++)
-    {
-        // 获取当前包
-        PacketPtr pkt = *iter;
-
-        // 如果当前包的索引小于等于传入的idx，则返回该包
-        if (pkt->Index() <= idx)
-        {
-            return pkt;
-        }
-    }
-
-    // 如果遍历完所有包都没有找到，返回video_header_
-    return video_header_;
+    // 在视频头信息包环形缓冲区中查找
+    return FindHeader(video_header_packets_, video_version_, idx);
 }
 
 PacketPtr CodecHeader::AudioHeader(int idx)
 {
-    // 如果传入的索引小于等于0，直接返回当前保存的音频头信息包
+    // 在音频头信息包环形缓冲区中查找
+    return FindHeader(audio_header_packets_, audio_version_, idx);
+}
+
+PacketPtr CodecHeader::FindHeader(const FrameRing &packets, const std::atomic<int> &version, int idx) const
+{
+    // 获取当前版本号，版本号即最新头信息包在环形缓冲区中的序号
+    int latest = version.load(std::memory_order_acquire);
+
+    // 获取最新的头信息包
+    PacketPtr latest_pkt = packets.Get(latest);
+
+    // 如果传入的索引小于等于0，直接返回最新的头信息包
     if (idx <= 0)
     {
-        return audio_header_;
+        return latest_pkt;
     }
 
-    // 反向迭代audio_header_packets_，从最后一个元素开始
-    auto iter = audio_header_packets_.rbegin();
-
-    // 遍历audio_header_packets_，找到索引小于等于idx的包
-    for (; iter != audio_header_packets_.rend(); iter++)
+    // 从最新的版本开始向前查找，最多查找一个窗口
+    for (int v = latest; v > 0 && latest - v < (int)packets.Window(); v--)
     {
-        // 获取当前包
-        PacketPtr pkt = *iter;
+        // 获取对应版本的包，已被覆盖则停止查找
+        PacketPtr pkt = packets.Get(v);
+        if (!pkt)
+        {
+            break;
+        }
 
         // 如果当前包的索引小于等于传入的idx，则返回该包
         if (pkt->Index() <= idx)
@@ -93,23 +62,21 @@ PacketPtr CodecHeader::AudioHeader(int idx)
         }
     }
 
-    // 如果遍历完所有包都没有找到，返回audio_header_
-    return audio_header_;
+    // 如果没有找到，返回最新的头信息包
+    return latest_pkt;
 }
 
 void CodecHeader::SaveMeta(const PacketPtr &packet)
 {
-    // 将传入的元数据包保存到成员变量meta_
-    meta_ = packet;
-
-    // 增加元数据版本号
-    ++ meta_version_;
+    // 新版本号即该包在环形缓冲区中的序号
+    int version = meta_version_.load(std::memory_order_relaxed) + 1;
 
-    // 将元数据包添加到meta_packets_列表中
-    meta_packets_.emplace_back(packet);
+    // 先写入环形缓冲区，再发布版本号，读者看到新版本号时一定能读到该包
+    meta_packets_.Push(version, packet);
+    meta_version_.store(version, std::memory_order_release);
 
     // 输出保存元数据的日志信息
-    LIVE_TRACE << " save meta, meta version : " << meta_version_
+    LIVE_TRACE << " save meta, meta version : " << version
                 << " , size : " << packet->PacketSize()
                 << " , elapse : " << TTime::NowMS() - start_timestamp_ << " ms\n";
 }
@@ -221,34 +188,30 @@ void CodecHeader::ParseMeta(const PacketPtr &packet)
 
 void CodecHeader::SaveAudioHeader(const PacketPtr &packet)
 {
-    // 将传入的音频头信息包保存到成员变量audio_header_
-    audio_header_ = packet;
+    // 新版本号即该包在环形缓冲区中的序号
+    int version = audio_version_.load(std::memory_order_relaxed) + 1;
 
-    // 增加音频头信息的版本号
-    ++ audio_version_;
-
-    // 将音频头信息包添加到audio_header_packets_列表中
-    audio_header_packets_.emplace_back(packet);
+    // 先写入环形缓冲区，再发布版本号，读者看到新版本号时一定能读到该包
+    audio_header_packets_.Push(version, packet);
+    audio_version_.store(version, std::memory_order_release);
 
     // 输出保存音频头信息的日志信息
-    LIVE_TRACE << " save audio header, version : " << audio_version_
+    LIVE_TRACE << " save audio header, version : " << version
                 << " , size : " << packet->PacketSize()
                 << " , elapse : " << TTime::NowMS() - start_timestamp_ << " ms\n";
 }
 
 void CodecHeader::SaveVideoHeader(const PacketPtr &packet)
 {
-    // 将传入的视频头信息包保存到成员变量video_header_
-    video_header_ = packet;
-
-    // 增加视频头信息的版本号
-    ++ video_version_;
+    // 新版本号即该包在环形缓冲区中的序号
+    int version = video_version_.load(std::memory_order_relaxed) + 1;
 
-    // 将视频头信息包添加到video_header_packets_列表中
-    video_header_packets_.emplace_back(packet);
+    // 先写入环形缓冲区，再发布版本号，读者看到新版本号时一定能读到该包
+    video_header_packets_.Push(version, packet);
+    video_version_.store(version, std::memory_order_release);
 
     // 输出保存视频头信息的日志信息
-    LIVE_TRACE << " save video header, version : " << video_version_
+    LIVE_TRACE << " save video header, version : " << version
                 << " , size : " << packet->PacketSize()
                 << " , elapse : " << TTime::NowMS()-start_timestamp_ << " ms\n";
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include "mmedia/base/Packet.h"
-#include <vector>
+#include "live/base/FrameRing.h"
+#include <atomic>
 #include <memory>
 #include <cstdint>
 
@@ -11,6 +12,7 @@ namespace lss
         using namespace lss::mm;
 
         // CodecHeader类，处理音视频编解码相关的头信息
+        // 保存头信息只由推流所在的事件循环调用，查询头信息可以被任意播放线程无锁调用
         class CodecHeader
         {
         public:
@@ -45,32 +47,29 @@ namespace lss
             ~CodecHeader();
 
         private:
-            // 存储视频头信息的包
-            PacketPtr video_header_;
+            // 在头信息包环形缓冲区中查找索引不大于idx的最新包，找不到时返回最新的包
+            PacketPtr FindHeader(const FrameRing &packets, const std::atomic<int> &version, int idx) const;
 
-            // 存储音频头信息的包
-            PacketPtr audio_header_;
+            // 每种头信息最多保留的历史版本数量
+            static const uint32_t kMaxHeaderPackets = 16;
 
-            // 存储元数据包
-            PacketPtr meta_;
+            // 元数据版本号，同时也是最新元数据包在环形缓冲区中的序号
+            std::atomic<int> meta_version_{0};
 
-            // 元数据版本号
-            int meta_version_{0};
+            // 音频头信息版本号，同时也是最新音频头信息包在环形缓冲区中的序号
+            std::atomic<int> audio_version_{0};
 
-            // 音频头信息版本号
-            int audio_version_{0};
+            // 视频头信息版本号，同时也是最新视频头信息包在环形缓冲区中的序号
+            std::atomic<int> video_version_{0};
 
-            // 视频头信息版本号
-            int video_version_{0};
+            // 存储多个视频头信息包，推流写入，播放无锁读取
+            FrameRing video_header_packets_{kMaxHeaderPackets};
 
-            // 存储多个视频头信息包
-            std::vector<PacketPtr> video_header_packets_;
+            // 存储多个音频头信息包，推流写入，播放无锁读取
+            FrameRing audio_header_packets_{kMaxHeaderPackets};
 
-            // 存储多个音频头信息包
-            std::vector<PacketPtr> audio_header_packets_;
-
-            // 存储多个元数据包
-            std::vector<PacketPtr> meta_packets_;
+            // 存储多个元数据包，推流写入，播放无锁读取
+            FrameRing meta_packets_{kMaxHeaderPackets};
 
             // 编解码开始的时间戳
             int64_t start_timestamp_{0};
@@ -11,8 +11,26 @@ void GopMgr::AddFrame(const PacketPtr &packet)
     // 如果当前数据包是关键帧
     if (packet->IsKeyFrame())
     {
-        // 将关键帧的索引和时间戳添加到 gops_ 向量中
-        gops_.emplace_back(packet->Index(), packet->TimeStamp());
+        // 获取写入位置
+        auto head = head_.load(std::memory_order_relaxed);
+
+        // 环形数组已满，丢弃最旧的 GOP
+        if (head - tail_.load(std::memory_order_relaxed) >= kMaxGops)
+        {
+            tail_.fetch_add(1, std::memory_order_release);
+        }
+
+        // 写入位置 head 的槽位就是位置 head - kMaxGops 的旧项，此时 head_ 仍然是 head
+        // 写之前的 release 栅栏与读者的 acquire 栅栏配对：读者读到本次写入的值时，随后一定能看到 head_ 已经到达 head，从而丢弃该项
+        std::atomic_thread_fence(std::memory_order_release);
+
+        // 将关键帧的索引和时间戳写入环形数组
+        GopItemInfo &item = gops_[head % kMaxGops];
+        item.index.store(packet->Index(), std::memory_order_relaxed);
+        item.timestamp.store(packet->TimeStamp(), std::memory_order_relaxed);
+
+        // 发布新的 GOP，读者看到新的写入位置时一定能看到完整的 GOP 项
+        head_.store(head + 1, std::memory_order_release);
 
         // 更新最大 GOP 长度
         max_gop_length_ = std::max(max_gop_length_, gop_length_);
@@ -39,8 +57,8 @@ int32_t GopMgr::MaxGopLength() const
 
 size_t GopMgr::GopSize() const
 {
-    // 返回 gops_ 向量的大小
-    return gops_.size();
+    // 返回环形数组中有效 GOP 的数量
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
 }
 
 int GopMgr::GetGopByLatency(int content_latency, int &latency) const
@@ -51,20 +69,38 @@ int GopMgr::GetGopByLatency(int content_latency, int &latency) const
     // 初始化延迟为 0
     latency = 0;
 
-    // 从 gops_ 向量的末尾开始迭代
-    auto iter = gops_.rbegin();
+    // 获取当前的写入位置和最旧的有效位置
+    auto head = head_.load(std::memory_order_acquire);
+    auto tail = tail_.load(std::memory_order_acquire);
 
-    // 遍历 gops_ 向量
-    for (; iter != gops_.rend(); ++iter)
+    // 获取最新时间戳
+    int64_t lastest = lastest_timestamp_.load(std::memory_order_relaxed);
+
+    // 从最新的 GOP 开始向前遍历
+    for (auto i = head - 1; i >= tail; --i)
     {
+        const GopItemInfo &item = gops_[i % kMaxGops];
+
+        // 读取 GOP 项
+        int32_t index = item.index.load(std::memory_order_relaxed);
+        int64_t timestamp = item.timestamp.load(std::memory_order_relaxed);
+
+        // 读取期间该项可能正在被推流覆盖，之后的项都不可信，结束循环
+        // 推流覆盖位置 i 的槽位时 head_ 已经是 i + kMaxGops，还没有发布 i + kMaxGops + 1，所以相等时也要丢弃
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (head_.load(std::memory_order_relaxed) - i >= kMaxGops)
+        {
+            break;
+        }
+
         // 计算当前 GOP 项的延迟
-        int item_latency = lastest_timestamp_ - iter->timestamp;
+        int item_latency = lastest - timestamp;
 
         // 如果当前 GOP 项的延迟在内容延迟范围内
         if (item_latency <= content_latency)
         {
             // 记录 GOP 索引
-            got = iter->index;
+            got = index;
 
             // 更新延迟值
             latency = item_latency;
@@ -82,28 +118,18 @@ int GopMgr::GetGopByLatency(int content_latency, int &latency) const
 
 void GopMgr::ClearExpriedGop(int min_idx)
 {
-    // 如果 gops_ 向量为空
-    if (gops_.empty())
-    {
-        // 直接返回
-        return;
-    }
+    // 获取当前的写入位置和最旧的有效位置
+    auto head = head_.load(std::memory_order_relaxed);
+    auto tail = tail_.load(std::memory_order_relaxed);
 
-    // 遍历 gops_ 向量
-    for (auto iter = gops_.begin(); iter != gops_.end();)
+    // 从最旧的 GOP 开始，跳过索引小于等于最小索引的项
+    while (tail < head && gops_[tail % kMaxGops].index.load(std::memory_order_relaxed) <= min_idx)
     {
-        // 如果当前 GOP 项的索引小于等于最小索引
-        if (iter->index <= min_idx)
-        {
-            // 删除当前 GOP 项，并更新迭代器
-            iter = gops_.erase(iter);
-        }
-        else 
-        {
-            // 否则，移动到下一个 GOP 项
-            iter++;
-        }
+        ++tail;
     }
+
+    // 发布新的最旧位置
+    tail_.store(tail, std::memory_order_release);
 }
 
 void GopMgr::PrintAllGop()
@@ -114,13 +140,13 @@ void GopMgr::PrintAllGop()
     // 添加标题到字符串流
     ss << "All gop : ";
 
-    // 遍历 gops_ 向量
-    for (auto iter = gops_.begin(); iter != gops_.end(); iter++)
+    // 遍历环形数组中的有效 GOP
+    for (auto i = tail_.load(); i < head_.load(); i++)
     {
         // 将每个 GOP 项的索引和时间戳添加到字符串流
-        ss << "[" << iter->index << ", " << iter->timestamp << "]";
+        ss << "[" << gops_[i % kMaxGops].index << ", " << gops_[i % kMaxGops].timestamp << "]";
     }
 
     // 将字符串流的内容输出到日志中
     LIVE_TRACE << ss.str() << "\n";
-}
\ No newline at end of file
+}
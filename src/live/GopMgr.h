@@ -1,5 +1,5 @@
 #pragma once
-#include <vector>
+#include <atomic>
 #include <memory>
 #include <cstdint>
 #include "mmedia/base/Packet.h"
@@ -10,26 +10,24 @@ namespace lss
     {
         using namespace lss::mm;
 
-        // 定义结构体 GopItemInfo
+        // 定义结构体 GopItemInfo，字段为原子变量，读者可以在推流写入的同时无锁读取
         struct GopItemInfo
         {
             // GOP 项的索引
-            int32_t index;
+            std::atomic<int32_t> index{-1};
 
             // GOP 项的时间戳
-            int64_t timestamp;
-
-            // 构造函数，初始化索引和时间戳
-            GopItemInfo(int32_t i, int64_t t)
-                : index(i), timestamp(t)
-            {
-
-            }
+            std::atomic<int64_t> timestamp{0};
         };
 
         // 定义类 GopMgr
+        // 单生产者多消费者：AddFrame 和 ClearExpriedGop 只由推流所在的事件循环调用，
+        // GetGopByLatency、GopSize 和 LastestTimeStamp 可以被任意播放线程无锁调用
         class GopMgr
         {
+            // GOP 环形数组的容量，超过容量时丢弃最旧的 GOP
+            static const int32_t kMaxGops = 1024;
+
         public:
             // 默认构造函数
             GopMgr() = default;
@@ -63,8 +61,14 @@ namespace lss
             ~GopMgr(){};
 
         private:
-            // 存储 GOP 项的 vector
-            std::vector<GopItemInfo> gops_;
+            // 存储 GOP 项的环形数组
+            GopItemInfo gops_[kMaxGops];
+
+            // 下一个 GOP 的写入位置，只增不减
+            std::atomic<int64_t> head_{0};
+
+            // 最旧的有效 GOP 位置，只增不减
+            std::atomic<int64_t> tail_{0};
 
             // 当前 GOP 长度
             int32_t gop_length_{0};
@@ -79,7 +83,7 @@ namespace lss
             int32_t total_gop_length_{0};
 
             // 最新时间戳
-            int64_t lastest_timestamp_{0};
+            std::atomic<int64_t> lastest_timestamp_{0};
         };
 
     }
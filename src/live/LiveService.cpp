@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <future>
 #include "LiveService.h"
 #include "base/StringUtils.h"
 #include "live/base/LiveLog.h"
 #include "mmedia/rtmp/RtmpServer.h"
+#include "mmedia/base/PacketPool.h"
 #include "base/Config.h"
 #include "Session.h"
 #include "base/TTime.h"
@@ -15,6 +18,12 @@ namespace
 {
     // 声明一个静态智能指针 session_null，用于表示空会话
     static SessionPtr session_null;
+
+    // 播放连接发送队列的低水位，积压回落到该值以下时恢复发送
+    static const size_t kPlayerLowWaterMark = 64 * 1024;
+
+    // 播放连接发送队列的高水位，积压超过该值时认为播放端跟不上
+    static const size_t kPlayerHighWaterMark = 1024 * 1024;
 }
 
 SessionPtr LiveService::CreateSession(const std::string &session_name)
@@ -154,11 +163,22 @@ void LiveService::OnTimer(const TaskPtr &t)
         }
         else
         {
+            // 码率变化之后可能成为热点流
+            iter->second->CheckHotStream();
+
             // 继续遍历下一个会话
             iter ++;
         }
     }
 
+    // 输出数据包内存池的统计，用于调整大小级别
+    auto stats = PacketPool::Stats();
+    LIVE_DEBUG << " packet pool hits : " << stats.hits
+                << " , misses : " << stats.misses
+                << " , remote frees : " << stats.remote_frees
+                << " , bytes held : " << stats.bytes_held
+                << " , oversize : " << stats.oversize;
+
     // 重启定时任务
     t->Restart();
 }
@@ -182,8 +202,8 @@ void LiveService::OnConnectionDestroy(const TcpConnectionPtr &conn)
 
 void LiveService::OnActive(const ConnectionPtr &conn)
 {
-    // 从连接上下文中获取玩家用户信息
-    auto user = conn->GetContext<PlayerUser>(kUserContext);
+    // 从连接上下文中获取玩家用户信息，每次发送完成都会调用，直接访问槽位
+    auto user = conn->Context<PlayerUser>(kUserContext);
 
     // 如果找到了用户且用户类型满足条件
     if (user && user->GetUserType() >= UserType::kUserTypePlayerPav)
@@ -241,8 +261,43 @@ bool LiveService::OnPlay(const TcpConnectionPtr &conn, const std::string &sessio
     // 将用户上下文设置到连接中
     conn->SetContext(kUserContext, user);
 
+    auto player = std::dynamic_pointer_cast<PlayerUser>(user);
+
+    // 根据发送队列的实际积压判断播放端是否跟得上，越过高水位时停止取新帧，回落到低水位时恢复
+    std::weak_ptr<PlayerUser> weak_player = player;
+    conn->SetWaterMark(kPlayerLowWaterMark, kPlayerHighWaterMark);
+    conn->SetHighWaterMarkCallback([weak_player](const TcpConnectionPtr &c){
+        auto p = weak_player.lock();
+        if (p)
+        {
+            p->SetCongested(true);
+        }
+    });
+    conn->SetLowWaterMarkCallback([weak_player](const TcpConnectionPtr &c){
+        auto p = weak_player.lock();
+        if (p)
+        {
+            p->SetCongested(false);
+            p->Active();
+        }
+    });
+
+    // 按流的亲和性把播放端迁移到发布者所在的事件循环，迁移完成后再加入会话，之后的帧都在本地分发
+    // 播放端按所在的事件循环分组，必须在迁移之后加入，迁移失败时留在原来的事件循环
+    EventLoop *loop = stream_affinity_ ? s->PlayerAffinityLoop(affinity_players_) : nullptr;
+    if (loop && loop != conn->Loop())
+    {
+        bool migrating = MigrateConnection(conn, loop, [s, player](bool ok){
+            s->AddPlayer(player);
+        });
+        if (migrating)
+        {
+            return true;
+        }
+    }
+
     // 将用户添加到会话的播放器列表中
-    s->AddPlayer(std::dynamic_pointer_cast<PlayerUser>(user));
+    s->AddPlayer(player);
 
     // 返回成功
     return true;     
@@ -294,14 +349,26 @@ bool LiveService::OnPublish(const TcpConnectionPtr &conn, const std::string &ses
     // 将用户设置为会话的发布者
     s->SetPublisher(user);
 
+    // 按流的亲和性把发布端迁移到本会话播放端最多的事件循环，先到的播放端之后的帧在本地分发
+    EventLoop *loop = stream_affinity_ ? s->PublisherAffinityLoop() : nullptr;
+    if (loop && loop != conn->Loop())
+    {
+        MigrateConnection(conn, loop, [s, user, loop](bool ok){
+            if (ok)
+            {
+                s->SetPublisherLoop(user, loop);
+            }
+        });
+    }
+
     // 返回成功
     return true;
 }
 
 void LiveService::OnRecv(const TcpConnectionPtr &conn, PacketPtr &&data) 
 {
-    // 从连接上下文中获取用户信息
-    auto user = conn->GetContext<User>(kUserContext);
+    // 从连接上下文中获取用户信息，每个数据包都会调用，直接访问槽位
+    auto user = conn->Context<User>(kUserContext);
 
     // 如果未找到用户
     if (!user)
@@ -326,7 +393,11 @@ void LiveService::Start()
     ConfigPtr config = configManager->GetConfig();
 
     // 创建事件循环线程池
-    pool_ = new EventLoopThreadPool(config->thread_nums_, config->cpu_start_, config->cpus_);
+    pool_ = new EventLoopThreadPool(config->thread_nums_, config->cpu_start_, config->cpus_, Poller::ParseType(config->poller_), config->numa_ == "on");
+
+    // 设置新连接选择事件循环的策略
+    LoopPlacement placement = EventLoopThreadPool::ParsePlacement(config->placement_);
+    pool_->SetPlacement(placement);
     
     // 启动线程池
     pool_->Start();
@@ -338,14 +409,26 @@ void LiveService::Start()
     auto eventloops = pool_->GetLoops();
 
     // 记录事件循环的数量
-    LIVE_TRACE << " eventloops size : " << eventloops.size();
+    LIVE_TRACE << " eventloops size : " << eventloops.size() << " placement : " << config->placement_;
+
+    // 每个服务在各个事件循环上的服务实例，按负载分配连接和按流迁移连接时在同一服务的实例之间转交
+    for (size_t i = 0; i < services.size(); i++)
+    {
+        groups_.emplace_back(std::make_shared<std::vector<TcpServer*>>());
+    }
+
+    // 按流的亲和性迁移连接
+    stream_affinity_ = config->stream_affinity_ == "publisher";
+    affinity_players_ = config->affinity_players_ > 0 ? config->affinity_players_ : 0;
 
     // 遍历每个事件循环
     for (auto &el : eventloops)
     {
         // 遍历每个服务信息
-        for(auto &s : services)
+        for (size_t i = 0; i < services.size(); i++)
         {
+            auto &s = services[i];
+
             // 如果服务协议是 RTMP
             if (s->protocol == "RTMP" || s->protocol == "rtmp")
             {
@@ -355,14 +438,77 @@ void LiveService::Start()
                 // 创建 RTMP 服务器实例
                 TcpServer *server = new RtmpServer(el, local, this);
 
+                // 设置该服务连接的最大空闲时间
+                server->SetIdleTimeout(s->idle_timeout);
+
+                // 设置该服务连接零拷贝发送的阈值
+                server->SetZeroCopyThreshold(s->zerocopy_threshold);
+
                 // 将服务器实例添加到服务器列表
                 servers_.push_back(server);
+                groups_[i]->push_back(server);
+            }
+        }
+    }
 
-                // 启动该服务器
-                servers_.back()->Start();
+    // 按 CPU 分配新连接，需要每个事件循环都绑定了 CPU
+    auto cpus = pool_->GetCpus();
+    bool steering = config->reuseport_steering_ == "cpu"
+                    && std::find(cpus.begin(), cpus.end(), -1) == cpus.end();
+
+    // 按负载分配时，任何一个实例接受的连接都交给线程池选出的事件循环上的同一服务的实例
+    // 按 CPU 分配时连接留在收到 SYN 的 CPU 上的事件循环，不再转交
+    if (placement == kPlacementLeastLoaded && !steering)
+    {
+        EventLoopThreadPool *pool = pool_;
+        for (auto &group : groups_)
+        {
+            for (auto server : *group)
+            {
+                server->SetServerSelector([pool, group]() -> TcpServer * {
+                    EventLoop *loop = pool->GetNextLoop();
+                    for (auto target : *group)
+                    {
+                        if (target->Loop() == loop)
+                        {
+                            return target;
+                        }
+                    }
+                    return nullptr;
+                });
             }
         }
     }
+
+    // 按 CPU 分配新连接时，内核按加入监听组的顺序给监听套接字编号，每个服务的实例依次在自己的事件循环中启动，
+    // 前一个开始监听之后再启动下一个，编号与事件循环的顺序一致，才能按事件循环绑定的 CPU 生成选择程序
+    if (steering)
+    {
+        for (auto &group : groups_)
+        {
+            for (auto server : *group)
+            {
+                server->SetReuseportCpus(cpus);
+
+                std::promise<void> listened;
+                server->Loop()->RunInLoop([server, &listened](){
+                    server->Start();
+                    listened.set_value();
+                });
+                listened.get_future().wait();
+            }
+        }
+    }
+    else
+    {
+        // 所有实例准备好之后再启动，避免连接转交给尚未设置完成的实例
+        for (auto server : servers_)
+        {
+            server->Start();
+        }
+    }
+
+    LIVE_TRACE << " reuseport steering : " << (steering ? "cpu" : "none");
     
     // 创建一个定时任务，定期调用 OnTimer 方法
     TaskPtr t = std::make_shared<Task>(std::bind(&LiveService::OnTimer, this, std::placeholders::_1), 5000);
@@ -376,6 +522,40 @@ void LiveService::Stop()
 
 }
 
+bool LiveService::MigrateConnection(const TcpConnectionPtr &conn, EventLoop *loop, const MigrateCallback &done)
+{
+    // 连接的本地地址就是接受它的服务的监听地址，据此找到连接所在的服务实例和目标事件循环上的同一服务的实例
+    std::string local = conn->LocalAddr().ToIpPort();
+    for (auto &group : groups_)
+    {
+        TcpServer *source = nullptr;
+        TcpServer *target = nullptr;
+        for (auto server : *group)
+        {
+            if (server->Addr().ToIpPort() != local)
+            {
+                break;
+            }
+            if (server->Loop() == conn->Loop())
+            {
+                source = server;
+            }
+            if (server->Loop() == loop)
+            {
+                target = server;
+            }
+        }
+
+        if (source && target)
+        {
+            source->MigrateConnection(conn, target, done);
+            return true;
+        }
+    }
+
+    return false;
+}
+
 EventLoop *LiveService::GetNextLoop()
 {
     // 从线程池中获取下一个事件循环
@@ -75,6 +75,10 @@ namespace lss
             // 获取下一个事件循环，用于处理不同的连接
             EventLoop *GetNextLoop();
 
+            // 把连接迁移到 loop 上同一服务的实例，只能在连接所在的事件循环线程中调用
+            // 找不到对应的服务实例时返回 false，否则 done 在连接最终所在的事件循环中调用
+            bool MigrateConnection(const TcpConnectionPtr &conn, EventLoop *loop, const MigrateCallback &done);
+
             // 默认析构函数
             ~LiveService() = default;
 
@@ -85,6 +89,15 @@ namespace lss
             // 保存所有的 TCP 服务器实例
             std::vector<TcpServer*> servers_;
 
+            // 每个服务在各个事件循环上的服务实例，连接只在同一服务的实例之间转交
+            std::vector<std::shared_ptr<std::vector<TcpServer*>>> groups_;
+
+            // 是否在播放或发布命令之后把同一个流的连接迁移到同一个事件循环
+            bool stream_affinity_{false};
+
+            // 发布者所在的事件循环上同一个流最多容纳的播放端数量，为 0 时不限制
+            size_t affinity_players_{0};
+
             // 互斥锁，用于保护共享资源
             std::mutex lock_;
 
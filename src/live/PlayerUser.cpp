@@ -48,4 +48,16 @@ TimeCorrector &PlayerUser::GetTimeCorrector()
 {
     // 返回时间校正器的引用
     return time_corrector_;
+}
+
+void PlayerUser::SetCongested(bool congested)
+{
+    // 更新拥塞标志
+    congested_ = congested;
+}
+
+bool PlayerUser::Congested() const
+{
+    // 返回拥塞标志
+    return congested_;
 }
\ No newline at end of file
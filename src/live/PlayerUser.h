@@ -44,6 +44,12 @@ namespace lss
             // 获取时间校正器的引用
             TimeCorrector &GetTimeCorrector();
 
+            // 设置连接是否拥塞，由发送队列的高低水位回调调用
+            void SetCongested(bool congested);
+
+            // 连接是否拥塞
+            bool Congested() const;
+
         protected:
             // 视频头信息的指针
             PacketPtr video_header_; 
@@ -89,6 +95,9 @@ namespace lss
 
             // 输出索引，默认为 -1
             int32_t out_index_{-1};
+
+            // 连接的发送队列越过高水位且尚未回落，拥塞期间不再取新帧
+            bool congested_{false};
         };
     }
 }
\ No newline at end of file
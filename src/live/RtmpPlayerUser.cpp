@@ -10,7 +10,26 @@ using namespace lss::mm;
 RtmpPlayerUser::RtmpPlayerUser(const ConnectionPtr &ptr, const StreamPtr &stream, const SessionPtr &s)
     : PlayerUser(ptr, stream, s)        // 初始化基类 PlayerUser，传递连接、流和会话的智能指针
 {
+    // 获取当前连接的 RTMP 上下文
+    auto cx = ptr->GetContext<RtmpContext>(kRtmpContext);
+
+    // 播放者共享流的分块缓存，同一个数据包只分块一次
+    if (cx && stream)
+    {
+        cx->SetChunkCache(stream->GetChunkCache());
+    }
+}
+
+void RtmpPlayerUser::SetStream(const StreamPtr &stream)
+{
+    PlayerUser::SetStream(stream);
 
+    // 分块缓存与流的数据包缓冲区一一对应，必须跟着流一起切换
+    auto cx = connection_->GetContext<RtmpContext>(kRtmpContext);
+    if (cx && stream)
+    {
+        cx->SetChunkCache(stream->GetChunkCache());
+    }
 }
 
 bool RtmpPlayerUser::PostFrames()
@@ -22,8 +41,8 @@ bool RtmpPlayerUser::PostFrames()
         return false;
     }
 
-    // 从流中获取帧，使用动态类型转换将当前对象转换为 PlayerUser
-    stream_->GetFrames(std::dynamic_pointer_cast<PlayerUser>(shared_from_this()));
+    // 从流中获取帧，当前对象一定是 PlayerUser，使用静态类型转换
+    stream_->GetFrames(std::static_pointer_cast<PlayerUser>(shared_from_this()));
     
     // 如果存在元数据
     if (meta_)
@@ -102,8 +121,8 @@ UserType RtmpPlayerUser::GetUserType() const
 
 bool RtmpPlayerUser::PushFrame(PacketPtr &packet,bool is_header)
 {
-    // 获取当前连接的 RTMP 上下文
-    auto cx = connection_->GetContext<RtmpContext>(kRtmpContext);
+    // 获取当前连接的 RTMP 上下文，每帧都会调用，直接访问槽位，不增加引用计数
+    auto cx = connection_->Context<RtmpContext>(kRtmpContext);
 
     // 检查上下文是否有效且已准备好
     if (!cx || !cx->Ready())
@@ -133,8 +152,8 @@ bool RtmpPlayerUser::PushFrame(PacketPtr &packet,bool is_header)
 
 bool RtmpPlayerUser::PushFrames(std::vector<PacketPtr> &list)
 {
-    // 获取当前连接的 RTMP 上下文
-    auto cx = connection_->GetContext<RtmpContext>(kRtmpContext);
+    // 获取当前连接的 RTMP 上下文，每帧都会调用，直接访问槽位，不增加引用计数
+    auto cx = connection_->Context<RtmpContext>(kRtmpContext);
 
     // 检查上下文是否有效且已准备好
     if (!cx || !cx->Ready())
@@ -18,6 +18,9 @@ namespace lss
             // 获取用户类型
             UserType GetUserType() const;
 
+            // 切换读取的流，同时切换到新流的分块缓存
+            void SetStream(const StreamPtr &stream) override;
+
         private:
             // 使用基类的 SetUserType 方法
             using User::SetUserType;
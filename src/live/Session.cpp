@@ -192,6 +192,7 @@ void Session::CloseUser(const UserPtr &user)
 
                     // 重置 publisher_ 指针，移除发布者
                     publisher_.reset();
+                    publisher_loop_ = nullptr;
                 }
             }
             else    // 如果用户类型大于 WebRTC 播放器类型，认为这是一个播放用户
@@ -203,8 +204,8 @@ void Session::CloseUser(const UserPtr &user)
                             << " , ReadyTime : " << ReadyTime()
                             << " , stream time : " << SinceStart();
 
-                // 从 players_ 集合中移除该播放用户，使用 dynamic_pointer_cast 进行类型转换
-                players_.erase(std::dynamic_pointer_cast<PlayerUser>(user));
+                // 从 players_ 集合和事件循环分组中移除该播放用户，使用 dynamic_pointer_cast 进行类型转换
+                RemovePlayerNoLock(std::dynamic_pointer_cast<PlayerUser>(user));
 
                 // 更新最后一次玩家活动时间为当前时间
                 player_live_time_ = lss::base::TTime::NowMS();
@@ -218,26 +219,382 @@ void Session::CloseUser(const UserPtr &user)
 
 void Session::ActiveAllPlayers()
 {
-    // 使用 std::lock_guard 对互斥锁加锁，确保线程安全
+    // 在锁内只复制需要通知的分组，投递在锁外进行
+    std::vector<LoopPlayersPtr> groups;
+    {
+        // 使用 std::lock_guard 对互斥锁加锁，确保线程安全
+        std::lock_guard<std::mutex> lk(lock_);
+
+        groups.reserve(loop_players_.size());
+
+        // 遍历每个事件循环的分组，每个分组最多只有一个未执行的激活通知
+        for (auto const &iter : loop_players_)
+        {
+            const LoopPlayersPtr &group = iter.second;
+
+            // 有副本的分组由转发任务激活
+            if (group->replica)
+            {
+                continue;
+            }
+
+            // 该事件循环已经有待执行的通知，它执行时会看到最新的帧
+            if (group->pending.exchange(true))
+            {
+                continue;
+            }
+
+            groups.emplace_back(group);
+        }
+    }
+
+    // 总是排队执行，分组就在推流所在的事件循环上时也不直接激活
+    // 激活会一路发送数据，发送失败关闭连接时会进入 CloseUser 再次加锁
+    for (auto const &group : groups)
+    {
+        group->loop->QueueInLoop([group](){
+            Session::ActiveLoopPlayers(group);
+        });
+    }
+}
+
+void Session::CheckHotStream()
+{
+    // 已经开启副本，或者还没有应用配置
+    if (replicate_ || !app_info_)
+    {
+        return;
+    }
+
+    size_t players = 0;
+    {
+        std::lock_guard<std::mutex> lk(lock_);
+        players = players_.size();
+    }
+
+    // 播放用户数量达到阈值
+    bool hot = app_info_->replica_players > 0 && players >= app_info_->replica_players;
+
+    // 出口带宽达到阈值
+    int64_t egress = stream_->BitRate() * players;
+    if (app_info_->replica_egress_kbps > 0 && egress >= app_info_->replica_egress_kbps)
+    {
+        hot = true;
+    }
+
+    if (hot && !replicate_.exchange(true))
+    {
+        LIVE_INFO << " hot stream, create replicas, session name : " << session_name_
+                    << " , players : " << players
+                    << " , egress : " << egress << " kbps";
+    }
+}
+
+void Session::ForwardPacket(const PacketPtr &packet, bool active)
+{
+    // 持有会话的锁，所有任务都排队投递，切回原始流的分组就在本事件循环上时也不直接激活
     std::lock_guard<std::mutex> lk(lock_);
 
-    // 遍历 players_ 集合中的每个用户，并调用他们的 Active() 方法，激活所有用户
-    for (auto const &u : players_)
+    // 发布者所在的事件循环（按节点共享时为所在的节点）直接读取原始流
+    int64_t local = ReplicaKey(publisher_loop_);
+
+    for (auto const &iter : loop_players_)
+    {
+        const LoopPlayersPtr &group = iter.second;
+        int64_t key = ReplicaKey(group->loop);
+
+        // 发布者迁移过来之前加入的副本不再需要，切回原始流
+        if (key == local)
+        {
+            if (group->replica)
+            {
+                LeaveReplicaNoLock(group);
+                group->loop->QueueInLoop(std::bind(&Session::SwitchLoopPlayers, group, stream_));
+            }
+            continue;
+        }
+
+        if (group->replica)
+        {
+            continue;
+        }
+
+        // 第一次转发时创建副本，由写入副本的事件循环从原始流复制，之后转发的数据包排在复制之后
+        StreamReplicaPtr &replica = replicas_[key];
+        if (!replica)
+        {
+            replica = std::make_shared<StreamReplica>();
+            replica->loop = group->loop;
+            replica->stream = std::make_shared<Stream>(*this, session_name_, true);
+            replica->groups = std::make_shared<std::vector<LoopPlayersPtr>>();
+
+            StreamPtr stream = replica->stream;
+            StreamPtr primary = stream_;
+            replica->loop->QueueInLoop([stream, primary](){
+                stream->SeedReplica(*primary);
+            });
+
+            LIVE_DEBUG << " create replica, session name : " << session_name_ << " , loop : " << replica->loop
+                        << " , node : " << replica->loop->Node();
+        }
+
+        // 加入副本，由分组所在的事件循环把播放用户切换到副本
+        group->replica = replica;
+        auto groups = std::make_shared<std::vector<LoopPlayersPtr>>();
+        {
+            std::lock_guard<std::mutex> rlk(replica->lock);
+            groups->assign(replica->groups->begin(), replica->groups->end());
+        }
+        groups->emplace_back(group);
+        {
+            std::lock_guard<std::mutex> rlk(replica->lock);
+            replica->groups = std::move(groups);
+        }
+        group->loop->QueueInLoop(std::bind(&Session::SwitchLoopPlayers, group, replica->stream));
+    }
+
+    // 每个副本由它所在的事件循环拷贝一份，内存分配在该事件循环的 NUMA 节点上，播放用户只读取本地的拷贝
+    for (auto const &iter : replicas_)
+    {
+        StreamReplicaPtr replica = iter.second;
+        PacketPtr source = packet;
+        replica->loop->QueueInLoop([replica, source, active](){
+            replica->stream->AddReplicaPacket(source);
+            if (active)
+            {
+                Session::ActiveReplicaPlayers(replica);
+            }
+        });
+    }
+}
+
+void Session::ActiveReplicaPlayers(const StreamReplicaPtr &replica)
+{
+    std::shared_ptr<std::vector<LoopPlayersPtr>> groups;
+    {
+        std::lock_guard<std::mutex> lk(replica->lock);
+        groups = replica->groups;
+    }
+
+    for (auto const &group : *groups)
+    {
+        // 副本所在的事件循环直接激活
+        if (group->loop->IsInLoopThread())
+        {
+            Session::ActiveLoopPlayers(group);
+            continue;
+        }
+
+        // 同一节点上的其他事件循环，已经有待执行的通知时不再投递
+        if (group->pending.exchange(true))
+        {
+            continue;
+        }
+        group->loop->RunInLoop([group](){
+            Session::ActiveLoopPlayers(group);
+        });
+    }
+}
+
+void Session::SwitchLoopPlayers(const LoopPlayersPtr &group, const StreamPtr &stream)
+{
+    std::shared_ptr<std::vector<PlayerUserPtr>> players;
+    {
+        std::lock_guard<std::mutex> lk(group->lock);
+        players = group->players;
+    }
+
+    if (!players)
+    {
+        return;
+    }
+
+    for (auto const &u : *players)
+    {
+        u->SetStream(stream);
+    }
+
+    Session::ActiveLoopPlayers(group);
+}
+
+int64_t Session::ReplicaKey(EventLoop *loop) const
+{
+    if (!loop)
+    {
+        return 0;
+    }
+
+    // 节点编号取负数，与事件循环的地址区分
+    if (replica_per_node_ && loop->Node() >= 0)
+    {
+        return -1 - loop->Node();
+    }
+
+    return static_cast<int64_t>(reinterpret_cast<intptr_t>(loop));
+}
+
+void Session::LeaveReplicaNoLock(const LoopPlayersPtr &group)
+{
+    StreamReplicaPtr replica = group->replica;
+    group->replica.reset();
+
+    // 从副本的分组快照中移除
+    auto groups = std::make_shared<std::vector<LoopPlayersPtr>>();
+    {
+        std::lock_guard<std::mutex> rlk(replica->lock);
+        for (auto const &g : *replica->groups)
+        {
+            if (g != group)
+            {
+                groups->emplace_back(g);
+            }
+        }
+    }
+
+    // 没有分组读取的副本不再转发
+    if (groups->empty())
+    {
+        for (auto iter = replicas_.begin(); iter != replicas_.end(); ++iter)
+        {
+            if (iter->second == replica)
+            {
+                replicas_.erase(iter);
+                break;
+            }
+        }
+    }
+
+    std::lock_guard<std::mutex> rlk(replica->lock);
+    replica->groups = std::move(groups);
+}
+
+void Session::ActiveLoopPlayers(const LoopPlayersPtr &group)
+{
+    // 先清除通知标志，执行期间到达的新帧会重新投递通知
+    group->pending.store(false);
+
+    // 获取播放用户的快照，激活过程中不持有任何锁
+    std::shared_ptr<std::vector<PlayerUserPtr>> players;
+    {
+        std::lock_guard<std::mutex> lk(group->lock);
+        players = group->players;
+    }
+
+    // 如果分组中没有播放用户，直接返回
+    if (!players)
+    {
+        return;
+    }
+
+    // 已经在所属事件循环中，Active() 会直接执行激活回调，不再投递任务
+    for (auto const &u : *players)
     {
         u->Active();
     }
 }
 
+void Session::RemovePlayerNoLock(const PlayerUserPtr &user)
+{
+    // 从 players_ 集合中移除该播放用户
+    players_.erase(user);
+
+    // 获取播放用户所属的事件循环
+    auto conn = user->GetConnection();
+    if (!conn)
+    {
+        return;
+    }
+
+    // 查找对应的分组
+    auto iter = loop_players_.find(conn->Loop());
+    if (iter == loop_players_.end())
+    {
+        return;
+    }
+
+    LoopPlayersPtr &group = iter->second;
+
+    // 复制一份新的快照并移除该用户，正在执行的激活过程仍然使用旧快照
+    auto players = std::make_shared<std::vector<PlayerUserPtr>>();
+    {
+        std::lock_guard<std::mutex> lk(group->lock);
+        if (group->players)
+        {
+            players->reserve(group->players->size());
+            for (auto const &u : *group->players)
+            {
+                if (u != user)
+                {
+                    players->emplace_back(u);
+                }
+            }
+        }
+    }
+
+    // 分组已经没有播放用户，离开读取的副本并移除该分组
+    if (players->empty())
+    {
+        if (group->replica)
+        {
+            LeaveReplicaNoLock(group);
+        }
+        loop_players_.erase(iter);
+        return;
+    }
+
+    // 替换快照
+    std::lock_guard<std::mutex> lk(group->lock);
+    group->players = std::move(players);
+}
+
 void Session::AddPlayer(const PlayerUserPtr &user)
 {
     {
         // 使用 std::lock_guard 对互斥锁加锁，确保线程安全
         std::lock_guard<std::mutex> lk(lock_);
 
+        // 连接迁移完成之前用户可能已经关闭，不再加入
+        if (user->destroyed_)
+        {
+            return;
+        }
+
         // 将传入的播放用户添加到 players_ 集合中
         players_.insert(user);
+
+        // 将播放用户加入所属事件循环的分组
+        auto conn = user->GetConnection();
+        if (conn)
+        {
+            LoopPlayersPtr &group = loop_players_[conn->Loop()];
+            if (!group)
+            {
+                group = std::make_shared<LoopPlayers>();
+                group->loop = conn->Loop();
+            }
+
+            // 复制一份新的快照并加入该用户
+            auto players = std::make_shared<std::vector<PlayerUserPtr>>();
+            std::lock_guard<std::mutex> glk(group->lock);
+            if (group->players)
+            {
+                players->reserve(group->players->size() + 1);
+                players->assign(group->players->begin(), group->players->end());
+            }
+            players->emplace_back(user);
+            group->players = std::move(players);
+
+            // 该事件循环上已经有副本，新的播放用户直接读取副本，AddPlayer 在连接所在的事件循环中调用
+            if (group->replica)
+            {
+                user->SetStream(group->replica->stream);
+            }
+        }
     }
 
+    // 播放用户增加之后检查是否成为热点流
+    CheckHotStream();
+
     // 输出调试信息，记录添加玩家的操作，包括会话名和用户ID
     LIVE_DEBUG << " add player, session name : " << session_name_ << " , user : " << user->UserId();
 
@@ -268,8 +625,67 @@ void Session::SetPublisher(UserPtr &user)
         publisher_->Close();
     }
 
-    // 设置新的发布者
+    // 设置新的发布者，记录它所在的事件循环，只在发布者自己的事件循环线程中调用，可以直接读取
     publisher_ = user;
+    auto conn = user->GetConnection();
+    publisher_loop_ = conn ? conn->Loop() : nullptr;
+}
+
+void Session::SetPublisherLoop(const UserPtr &user, EventLoop *loop)
+{
+    std::lock_guard<std::mutex> lk(lock_);
+
+    // 迁移期间发布者可能已经被替换
+    if (publisher_ == user)
+    {
+        publisher_loop_ = loop;
+    }
+}
+
+EventLoop *Session::PlayerAffinityLoop(size_t max_players)
+{
+    std::lock_guard<std::mutex> lk(lock_);
+
+    if (!publisher_loop_)
+    {
+        return nullptr;
+    }
+
+    // 发布者所在的事件循环上的播放用户已经足够多，新的播放用户留在线程池分配的事件循环上
+    if (max_players > 0)
+    {
+        auto iter = loop_players_.find(publisher_loop_);
+        if (iter != loop_players_.end())
+        {
+            std::lock_guard<std::mutex> glk(iter->second->lock);
+            if (iter->second->players && iter->second->players->size() >= max_players)
+            {
+                return nullptr;
+            }
+        }
+    }
+
+    return publisher_loop_;
+}
+
+EventLoop *Session::PublisherAffinityLoop()
+{
+    std::lock_guard<std::mutex> lk(lock_);
+
+    EventLoop *best = nullptr;
+    size_t most = 0;
+    for (auto const &iter : loop_players_)
+    {
+        std::lock_guard<std::mutex> glk(iter.second->lock);
+        size_t size = iter.second->players ? iter.second->players->size() : 0;
+        if (size > most)
+        {
+            most = size;
+            best = iter.first;
+        }
+    }
+
+    return best;
 }
 
 StreamPtr Session::GetStream()
@@ -288,6 +704,9 @@ void Session::SetAppInfo(AppInfoPtr &ptr)
 {
     // 设置会话的应用信息
     app_info_ = ptr;
+
+    // 副本的共享范围
+    replica_per_node_ = app_info_ && app_info_->replica_scope == "node";
 }
 
 AppInfoPtr &Session::GetAppInfo()
@@ -314,15 +733,20 @@ void Session::Clear()
         CloseUserNoLock(publisher_);
     }
 
-    // 遍历 players_ 集合中的所有玩家，并将每个玩家关闭
+    // 先取出所有玩家，关闭玩家时会从 players_ 集合中移除，不能边遍历边移除
+    std::unordered_set<PlayerUserPtr> players;
+    players.swap(players_);
+
+    // 遍历所有玩家，并将每个玩家关闭
     // 使用 dynamic_pointer_cast 进行类型转换
-    for (auto const &p : players_)
+    for (auto const &p : players)
     {
         CloseUserNoLock(std::dynamic_pointer_cast<User>(p));
     }
 
-    // 清空 players_ 集合，移除所有播放用户
-    players_.clear();
+    // 清空事件循环分组和副本
+    loop_players_.clear();
+    replicas_.clear();
 }
 
 void Session::CloseUserNoLock(const UserPtr &user)
@@ -349,6 +773,7 @@ void Session::CloseUserNoLock(const UserPtr &user)
 
                     // 重置发布者指针，移除发布者
                     publisher_.reset();
+                    publisher_loop_ = nullptr;
                 }
             }
             else    // 否则表示这是一个播放用户
@@ -360,8 +785,8 @@ void Session::CloseUserNoLock(const UserPtr &user)
                             << " , ReadyTime : " << ReadyTime()
                             << " , stream time : " << SinceStart();
 
-                // 从 players_ 集合中移除该播放用户，使用 dynamic_pointer_cast 进行类型转换         
-                players_.erase(std::dynamic_pointer_cast<PlayerUser>(user));
+                // 从 players_ 集合和事件循环分组中移除该播放用户，使用 dynamic_pointer_cast 进行类型转换
+                RemovePlayerNoLock(std::dynamic_pointer_cast<PlayerUser>(user));
                 
                 // 关闭该播放用户
                 user->Close();
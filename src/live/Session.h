@@ -1,6 +1,8 @@
 #pragma once
 #include <string>
 #include <unordered_set>
+#include <unordered_map>
+#include <vector>
 #include <mutex>
 #include <atomic>
 #include "PlayerUser.h"
@@ -17,6 +19,51 @@ namespace lss
         // 使用智能指针定义 User 的指针类型
         using UserPtr = std::shared_ptr<User>;
 
+        // 热点流的只读副本
+        struct StreamReplica;
+
+        // 定义 StreamReplica 的智能指针类型
+        using StreamReplicaPtr = std::shared_ptr<StreamReplica>;
+
+        // 同一个事件循环上的播放用户分组
+        struct LoopPlayers
+        {
+            // 分组所属的事件循环
+            EventLoop *loop{nullptr};
+
+            // 播放用户的只读快照，增删用户时整体替换（写时复制）
+            std::shared_ptr<std::vector<PlayerUserPtr>> players;
+
+            // 保护快照指针的互斥锁
+            std::mutex lock;
+
+            // 是否已经投递了尚未执行的激活通知
+            std::atomic<bool> pending{false};
+
+            // 分组读取的热点流副本，由 Session 的互斥锁保护，分组内的播放用户读取副本而不是原始流
+            StreamReplicaPtr replica;
+        };
+
+        // 定义 LoopPlayers 的智能指针类型
+        using LoopPlayersPtr = std::shared_ptr<LoopPlayers>;
+
+        // 热点流的只读副本，固定由一个事件循环复制和写入
+        // 按应用配置由同一个事件循环上的分组独享，或者由同一个 NUMA 节点上的所有分组共享
+        struct StreamReplica
+        {
+            // 写入副本的事件循环
+            EventLoop *loop{nullptr};
+
+            // 副本
+            StreamPtr stream;
+
+            // 读取副本的分组快照，增删分组时整体替换
+            std::shared_ptr<std::vector<LoopPlayersPtr>> groups;
+
+            // 保护分组快照指针的互斥锁
+            std::mutex lock;
+        };
+
         // Session 类，继承 std::enable_shared_from_this，允许对象创建 shared_ptr
         class Session : public std::enable_shared_from_this<Session>
         {
@@ -42,14 +89,38 @@ namespace lss
             // 关闭指定的用户，参数是 UserPtr 类型
             void CloseUser(const UserPtr &user);
 
-            // 激活所有播放用户
+            // 激活所有播放用户，每个事件循环只投递一次通知，由该循环激活本地的播放用户
+            // 有副本的分组由转发数据包的任务激活，这里跳过
             void ActiveAllPlayers();
 
+            // 是否已经成为热点流，需要把数据包转发给各个事件循环上的副本
+            bool Replicated() const
+            {
+                return replicate_.load(std::memory_order_relaxed);
+            }
+
+            // 检查播放用户数量和出口带宽，达到应用配置的阈值时开启副本，开启后一直保持到会话关闭
+            void CheckHotStream();
+
+            // 把原始流刚保存的数据包转发给各个副本，由副本所在的事件循环拷贝，没有副本的分组先创建或加入副本
+            // 只在发布者所在的事件循环中调用，active 表示副本保存之后是否激活读取副本的播放用户
+            void ForwardPacket(const PacketPtr &packet, bool active);
+
             // 添加用户，参数是 PlayerUserPtr 类型
             void AddPlayer(const PlayerUserPtr &user);
 
             // 设置发布者用户，参数是 UserPtr 类型
             void SetPublisher(UserPtr &user);
+
+            // 发布者的连接迁移到 loop 之后更新记录的事件循环
+            void SetPublisherLoop(const UserPtr &user, EventLoop *loop);
+
+            // 新的播放用户应该迁移到的事件循环，即发布者所在的事件循环
+            // 没有发布者，或者该事件循环上本会话的播放用户已经达到 max_players 时返回空指针，max_players 为 0 时不限制
+            EventLoop *PlayerAffinityLoop(size_t max_players);
+
+            // 发布者应该迁移到的事件循环，即本会话播放用户最多的事件循环，没有播放用户时返回空指针
+            EventLoop *PublisherAffinityLoop();
             
             // 获取流对象，返回 StreamPtr 类型
             StreamPtr GetStream();
@@ -73,12 +144,33 @@ namespace lss
             // 在不加锁的情况下关闭用户，参数是 UserPtr 类型
             void CloseUserNoLock(const UserPtr &user);
 
+            // 在不加锁的情况下将播放用户从所属事件循环的分组中移除
+            void RemovePlayerNoLock(const PlayerUserPtr &user);
+
+            // 在事件循环中激活分组内的所有播放用户
+            static void ActiveLoopPlayers(const LoopPlayersPtr &group);
+
+            // 在副本所在的事件循环中激活读取副本的所有分组，其他事件循环上的分组投递通知
+            static void ActiveReplicaPlayers(const StreamReplicaPtr &replica);
+
+            // 在分组所在的事件循环中把分组内的播放用户切换到 stream，然后激活
+            static void SwitchLoopPlayers(const LoopPlayersPtr &group, const StreamPtr &stream);
+
+            // 分组共享副本的键：按节点共享并且事件循环所在的节点已知时为节点，否则为事件循环
+            int64_t ReplicaKey(EventLoop *loop) const;
+
+            // 在不加锁的情况下让分组离开它读取的副本，副本没有分组读取时不再转发
+            void LeaveReplicaNoLock(const LoopPlayersPtr &group);
+
             // 会话名称，存储为字符串
             std::string session_name_;
 
             // 保存玩家用户的集合，使用无序集合存储 PlayerUserPtr
             std::unordered_set<PlayerUserPtr> players_;
 
+            // 按事件循环分组的播放用户
+            std::unordered_map<EventLoop*, LoopPlayersPtr> loop_players_;
+
             // 应用程序信息指针，使用智能指针类型 AppInfoPtr
             AppInfoPtr app_info_;
 
@@ -88,11 +180,23 @@ namespace lss
             // 发布者用户指针，使用智能指针类型 UserPtr
             UserPtr publisher_;
 
+            // 发布者的连接所在的事件循环
+            EventLoop *publisher_loop_{nullptr};
+
             // 互斥锁，用于同步操作
             std::mutex lock_;
 
             // 原子类型，表示玩家活动时间，64 位整数类型
             std::atomic<int64_t> player_live_time_;
+
+            // 是否已经成为热点流
+            std::atomic<bool> replicate_{false};
+
+            // 同一个 NUMA 节点上的分组是否共享一个副本
+            bool replica_per_node_{false};
+
+            // 热点流的副本，键见 ReplicaKey
+            std::unordered_map<int64_t, StreamReplicaPtr> replicas_;
         };
     }
 }
\ No newline at end of file
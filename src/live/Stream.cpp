@@ -1,22 +1,27 @@
+#include <algorithm>
 #include "Stream.h"
 #include "base/TTime.h"
 #include "live/base/CodecUtils.h"
 #include "live/base/LiveLog.h"
 #include "Session.h"
+#include "mmedia/rtmp/RtmpHeader.h"
 
 using namespace lss::live;
 using namespace lss::base;
 
-Stream::Stream(Session& s, const std::string &session_name)
-    : session_(s)                           // 初始化成员变量 session_ 为传入的 Session 引用
+Stream::Stream(Session& s, const std::string &session_name, bool replica)
+    : replica_(replica)                     // 是否为副本
+    , session_(s)                           // 初始化成员变量 session_ 为传入的 Session 引用
     , session_name_(session_name)           // 初始化成员变量 session_name_ 为传入的会话名称
     , packet_buffer_(packet_buffer_size_)   // 初始化数据包缓冲区大小为 packet_buffer_size_
+    , chunk_cache_(std::make_shared<RtmpChunkCache>(packet_buffer_size_))   // 创建与缓冲区等大的分块缓存
 {
     // 获取当前时间戳并赋值给 stream_time_
     stream_time_ = TTime::NowMS();
 
     // 获取当前时间戳并赋值给 start_timestamp_
     start_timestamp_ = TTime::NowMS();
+    bitrate_start_ = start_timestamp_;
 }
 
 int64_t Stream::ReadyTime() const 
@@ -94,76 +99,140 @@ void Stream::AddPacket(PacketPtr && packet)
     // 设置数据包的时间戳
     packet->SetTimeStamp(t);
 
+    // 只有推流一个写者，直接计算新的索引值，写入缓冲区之后再发布
+    auto index = frame_index_.load(std::memory_order_relaxed) + 1;
+
+    // 设置数据包的索引
+    packet->SetIndex(index);
+
+    // 如果是视频并且是关键帧，设置数据包类型为视频关键帧，副本直接使用该类型
+    if (packet->IsVideo() && CodecUtils::IsKeyFrame(packet))
+    {
+        packet->SetPacketType(kPacketTypeVideo | kFrameTypeKeyFrame);
+    }
+
+    // 统计推流的码率，用于判断是否为热点流
+    bitrate_bytes_ += packet->PacketSize();
+
+    // 热点流需要把数据包转发给各个事件循环上的副本，保存之前留一份引用
+    PacketPtr forward;
+    if (session_.Replicated())
+    {
+        forward = packet;
+    }
+
+    // 保存数据包
+    Store(std::move(packet));
+
+    // 计算码率，每秒更新一次
+    auto elapsed = stream_time_ - bitrate_start_;
+    if (elapsed >= 1000)
     {
-        // 创建互斥锁，保护临界区
-        std::lock_guard<std::mutex> lk(lock_);
+        bitrate_kbps_.store(bitrate_bytes_ * 8 / elapsed, std::memory_order_relaxed);
+        bitrate_bytes_ = 0;
+        bitrate_start_ = stream_time_;
+    }
 
-        // 增加帧索引并获取新的索引值
-        auto index = ++frame_index_;
+    // 如果帧索引小于 300 或每 5 帧一次，激活播放
+    bool active = index < 300 || index % 5 == 0;
 
-        // 设置数据包的索引
-        packet->SetIndex(index);
+    // 转发给副本，副本所在的事件循环收到后激活本地的播放
+    if (forward)
+    {
+        session_.ForwardPacket(forward, active);
+    }
+
+    if (active)
+    {
+        // 激活所有没有副本的播放
+        session_.ActiveAllPlayers();
+    }
+}
 
-        // 如果是视频并且是关键帧
-        if (packet->IsVideo() && CodecUtils::IsKeyFrame(packet))
+void Stream::AddReplicaPacket(const PacketPtr &packet)
+{
+    // 创建副本之后、复制之前转发来的数据包已经在原始流的缓冲区中复制过了
+    if (packet->Index() <= frame_index_.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    Store(ClonePacket(packet));
+}
+
+void Stream::Store(PacketPtr &&packet)
+{
+    // 索引已经设置好，单一写者，写入缓冲区之后再发布
+    auto index = packet->Index();
+
+    // 如果是视频关键帧，设置流为准备状态
+    if (packet->IsKeyFrame())
+    {
+        SetReady(true);
+    }
+
+    // 判断编解码头时可能合并开头的切片，必须在分块之前
+    bool codec_header = CodecUtils::IsCodecHeader(packet);
+
+    // 按服务端默认的输出块大小预先分块，布局在数据包发布给播放之前设置，播放端无锁读取
+    // 副本拷贝的数据包在副本所属的事件循环中重新分块，布局指向本地内存
+    if (packet->Header())
+    {
+        packet->SetOutLayout(RtmpChunkCache::BuildLayout(packet, kRtmpOutChunkSize, 0));
+    }
+
+    // 如果是编解码头
+    if (codec_header)
+    {
+        // 解析编解码头
+        codec_headers_.ParseCodecHeader(packet);
+
+        // 如果是视频
+        if (packet->IsVideo())
         {
-            // 设置流为准备状态
-            SetReady(true);
+            // 标记为有视频
+            has_video_ = true;
 
-            // 设置数据包类型为视频关键帧
-            packet->SetPacketType(kPacketTypeVideo | kFrameTypeKeyFrame);
+            // 增加流版本
+            stream_version_++;
         }
+        // 如果是音频
+        else if (packet->IsAudio())
+        {
+            // 标记为有音频
+            has_audio_ = true;
 
-        // 如果是编解码头
-        if (CodecUtils::IsCodecHeader(packet))
+            // 增加流版本
+            stream_version_++;
+        }
+        // 如果是元数据
+        else if (packet->IsMeta())
         {
-            // 解析编解码头
-            codec_headers_.ParseCodecHeader(packet);
-
-            // 如果是视频
-            if (packet->IsVideo())
-            {
-                // 标记为有视频
-                has_video_ = true;
-
-                // 增加流版本
-                stream_version_++;
-            }
-            // 如果是音频
-            else if (packet->IsAudio())
-            {
-                // 标记为有音频
-                has_audio_ = true;
-
-                // 增加流版本
-                stream_version_++;
-            }
-            // 如果是元数据
-            else if (packet->IsMeta())
-            {
-                // 标记为有元数据
-                has_meta_ = true;
-
-                // 增加流版本
-                stream_version_++;
-            }
+            // 标记为有元数据
+            has_meta_ = true;
+
+            // 增加流版本
+            stream_version_++;
         }
+    }
 
-        // 将帧添加到 GOP 管理器
-        gop_mgr_.AddFrame(packet);
+    // 将帧添加到 GOP 管理器
+    gop_mgr_.AddFrame(packet);
 
-        // 将数据包移动到缓冲区
-        packet_buffer_[index % packet_buffer_size_] = std::move(packet);
+    // 将数据包移动到缓冲区
+    packet_buffer_.Push(index, std::move(packet));
 
-        // 计算最小索引
-        auto min_idx = frame_index_ - packet_buffer_size_;
+    // 发布新的帧索引，播放看到新索引时一定能从缓冲区读到对应的数据包
+    frame_index_.store(index, std::memory_order_release);
 
-        // 如果最小索引大于 0
-        if (min_idx > 0)
-        {
-            // 清除过期的 GOP
-            gop_mgr_.ClearExpriedGop(min_idx);
-        }
+    // 计算最小索引
+    auto min_idx = frame_index_ - packet_buffer_size_;
+
+    // 如果最小索引大于 0
+    if (min_idx > 0)
+    {
+        // 清除过期的 GOP
+        gop_mgr_.ClearExpriedGop(min_idx);
     }
 
     // 如果数据到达时间为 0
@@ -175,18 +244,53 @@ void Stream::AddPacket(PacketPtr && packet)
 
     // 获取当前时间并赋值给 stream_time_
     stream_time_ = TTime::NowMS();
+}
 
-    // 加载当前帧索引
-    auto frame = frame_index_.load();
+void Stream::SeedReplica(Stream &primary)
+{
+    // 原始流缓冲区中最早的数据包
+    int64_t last = primary.frame_index_.load(std::memory_order_acquire);
+    int64_t first = last - primary.packet_buffer_size_ + 1;
+    if (first < 0)
+    {
+        first = 0;
+    }
 
-    // 如果帧索引小于 300 或每 5 帧一次
-    if (frame < 300 || frame % 5 == 0)
+    // 缓冲区开头生效的编解码头早于缓冲区时，按索引顺序先保存，定位到缓冲区内较早的 GOP 时才能找到
+    // 不能只取最新的一份：缓冲区内换过头时，换头之前的 GOP 仍然使用旧的编解码头
+    std::vector<PacketPtr> headers;
+    for (auto &header : {primary.codec_headers_.Meta(first), primary.codec_headers_.AudioHeader(first), primary.codec_headers_.VideoHeader(first)})
     {
-        // 激活所有播放
-        session_.ActiveAllPlayers();
+        if (header && header->Index() < first)
+        {
+            headers.push_back(header);
+        }
+    }
+    std::sort(headers.begin(), headers.end(), [](const PacketPtr &a, const PacketPtr &b){
+        return a->Index() < b->Index();
+    });
+    for (auto &header : headers)
+    {
+        Store(ClonePacket(header));
+    }
+
+    // 按顺序复制缓冲区中的数据包，复制期间被推流改写的槽位读不到，直接跳过
+    for (int64_t idx = first; idx <= last; idx++)
+    {
+        auto pkt = primary.packet_buffer_.Get(idx);
+        if (pkt)
+        {
+            Store(ClonePacket(pkt));
+        }
     }
 }
 
+PacketPtr Stream::ClonePacket(const PacketPtr &packet)
+{
+    // RTMP 消息头内嵌在数据包中，随数据一起拷贝到本地内存
+    return packet->Clone();
+}
+
 void Stream::GetFrames(const PlayerUserPtr &user)
 {
     // 如果没有媒体
@@ -196,6 +300,21 @@ void Stream::GetFrames(const PlayerUserPtr &user)
         return;
     }
 
+    // 连接的发送队列积压超过高水位，播放端已经跟不上，不再取新帧
+    // 尚未发送的输出帧还没有分块，能跳到新的 GOP 时直接丢弃，等积压回落到低水位后从新的 GOP 继续
+    if (user->congested_)
+    {
+        if (!user->out_frames_.empty() && user->out_index_ >= 0 && SkipFrame(user))
+        {
+            LIVE_INFO << " player congested, drop " << user->out_frames_.size() << " frames"
+                    << " , host : " << user->user_id_;
+
+            user->out_frames_.clear();
+        }
+        
+        return;
+    }
+
     // 如果用户有元数据、音频头、视频头或输出帧不为空
     if (user->meta_ || user->audio_header_ || user->video_header_ || !user->out_frames_.empty())
     {
@@ -203,8 +322,8 @@ void Stream::GetFrames(const PlayerUserPtr &user)
         return;
     }
 
-    // 创建互斥锁，保护临界区
-    std::lock_guard<std::mutex> lk(lock_);
+    // 每批最多取的帧数
+    int max_frames = 10;
 
     // 如果用户的输出索引有效
     if (user->out_index_ >= 0)
@@ -234,10 +353,19 @@ void Stream::GetFrames(const PlayerUserPtr &user)
         {
             return;
         }
+
+        // 刚开始播放时一次取出整个 GOP 直到最新的帧，在一次发送中完成快速启动
+        max_frames = packet_buffer_size_;
     }
 
-    // 获取下一帧
-    GetNextFrame(user);
+    // 获取下一批帧
+    GetNextFrame(user, max_frames);
+}
+
+const RtmpChunkCachePtr &Stream::GetChunkCache() const
+{
+    // 返回分块缓存
+    return chunk_cache_;
 }
 
 bool Stream::LocateGop(const PlayerUserPtr &user)
@@ -380,7 +508,7 @@ bool Stream::LocateGop(const PlayerUserPtr &user)
     return true;
 }
 
-void Stream::SkipFrame(const PlayerUserPtr &user)
+bool Stream::SkipFrame(const PlayerUserPtr &user)
 {
     // 获取用户应用的信息中的内容延迟
     int content_lantency = user->GetAppInfo()->content_latency;
@@ -395,7 +523,7 @@ void Stream::SkipFrame(const PlayerUserPtr &user)
     if (idx == -1 || idx <= user->out_index_)
     {
         // 直接返回
-        return;
+        return false;
     }
 
     // 获取指定索引的元数据
@@ -457,18 +585,20 @@ void Stream::SkipFrame(const PlayerUserPtr &user)
 
     // 更新用户的输出索引为当前索引减一
     user->out_index_ = idx - 1;  
+
+    return true;
 }
 
-void Stream::GetNextFrame(const PlayerUserPtr &user)
+void Stream::GetNextFrame(const PlayerUserPtr &user, int max_frames)
 {
     // 从用户的输出索引加一开始
     auto idx = user->out_index_ + 1;
 
     // 获取当前最大帧索引
-    auto max_idx = frame_index_.load();
+    auto max_idx = frame_index_.load(std::memory_order_acquire);
 
-    // 最多获取 10 帧
-    for (int i = 0; i < 10; i++)
+    // 最多获取 max_frames 帧
+    for (int i = 0; i < max_frames; i++)
     {
         // 如果索引超出最大帧索引
         if (idx > max_idx)
@@ -477,8 +607,8 @@ void Stream::GetNextFrame(const PlayerUserPtr &user)
             break;
         }
 
-        // 获取对应索引的数据包
-        auto &pkt = packet_buffer_[idx % packet_buffer_size_];
+        // 获取对应索引的数据包，槽位已被覆盖时返回空
+        auto pkt = packet_buffer_.Get(idx);
 
         // 如果数据包存在
         if (pkt)
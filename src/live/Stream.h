@@ -3,12 +3,12 @@
 #include <memory>
 #include <cstdint>
 #include <atomic>
-#include <vector>
-#include <mutex>
 #include "live/base/TimeCorrector.h"
+#include "live/base/FrameRing.h"
 #include "live/GopMgr.h"
 #include "live/CodecHeader.h"
 #include "mmedia/base/Packet.h"
+#include "mmedia/rtmp/RtmpChunkCache.h"
 #include "PlayerUser.h"
 #include "User.h"
 
@@ -27,11 +27,14 @@ namespace lss
         // 前向声明 Session 类
         class Session;
 
+        // Stream 不使用互斥锁：AddPacket 只由推流所在的事件循环调用（单生产者），
+        // GetFrames 由各个播放所在的事件循环无等待调用（多消费者）
+        // 热点流在其他事件循环上有只读副本，推流所在的事件循环逐个转发数据包，由副本所属的事件循环拷贝和写入
         class Stream
         {
         public:
-            // 构造函数，接受 Session 引用和会话名称
-            Stream(Session &s, const std::string &session_name);
+            // 构造函数，接受 Session 引用和会话名称，replica 表示是否为副本
+            Stream(Session &s, const std::string &session_name, bool replica = false);
 
             // 获取准备时间
             int64_t ReadyTime() const;
@@ -60,22 +63,57 @@ namespace lss
             // 添加数据包
             void AddPacket(PacketPtr &&packet);
 
+            // 副本添加原始流转发来的数据包，在副本所属的事件循环中拷贝之后保存，拷贝的内存分配在该事件循环所在的 NUMA 节点上
+            // 时间戳和索引已经由原始流设置好，已经由 SeedReplica 复制过的数据包直接忽略
+            void AddReplicaPacket(const PacketPtr &packet);
+
+            // 副本从原始流复制当前缓冲区中的数据包和更早的编解码头，只能在副本所属的事件循环中调用
+            // 以读者的身份访问原始流，不影响推流继续写入
+            void SeedReplica(Stream &primary);
+
+            // 拷贝数据包给副本使用，数据和 RTMP 消息头都重新分配，副本读取时不再访问原始流的内存和引用计数
+            static PacketPtr ClonePacket(const PacketPtr &packet);
+
+            // 最近一秒推流的码率，单位：kbps
+            int64_t BitRate() const
+            {
+                return bitrate_kbps_.load(std::memory_order_relaxed);
+            }
+
             // 获取帧数据给指定用户
             void GetFrames(const PlayerUserPtr &user);
 
+            // 获取流共享的 RTMP 分块缓存
+            const RtmpChunkCachePtr &GetChunkCache() const;
+
         private:
             // 定位 GOP（图像组）给指定用户
             bool LocateGop(const PlayerUserPtr &user);
 
-            // 跳过帧给指定用户
-            void SkipFrame(const PlayerUserPtr &user);
+            // 跳过帧给指定用户，返回是否跳到了新的 GOP
+            bool SkipFrame(const PlayerUserPtr &user);
 
-            // 获取下一帧给指定用户
-            void GetNextFrame(const PlayerUserPtr &user); 
+            // 获取下一批帧给指定用户，最多 max_frames 帧
+            void GetNextFrame(const PlayerUserPtr &user, int max_frames = 10); 
 
             // 设置流的准备状态
             void SetReady(bool ready);
 
+            // 保存已经设置好索引的数据包，更新编解码头、GOP 和缓冲区，原始流和副本共用
+            void Store(PacketPtr &&packet);
+
+            // 是否为副本
+            bool replica_{false};
+
+            // 本周期推流的字节数，只由推流所在的事件循环访问
+            int64_t bitrate_bytes_{0};
+
+            // 本周期的开始时间，单位：毫秒
+            int64_t bitrate_start_{0};
+
+            // 最近一秒推流的码率，单位：kbps
+            std::atomic<int64_t> bitrate_kbps_{0};
+
             // 数据到达时间，初始化为 0
             int64_t data_coming_time_{0};
 
@@ -100,20 +138,23 @@ namespace lss
             // 数据包缓冲区大小，初始化为 1000
             uint32_t packet_buffer_size_{1000};
 
-            // 数据包缓冲区
-            std::vector<PacketPtr> packet_buffer_;
+            // 数据包缓冲区，单生产者多消费者的无锁环形缓冲区
+            FrameRing packet_buffer_;
+
+            // RTMP 分块缓存，槽位与数据包缓冲区一一对应
+            RtmpChunkCachePtr chunk_cache_;
 
             // 是否有音频，初始化为 false
-            bool has_audio_{false};
+            std::atomic<bool> has_audio_{false};
 
             // 是否有视频，初始化为 false
-            bool has_video_{false};
+            std::atomic<bool> has_video_{false};
 
             // 是否有元数据，初始化为 false
-            bool has_meta_{false};
+            std::atomic<bool> has_meta_{false};
 
             // 流是否准备好，初始化为 false
-            bool ready_{false};
+            std::atomic<bool> ready_{false};
 
             // 流版本，使用原子变量，初始化为 -1
             std::atomic<int32_t> stream_version_{-1};
@@ -126,9 +167,6 @@ namespace lss
 
             // 时间校正器
             TimeCorrector time_corrector_;
-
-            // 互斥锁，用于线程同步
-            std::mutex lock_;
         };
     }
 }
\ No newline at end of file
@@ -140,4 +140,10 @@ void User::Deactive()
         // 注销连接
         connection_->Deactive();
     }
-}
\ No newline at end of file
+}
+
+void User::SetStream(const StreamPtr &stream)
+{
+    // 替换流指针
+    stream_ = stream;
+}
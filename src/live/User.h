@@ -136,12 +136,15 @@ namespace lss
                 return session_;
             }
 
-            // 获取流指针
-            StreamPtr GetStream() const 
+            // 获取流指针，返回引用，每个数据包都会调用，不增加引用计数
+            const StreamPtr &GetStream() const 
             {
                 return stream_;
             }
 
+            // 切换读取的流，热点流的播放改为读取本事件循环上的副本，只能在连接所在的事件循环中调用
+            virtual void SetStream(const StreamPtr &stream);
+
             // 虚析构函数
             virtual ~User() = default;
 
@@ -7,8 +7,8 @@ bool CodecUtils::IsCodecHeader(const PacketPtr &packet)
     // 如果包大小大于1字节
     if (packet->PacketSize() > 1)
     {
-        // 获取数据指针，从第二个字节开始
-        const char *b = packet->Data() + 1;
+        // 获取数据指针，从第二个字节开始，只需要前两个字节连续
+        const char *b = packet->Head(2) + 1;
 
         // 如果当前字节为0
         if (*b == 0)
@@ -27,8 +27,8 @@ bool CodecUtils::IsKeyFrame(const PacketPtr &packet)
     // 如果包大小大于0字节
     if (packet->PacketSize() > 0)
     {
-        // 获取数据指针
-        const char *b = packet->Data();
+        // 获取数据指针，只需要第一个字节
+        const char *b = packet->Head(1);
         // 检查首个字节的高四位是否为1，判断是否为关键帧
         return ((*b >> 4) & 0x0f) == 1;
     }
@@ -0,0 +1,113 @@
+#include "FrameRing.h"
+
+using namespace lss::live;
+
+FrameRing::FrameRing(uint32_t window)
+    : window_(window > 0 ? window : 1)  // 可读窗口至少为 1
+{
+    // 槽位数量是可读窗口的两倍，留出一整圈的保护区
+    size_ = window_ * 2;
+    slots_.reset(new Slot[size_]);
+}
+
+void FrameRing::Push(int64_t seq, PacketPtr &&packet)
+{
+    // 定位槽位
+    uint32_t index = seq % size_;
+    Slot &slot = slots_[index];
+
+    // 先将序号置为无效，再发布新指针，读者读到新指针时第二次校验序号一定失败
+    slot.seq.store(-1);
+    slot.packet.store(packet.get());
+
+    // 槽位接管新数据包的引用，取出旧数据包的引用
+    PacketPtr old = std::move(slot.owner);
+    slot.owner = std::move(packet);
+
+    // 发布新序号，读者看到新序号时一定能看到新数据包
+    slot.seq.store(seq, std::memory_order_release);
+
+    // 新指针发布之后读者数量为零，之后进入的读者只能读到新指针，旧数据包可以直接释放；
+    // 否则可能有读者拿到了旧指针还没有加引用，等它们离开之后再释放
+    if (old && slot.readers.load() != 0)
+    {
+        retired_.push_back(RetiredPacket{index, std::move(old)});
+    }
+    old.reset();
+
+    if (!retired_.empty())
+    {
+        Reclaim();
+    }
+}
+
+void FrameRing::Push(int64_t seq, const PacketPtr &packet)
+{
+    // 拷贝一份后按右值写入
+    PacketPtr p = packet;
+    Push(seq, std::move(p));
+}
+
+PacketPtr FrameRing::Get(int64_t seq) const
+{
+    // 序号非法，直接返回空
+    if (seq < 0)
+    {
+        return PacketPtr();
+    }
+
+    // 定位槽位
+    Slot &slot = slots_[seq % size_];
+
+    // 第一次校验序号，未命中时不修改槽位
+    if (slot.seq.load(std::memory_order_acquire) != seq)
+    {
+        return PacketPtr();
+    }
+
+    // 登记为读者，生产者在读者离开之前不会释放被替换的数据包
+    slot.readers.fetch_add(1);
+
+    // 读取指针，第二次校验序号，期间槽位被改写则放弃
+    PacketPtr packet;
+    Packet *p = slot.packet.load();
+    if (p && slot.seq.load() == seq)
+    {
+        packet = PacketPtr(p);
+    }
+
+    // 引用已经加上，离开槽位
+    slot.readers.fetch_sub(1, std::memory_order_release);
+
+    // 返回数据包
+    return packet;
+}
+
+size_t FrameRing::Retired() const
+{
+    return retired_.size();
+}
+
+void FrameRing::Reclaim()
+{
+    // 读者数量归零时，拿到旧指针的读者都已经加上引用并离开，可以释放槽位的引用
+    size_t kept = 0;
+    for (size_t i = 0; i < retired_.size(); i++)
+    {
+        if (slots_[retired_[i].slot].readers.load() != 0)
+        {
+            if (kept != i)
+            {
+                retired_[kept] = std::move(retired_[i]);
+            }
+            kept++;
+        }
+    }
+    retired_.erase(retired_.begin() + kept, retired_.end());
+}
+
+uint32_t FrameRing::Window() const
+{
+    // 返回可读窗口大小
+    return window_;
+}
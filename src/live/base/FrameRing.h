@@ -0,0 +1,83 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include "mmedia/base/Packet.h"
+
+namespace lss
+{
+    namespace live
+    {
+        using namespace lss::mm;
+
+        // FrameRing，单生产者多消费者的无锁帧环形缓冲区
+        // 生产者（推流所在的事件循环）按递增序号写入，消费者（各个播放所在的事件循环）按序号无等待读取
+        // 槽位保存原子的数据包指针和序号，读者校验序号之后对指针加引用；引用计数不能在槽位被改写之后再访问，
+        // 否则数据包可能已经还给内存池，因此槽位记录正在读取的读者数量，生产者改写槽位时，
+        // 被替换的数据包如果还有读者可能正在加引用，先放入回收列表，等到该槽位的读者数量归零之后再释放
+        // 槽位数量是可读窗口的两倍，只影响命中率：落后不超过窗口的读者不会因为槽位被改写而未命中
+        class FrameRing
+        {
+        public:
+            // 构造函数，window 为可读窗口大小
+            explicit FrameRing(uint32_t window);
+
+            // 写入序号为 seq 的数据包，只能由生产者调用，序号必须递增
+            void Push(int64_t seq, PacketPtr &&packet);
+
+            // 写入序号为 seq 的数据包，只能由生产者调用，序号必须递增
+            void Push(int64_t seq, const PacketPtr &packet);
+
+            // 读取序号为 seq 的数据包，槽位已被改写或尚未写入时返回空
+            PacketPtr Get(int64_t seq) const;
+
+            // 获取可读窗口大小
+            uint32_t Window() const;
+
+            // 析构函数
+            ~FrameRing() = default;
+
+            // 等待读者离开、尚未释放的数据包数量，只能由生产者调用，用于测试
+            size_t Retired() const;
+
+        private:
+            // 槽位结构
+            struct Slot
+            {
+                // 槽位当前保存的数据包序号，-1 表示为空或正在写入
+                std::atomic<int64_t> seq{-1};
+                // 发布给读者的数据包指针，引用由 owner 持有
+                std::atomic<Packet*> packet{nullptr};
+                // 正在读取该槽位的读者数量，读者在加引用期间不为零
+                std::atomic<int32_t> readers{0};
+                // 槽位持有的引用，只由生产者访问
+                PacketPtr owner;
+            };
+
+            // 被替换、等待读者离开之后释放的数据包
+            struct RetiredPacket
+            {
+                // 数据包所在的槽位
+                uint32_t slot;
+                // 数据包的引用
+                PacketPtr packet;
+            };
+
+            // 释放读者已经离开的槽位上被替换的数据包
+            void Reclaim();
+
+            // 槽位数组
+            std::unique_ptr<Slot[]> slots_;
+
+            // 回收列表，只由生产者访问
+            std::vector<RetiredPacket> retired_;
+
+            // 可读窗口大小
+            uint32_t window_{0};
+
+            // 槽位数量，为可读窗口的两倍
+            uint32_t size_{0};
+        };
+    }
+}
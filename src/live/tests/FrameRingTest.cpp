@@ -0,0 +1,255 @@
+#include <iostream>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <vector>
+#include <chrono>
+#include "mmedia/base/Packet.h"
+#include "live/base/FrameRing.h"
+
+using namespace lss::mm;
+using namespace lss::live;
+
+// 可读窗口大小，与 Stream 的数据包缓冲区一致
+const uint32_t kWindow = 1000;
+
+// 每轮测试持续的时间（毫秒）
+const int kDurationMs = 1000;
+
+// 推流每次写入后的间隔（微秒），模拟高码率推流
+const int kPushIntervalUs = 10;
+
+// 旧实现：互斥锁保护的数据包缓冲区，推流和播放竞争同一把锁
+class MutexBuffer
+{
+public:
+    MutexBuffer() : buffer_(kWindow) {}
+
+    // 写入数据包
+    void Push(int64_t index, const PacketPtr &packet)
+    {
+        std::lock_guard<std::mutex> lk(lock_);
+        buffer_[index % kWindow] = packet;
+        index_ = index;
+    }
+
+    // 读取从 idx 开始的最多 10 个数据包，返回读到的数量
+    int Read(int64_t idx, std::vector<PacketPtr> &out)
+    {
+        std::lock_guard<std::mutex> lk(lock_);
+        int n = 0;
+        for (; n < 10 && idx + n <= index_; n++)
+        {
+            out.emplace_back(buffer_[(idx + n) % kWindow]);
+        }
+        return n;
+    }
+
+    // 获取最新索引
+    int64_t Index()
+    {
+        std::lock_guard<std::mutex> lk(lock_);
+        return index_;
+    }
+
+private:
+    std::mutex lock_;
+    std::vector<PacketPtr> buffer_;
+    int64_t index_{-1};
+};
+
+// 新实现：FrameRing 加上原子的帧索引
+class RingBuffer
+{
+public:
+    RingBuffer() : ring_(kWindow) {}
+
+    // 写入数据包
+    void Push(int64_t index, const PacketPtr &packet)
+    {
+        ring_.Push(index, packet);
+        index_.store(index, std::memory_order_release);
+    }
+
+    // 读取从 idx 开始的最多 10 个数据包，返回读到的数量
+    int Read(int64_t idx, std::vector<PacketPtr> &out)
+    {
+        int64_t max_idx = index_.load(std::memory_order_acquire);
+        int n = 0;
+        for (; n < 10 && idx + n <= max_idx; n++)
+        {
+            PacketPtr pkt = ring_.Get(idx + n);
+            if (!pkt)
+            {
+                break;
+            }
+            out.emplace_back(std::move(pkt));
+        }
+        return n;
+    }
+
+    // 获取最新索引
+    int64_t Index()
+    {
+        return index_.load(std::memory_order_acquire);
+    }
+
+private:
+    FrameRing ring_;
+    std::atomic<int64_t> index_{-1};
+};
+
+// 预先分配的数据包，避免测试过程中的内存分配影响结果
+std::vector<PacketPtr> packets;
+
+// 一个推流线程和 loops 个播放线程同时运行，返回 {播放读取次数, 播放读取帧数}
+template <typename Buffer>
+std::pair<int64_t, int64_t> Run(int loops)
+{
+    Buffer buffer;
+    std::atomic<bool> running{true};
+    std::atomic<int64_t> calls{0};
+    std::atomic<int64_t> reads{0};
+    int64_t writes = 0;
+
+    // 播放线程：像 Stream::GetNextFrame 一样每次最多读取 10 帧
+    std::vector<std::thread> readers;
+    for (int i = 0; i < loops; i++)
+    {
+        readers.emplace_back([&]() {
+            std::vector<PacketPtr> out;
+            out.reserve(10);
+            int64_t idx = 0;
+            int64_t total = 0;
+            int64_t count = 0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                out.clear();
+                int n = buffer.Read(idx, out);
+                count++;
+                total += n;
+                idx += n;
+                // 落后超过窗口时跳到最新位置，与 SkipFrame 的行为相同
+                int64_t latest = buffer.Index();
+                if (latest - idx >= kWindow)
+                {
+                    idx = latest;
+                }
+            }
+            calls += count;
+            reads += total;
+        });
+    }
+
+    // 推流线程：按固定间隔写入数据包
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(kDurationMs))
+    {
+        buffer.Push(writes, packets[writes % packets.size()]);
+        writes++;
+        next += std::chrono::microseconds(kPushIntervalUs);
+        while (std::chrono::steady_clock::now() < next)
+        {
+        }
+    }
+
+    running = false;
+    for (auto &t : readers)
+    {
+        t.join();
+    }
+    return std::make_pair(calls.load(), reads.load());
+}
+
+// 小窗口下推流不断写入新分配的数据包，被替换的数据包马上还给内存池并被复用，
+// 播放线程读取最新的几帧，读到的数据包索引必须与序号一致，结束后回收列表必须清空
+bool TestReclaim(int loops)
+{
+    FrameRing ring(4);
+    std::atomic<int64_t> latest{-1};
+    std::atomic<bool> running{true};
+    std::atomic<bool> ok{true};
+    std::atomic<int64_t> hits{0};
+
+    std::vector<std::thread> readers;
+    for (int i = 0; i < loops; i++)
+    {
+        readers.emplace_back([&]() {
+            int64_t count = 0;
+            while (running.load(std::memory_order_relaxed))
+            {
+                int64_t seq = latest.load(std::memory_order_acquire);
+                for (int64_t s = seq; s >= 0 && s > seq - 8; s--)
+                {
+                    PacketPtr pkt = ring.Get(s);
+                    if (pkt)
+                    {
+                        count++;
+                        if (pkt->Index() != (int32_t)s)
+                        {
+                            ok = false;
+                        }
+                    }
+                }
+            }
+            hits += count;
+        });
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    int64_t seq = 0;
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(kDurationMs))
+    {
+        PacketPtr pkt = Packet::NewPacket(64);
+        pkt->SetIndex(seq);
+        ring.Push(seq, std::move(pkt));
+        latest.store(seq, std::memory_order_release);
+        seq++;
+    }
+
+    running = false;
+    for (auto &t : readers)
+    {
+        t.join();
+    }
+
+    // 读者都已离开，再写一圈之后回收列表应该为空
+    for (int i = 0; i < 8; i++, seq++)
+    {
+        PacketPtr pkt = Packet::NewPacket(64);
+        pkt->SetIndex(seq);
+        ring.Push(seq, std::move(pkt));
+    }
+
+    std::cout << "reclaim loops " << loops << "\t: pushes " << seq << " hits " << hits.load() << " retired " << ring.Retired() << std::endl;
+    return ok && ring.Retired() == 0;
+}
+
+int main(int argc, const char **argv)
+{
+    bool ok = TestReclaim(1) && TestReclaim(4);
+    std::cout << "reclaim\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    // 预先分配数据包
+    for (int i = 0; i < 4096; i++)
+    {
+        packets.emplace_back(Packet::NewPacket(1024));
+    }
+
+    std::cout << "loops\tmutex calls/s\tmutex frames/s\tring calls/s\tring frames/s" << std::endl;
+
+    // 播放线程数量从 1 到 32
+    for (int loops = 1; loops <= 32; loops *= 2)
+    {
+        auto m = Run<MutexBuffer>(loops);
+        auto r = Run<RingBuffer>(loops);
+
+        std::cout << loops << "\t" << m.first * 1000 / kDurationMs
+                  << "\t" << m.second * 1000 / kDurationMs
+                  << "\t" << r.first * 1000 / kDurationMs
+                  << "\t" << r.second * 1000 / kDurationMs << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,373 @@
+#include <iostream>
+#include <string>
+#include <future>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "network/net/EventLoopThread.h"
+#include "network/net/TcpConnection.h"
+#include "mmedia/rtmp/RtmpHeader.h"
+#include "base/DomainInfo.h"
+#include "base/AppInfo.h"
+#include "live/Session.h"
+#include "live/Stream.h"
+#include "live/PlayerUser.h"
+
+using namespace lss::base;
+using namespace lss::network;
+using namespace lss::mm;
+using namespace lss::live;
+
+const std::string kSessionName = "domain/app/stream";
+
+// 推流开始时的编解码头，之后在缓冲区内换两次编解码头
+const int64_t kHeaders[] = {0, 1200, 1550};
+
+// 不发送数据，只从流中读取帧的播放用户，用来比较原始流和副本
+class TestPlayer : public PlayerUser
+{
+public:
+    using PlayerUser::PlayerUser;
+
+    bool PostFrames() override
+    {
+        return false;
+    }
+
+    // 读取新到的所有帧，reset 为 true 时从头开始定位 GOP
+    // 像发送一样取走每一批的编解码头和帧，记录本次读到的编解码头和帧
+    void Read(bool reset)
+    {
+        if (reset)
+        {
+            out_index_ = -1;
+        }
+        meta_read_.reset();
+        audio_read_.reset();
+        video_read_.reset();
+        frames_.clear();
+
+        auto self = std::dynamic_pointer_cast<PlayerUser>(shared_from_this());
+        while (true)
+        {
+            GetStream()->GetFrames(self);
+            if (!meta_ && !audio_header_ && !video_header_ && out_frames_.empty())
+            {
+                break;
+            }
+
+            if (meta_)
+            {
+                meta_read_ = meta_;
+            }
+            if (audio_header_)
+            {
+                audio_read_ = audio_header_;
+            }
+            if (video_header_)
+            {
+                video_read_ = video_header_;
+            }
+            frames_.insert(frames_.end(), out_frames_.begin(), out_frames_.end());
+            meta_.reset();
+            audio_header_.reset();
+            video_header_.reset();
+            out_frames_.clear();
+        }
+    }
+
+    const PacketPtr &MetaRead() const
+    {
+        return meta_read_;
+    }
+
+    const PacketPtr &AudioRead() const
+    {
+        return audio_read_;
+    }
+
+    const PacketPtr &VideoRead() const
+    {
+        return video_read_;
+    }
+
+    const std::vector<PacketPtr> &Frames() const
+    {
+        return frames_;
+    }
+
+    int32_t OutIndex() const
+    {
+        return out_index_;
+    }
+
+private:
+    PacketPtr meta_read_;
+    PacketPtr audio_read_;
+    PacketPtr video_read_;
+    std::vector<PacketPtr> frames_;
+};
+
+using TestPlayerPtr = std::shared_ptr<TestPlayer>;
+
+// 在事件循环中执行 func，等待执行完成
+template <typename Func>
+void RunAndWait(EventLoop *loop, Func func)
+{
+    std::promise<void> done;
+    loop->RunInLoop([&func, &done](){
+        func();
+        done.set_value();
+    });
+    done.get_future().get();
+}
+
+// 第 n 个数据包：开始和换头的位置依次为元数据、视频头、音频头，之后音视频交替，每 50 个包一个关键帧
+PacketPtr MakePacket(int64_t n)
+{
+    int64_t base = 0;
+    for (auto h : kHeaders)
+    {
+        if (n >= h)
+        {
+            base = h;
+        }
+    }
+
+    int32_t type;
+    int32_t msg_type;
+    int32_t len = 3;
+    char b0;
+    char b1 = 0;
+    if (n == base)
+    {
+        type = kPacketTypeMeta;
+        msg_type = kRtmpMsgTypeAMFMeta;
+        b0 = 0x02;
+    }
+    else if (n == base + 1)
+    {
+        type = kPacketTypeVideo;
+        msg_type = kRtmpMsgTypeVideo;
+        b0 = 0x17;
+    }
+    else if (n == base + 2)
+    {
+        type = kPacketTypeAudio;
+        msg_type = kRtmpMsgTypeAudio;
+        b0 = (char)0xAF;
+    }
+    else if (n % 2 == 0)
+    {
+        type = kPacketTypeVideo;
+        msg_type = kRtmpMsgTypeVideo;
+        b0 = n % 50 == 10 ? 0x17 : 0x27;
+        b1 = 1;
+        len = 300;
+    }
+    else
+    {
+        type = kPacketTypeAudio;
+        msg_type = kRtmpMsgTypeAudio;
+        b0 = (char)0xAF;
+        b1 = 1;
+        len = 100;
+    }
+
+    PacketPtr packet = Packet::NewPacket(len);
+    char *data = packet->Data();
+    data[0] = b0;
+    data[1] = b1;
+    for (int32_t i = 2; i < len; i++)
+    {
+        data[i] = (char)(n * 13 + i);
+    }
+    packet->SetPacketSize(len);
+    packet->SetPacketType(type);
+    packet->SetTimeStamp(n * 20);
+
+    RtmpMsgHeader *h = packet->InitHeader();
+    h->cs_id = type == kPacketTypeAudio ? 4 : 6;
+    h->msg_len = len;
+    h->msg_type = msg_type;
+    h->msg_sid = 1;
+    h->timestamp = n * 20;
+    return packet;
+}
+
+// 在推流的事件循环中推送 [from, to) 的数据包
+void Publish(EventLoop *loop, const StreamPtr &stream, int64_t from, int64_t to)
+{
+    RunAndWait(loop, [&](){
+        for (int64_t n = from; n < to; n++)
+        {
+            stream->AddPacket(MakePacket(n));
+        }
+    });
+}
+
+// 内容、索引、时间戳和类型都相同，副本中的是拷贝，不是同一个数据包
+bool SameCopy(const PacketPtr &a, const PacketPtr &b)
+{
+    if (!a || !b)
+    {
+        return !a && !b;
+    }
+
+    return a != b && a->Index() == b->Index() && a->TimeStamp() == b->TimeStamp()
+        && a->PacketType() == b->PacketType() && a->PacketSize() == b->PacketSize()
+        && memcmp(a->Data(), b->Data(), a->PacketSize()) == 0;
+}
+
+// 同一个延迟下原始流和副本定位到相同的 GOP，取到相同的编解码头和帧
+bool SameRead(const TestPlayerPtr &primary, const TestPlayerPtr &replica)
+{
+    bool ok = primary->OutIndex() == replica->OutIndex() && !primary->Frames().empty()
+        && primary->Frames().size() == replica->Frames().size();
+    ok = ok && SameCopy(primary->MetaRead(), replica->MetaRead()) && SameCopy(primary->AudioRead(), replica->AudioRead())
+        && SameCopy(primary->VideoRead(), replica->VideoRead());
+    for (size_t i = 0; ok && i < primary->Frames().size(); i++)
+    {
+        ok = SameCopy(primary->Frames()[i], replica->Frames()[i]);
+    }
+
+    // 副本的帧在副本所属的事件循环中重新分块
+    ok = ok && replica->Frames().front()->OutLayout<RtmpChunkLayout>();
+    return ok;
+}
+
+int main(int argc, const char **argv)
+{
+    EventLoopThread publisher_thread;
+    EventLoopThread player_thread;
+    publisher_thread.Run();
+    player_thread.Run();
+    EventLoop *publisher_loop = publisher_thread.Loop();
+    EventLoop *player_loop = player_thread.Loop();
+
+    // 有一个播放用户就成为热点流
+    DomainInfo domain;
+    AppInfoPtr app = std::make_shared<AppInfo>(domain);
+    app->replica_players = 1;
+
+    auto session = std::make_shared<Session>(kSessionName);
+    session->SetAppInfo(app);
+    StreamPtr primary = session->GetStream();
+
+    InetAddress addr("127.0.0.1:0");
+    int fds[2][2];
+    TcpConnectionPtr publisher_conn;
+    TcpConnectionPtr player_conn;
+    UserPtr publisher;
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds[0]);
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds[1]);
+    RunAndWait(publisher_loop, [&](){
+        publisher_conn = std::make_shared<TcpConnection>(publisher_loop, fds[0][0], addr, addr);
+        publisher = session->CreatePublishUser(publisher_conn, kSessionName, "", UserType::kUserTypePublishRtmp);
+        session->SetPublisher(publisher);
+    });
+
+    // 缓冲区已经绕过一圈，开始的编解码头早于缓冲区，第一次换头在缓冲区内
+    Publish(publisher_loop, primary, 0, 1500);
+
+    // 播放用户在另一个事件循环上，加入之后成为热点流
+    TestPlayerPtr player;
+    RunAndWait(player_loop, [&](){
+        player_conn = std::make_shared<TcpConnection>(player_loop, fds[1][0], addr, addr);
+        player = std::make_shared<TestPlayer>(player_conn, primary, session);
+        player->SetAppInfo(app);
+        session->AddPlayer(player);
+    });
+
+    // 副本所属的事件循环阻塞期间继续推流并第二次换头，转发来的数据包都排在复制之后，已经被复制过，应该全部丢弃
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    player_loop->RunInLoop([released](){
+        released.wait();
+    });
+    Publish(publisher_loop, primary, 1500, 1600);
+    release.set_value();
+
+    // 用不同的延迟比较定位到的 GOP、编解码头和帧
+    std::vector<int> latencies = {1000, 5000, 100 * 1000};
+    std::vector<TestPlayerPtr> primary_readers;
+    std::vector<TestPlayerPtr> replica_readers;
+    StreamPtr replica;
+    bool ok = true;
+    bool seeded = true;
+    RunAndWait(player_loop, [&](){
+        replica = player->GetStream();
+        ok = replica && replica != primary;
+        if (!ok)
+        {
+            return;
+        }
+
+        for (auto latency : latencies)
+        {
+            AppInfoPtr info = std::make_shared<AppInfo>(domain);
+            info->content_latency = latency;
+            auto p = std::make_shared<TestPlayer>(player_conn, primary, session);
+            auto r = std::make_shared<TestPlayer>(player_conn, replica, session);
+            p->SetAppInfo(info);
+            r->SetAppInfo(info);
+            p->Read(true);
+            r->Read(true);
+            seeded = seeded && SameRead(p, r);
+            primary_readers.push_back(p);
+            replica_readers.push_back(r);
+        }
+
+        // 重复保存转发来的编解码头会让副本的流版本多出来
+        seeded = seeded && replica->StreamVersion() == primary->StreamVersion();
+    });
+    ok = ok && seeded;
+    std::cout << "seed mid-stream\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    // 复制完成之后转发来的数据包正常保存
+    Publish(publisher_loop, primary, 1600, 1700);
+    bool forward = ok;
+    RunAndWait(player_loop, [&](){
+        for (size_t i = 0; forward && i < latencies.size(); i++)
+        {
+            primary_readers[i]->Read(false);
+            replica_readers[i]->Read(false);
+            forward = SameRead(primary_readers[i], replica_readers[i]) && replica_readers[i]->OutIndex() == 1699;
+        }
+    });
+    ok = ok && forward;
+    std::cout << "forward\t\t: " << (forward ? "ok" : "failed") << std::endl;
+
+    // 发布者迁移到播放用户所在的事件循环之后，下一次转发时分组切回原始流，副本不再收到数据包
+    session->SetPublisherLoop(publisher, player_loop);
+    Publish(publisher_loop, primary, 1700, 1710);
+    bool migrate = forward;
+    RunAndWait(player_loop, [&](){
+        migrate = migrate && player->GetStream() == primary;
+        primary_readers.back()->Read(false);
+        replica_readers.back()->Read(false);
+        migrate = migrate && primary_readers.back()->OutIndex() == 1709 && replica_readers.back()->OutIndex() == 1699;
+    });
+    ok = ok && migrate;
+    std::cout << "migrate\t\t: " << (migrate ? "ok" : "failed") << std::endl;
+
+    std::cout << "stream replica\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    // 连接在各自的事件循环中释放
+    RunAndWait(player_loop, [&](){
+        primary_readers.clear();
+        replica_readers.clear();
+        session->CloseUser(player);
+        player.reset();
+        player_conn.reset();
+    });
+    RunAndWait(publisher_loop, [&](){
+        session->CloseUser(publisher);
+        publisher.reset();
+        publisher_conn.reset();
+    });
+    ::close(fds[0][1]);
+    ::close(fds[1][1]);
+    return 0;
+}
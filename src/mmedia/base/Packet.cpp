@@ -1,4 +1,6 @@
+#include <new>
 #include "Packet.h"
+#include "PacketPool.h"
 
 using namespace lss::mm;
 
@@ -8,27 +10,83 @@ PacketPtr Packet::NewPacket(int32_t size)
     // 计算需要分配的内存块大小：数据部分大小 + Packet 对象的大小
     auto block_size = size + sizeof(Packet);
 
-    // 动态分配内存，分配大小为 block_size 的连续内存块，并将该内存块强制转换为 Packet* 类型
-    Packet *packet = (Packet *) new char[block_size];
+    // 从当前线程的内存池分配，数据部分不清零，由写入者负责填充，包的大小之外的数据不会被读取
+    void *block = PacketPool::Allocate(block_size);
 
-    // 将分配的内存块初始化为全 0
-    memset((void*)packet, 0x00, block_size);
+    // 在内存块的头部构造 Packet 对象，容量为传入的 size，索引为 -1，类型为未知类型
+    Packet *packet = new (block) Packet(size);
 
-    // 初始化包的索引值为 -1，表示无效索引
-    packet->index_ = -1;
+    // 返回智能指针 PacketPtr，引用计数在包对象内部，不需要单独分配控制块
+    return PacketPtr(packet);
+}
 
-    // 初始化包的类型为未知类型
-    packet->type_ = kPacketTypeUnknowed;
+// 创建由切片组成的数据包，只分配包对象本身，数据由切片引用
+PacketPtr Packet::NewSlicedPacket(int32_t size)
+{
+    void *block = PacketPool::Allocate(sizeof(Packet));
+
+    Packet *packet = new (block) Packet(size);
+    packet->sliced_ = true;
 
-    // 初始化包的容量为传入的 size
-    packet->capacity_ = size;
+    return PacketPtr(packet);
+}
 
-    // 将扩展数据指针重置为空
-    packet->ext_.reset();
+void Packet::Destroy(Packet *packet)
+{
+    // 先析构成员（切片、扩展数据和输出布局）再释放内存
+    packet->~Packet();
+    PacketPool::Free(packet);
+}
 
-    // 返回智能指针 PacketPtr，第二个参数为自定义删除器，用于释放分配的内存
-    return PacketPtr(packet, [](Packet *p){
-        delete [](char*)p;  // 使用 delete[] 释放 char 数组内存
+PacketPtr Packet::Clone()
+{
+    PacketPtr packet = NewPacket(size_);
+
+    // 切片组成的包逐个切片复制，不合并原数据包的切片
+    char *dst = packet->Data();
+    ForEachSlice(0, size_, [&dst](const BufferSlice &slice){
+        memcpy(dst, slice.data, slice.size);
+        dst += slice.size;
     });
-    
-}
\ No newline at end of file
+
+    packet->size_ = size_;
+    packet->type_ = type_;
+    packet->index_ = index_;
+    packet->timestamp_ = timestamp_;
+    packet->header_ = header_;
+    packet->has_header_ = has_header_;
+    packet->ext_ = ext_;
+
+    return packet;
+}
+
+char *Packet::SlicedData()
+{
+    if (slices_.empty())
+    {
+        return nullptr;
+    }
+
+    // 只有一个切片时数据已经连续
+    if (slices_.size() > 1)
+    {
+        // 合并到新分配的内存中，由切片持有
+        std::shared_ptr<char> block(new char[size_], std::default_delete<char[]>());
+        char *p = block.get();
+        for (auto &s : slices_)
+        {
+            memcpy(p, s.data, s.size);
+            p += s.size;
+        }
+
+        BufferSlice slice;
+        slice.block = block;
+        slice.data = block.get();
+        slice.size = size_;
+
+        slices_.clear();
+        slices_.emplace_back(std::move(slice));
+    }
+
+    return const_cast<char*>(slices_[0].data);
+}
@@ -3,6 +3,12 @@
 #include <memory>
 #include <cstring>
 #include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <functional>
+#include "network/base/MsgBuffer.h"
 
 namespace lss
 {
@@ -23,12 +29,38 @@ namespace lss
         // 前向声明 Packet 类
         class Packet;
 
-        // 定义 Packet 类的智能指针类型别名
-        using PacketPtr = std::shared_ptr<Packet>;
+        // 数据包的智能指针，引用计数在包对象内部，见文件末尾的定义
+        class PacketPtr;
+
+        // 接收缓冲区的切片
+        using BufferSlice = lss::network::BufferSlice;
 
     #pragma pack(push)
     #pragma pack(1)     // 设置结构体内存对齐为 1 字节
 
+    // 协议消息头，内嵌在数据包中，与数据包一起分配
+    struct PacketHeader
+    {
+        uint32_t cs_id{0};      // 标识消息所属的通道
+        uint32_t timestamp{0};  // 时间戳（增量）
+        uint32_t msg_len{0};    // 消息长度
+        uint8_t  msg_type{0};   // 消息类型ID
+        uint32_t msg_sid{0};    // 消息流ID
+
+        // 构造函数
+        PacketHeader()
+            : cs_id(0)
+            , timestamp(0)
+            , msg_len(0)
+            , msg_type(0)
+            , msg_sid(0)
+        {
+
+        }
+    };
+
+    #pragma pack(pop)   // 只有消息头按 1 字节对齐，数据包不是线路格式，按自然对齐排列成员
+
     // 数据包类
     class Packet
     {
@@ -42,6 +74,13 @@ namespace lss
         // 静态函数，用于创建新的 Packet 对象
         static PacketPtr NewPacket(int32_t size);
 
+        // 创建一个由切片组成的数据包，数据不在包内，而是引用接收缓冲区的数据块，size 为消息的总长度
+        static PacketPtr NewSlicedPacket(int32_t size);
+
+        // 深拷贝数据包，数据复制到新分配的连续内存中，类型、索引、时间戳和消息头相同，扩展数据与原数据包共享
+        // 输出布局引用原数据包的内存，不复制
+        PacketPtr Clone();
+
         // 判断包是否为视频类型
         bool IsVideo() const
         {
@@ -132,13 +171,107 @@ namespace lss
             return timestamp_;
         }
 
-        // 获取包数据的起始位置
+        // 获取包数据的起始位置，由多个切片组成的包第一次调用时合并为连续的内存
+        // 合并会修改数据包，切片组成的包只能在共享给其他线程之前调用，之后使用 ForEachSlice 访问数据
         inline char *Data()
         {
+            if (sliced_)
+            {
+                return SlicedData();
+            }
             return (char*)this + sizeof(Packet);
         }
 
+        // 获取至少 len 字节连续数据的起始地址，第一个切片足够长时不需要合并
+        inline const char *Head(size_t len)
+        {
+            if (sliced_ && !slices_.empty() && slices_[0].size >= len)
+            {
+                return slices_[0].data;
+            }
+            return Data();
+        }
+
+        // 是否由切片组成
+        bool IsSliced() const
+        {
+            return sliced_;
+        }
+
+        // 追加一个切片，包的大小增加切片的长度
+        void AppendSlice(BufferSlice &&slice)
+        {
+            size_ += slice.size;
+            slices_.emplace_back(std::move(slice));
+        }
+
+        // 按顺序遍历包数据中 [offset, offset + len) 的连续片段，对每个片段调用 f(const BufferSlice &)
+        // 切片组成的包返回持有数据块引用的子切片，普通的包返回不持有引用的片段，由包本身保证数据有效
+        template <typename F>
+        void ForEachSlice(size_t offset, size_t len, F &&f)
+        {
+            if (!sliced_)
+            {
+                BufferSlice slice;
+                slice.data = Data() + offset;
+                slice.size = len;
+                f(slice);
+                return;
+            }
+
+            for (auto &s : slices_)
+            {
+                if (len == 0)
+                {
+                    break;
+                }
+
+                // 跳过起始位置之前的切片
+                if (offset >= s.size)
+                {
+                    offset -= s.size;
+                    continue;
+                }
+
+                BufferSlice slice;
+                slice.block = s.block;
+                slice.data = s.data + offset;
+                slice.size = std::min(s.size - offset, len);
+                f(slice);
+
+                len -= slice.size;
+                offset = 0;
+            }
+        }
+
+        // 获取消息头，没有设置过消息头时返回空
+        inline PacketHeader *Header()
+        {
+            return has_header_ ? &header_ : nullptr;
+        }
+
+        inline const PacketHeader *Header() const
+        {
+            return has_header_ ? &header_ : nullptr;
+        }
+
+        // 初始化消息头并返回，所有字段清零，由调用者填充
+        inline PacketHeader *InitHeader()
+        {
+            header_ = PacketHeader();
+            has_header_ = true;
+            return &header_;
+        }
+
+        // 设置消息头，拷贝 header 的内容
+        inline void SetHeader(const PacketHeader &header)
+        {
+            header_ = header;
+            has_header_ = true;
+        }
+
         // 获取扩展数据，使用模板函数和类型安全的智能指针转换
+        // 协议消息头使用 Header()，扩展数据只用于不常访问的附加信息，每次访问都有引用计数的开销
         template <typename T>
         inline std::shared_ptr<T> Ext() const
         {
@@ -151,10 +284,49 @@ namespace lss
             ext_ = ext;
         }
 
+        // 获取发送端预先构建的输出布局，没有时返回空，不增加引用计数，由持有数据包的一方保证有效
+        template <typename T>
+        inline const T *OutLayout() const
+        {
+            return static_cast<const T*>(out_layout_.get());
+        }
+
+        // 设置输出布局，只能在数据包发布给其他线程之前调用，之后只读
+        inline void SetOutLayout(const std::shared_ptr<void> &layout)
+        {
+            out_layout_ = layout;
+        }
+
         // 析构函数
         ~Packet() {}
 
     private:
+        friend class PacketPtr;
+
+        // 增加引用计数
+        inline void AddRef()
+        {
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // 减少引用计数，最后一个引用释放时销毁数据包
+        inline void Release()
+        {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+            {
+                Destroy(this);
+            }
+        }
+
+        // 析构数据包并把内存还给内存池
+        static void Destroy(Packet *packet);
+
+        // 合并所有切片为连续的内存，之后只有一个切片
+        char *SlicedData();
+
+        // 引用计数
+        std::atomic<int32_t> refs_{0};
+
         // 包的类型，默认为未知类型
         int32_t type_{kPacketTypeUnknowed};
 
@@ -170,10 +342,168 @@ namespace lss
         // 包的容量
         uint32_t capacity_{0};
 
+        // 协议消息头，has_header_ 为 true 时有效
+        PacketHeader header_;
+
+        // 是否设置了消息头
+        bool has_header_{false};
+
         // 扩展数据指针，允许存储额外的信息
         std::shared_ptr<void> ext_;
+
+        // 输出布局，指向本数据包的内存，拷贝数据包时不复制
+        std::shared_ptr<void> out_layout_;
+
+        // 组成包数据的切片，只有 sliced_ 为 true 时使用
+        std::vector<BufferSlice> slices_;
+
+        // 数据是否由切片组成，为 false 时数据紧跟在包对象之后
+        bool sliced_{false};
     };
 
-    #pragma pack()     // 恢复默认的内存对齐
+    // 数据紧跟在包对象之后，包对象的大小是最大对齐的整数倍，数据的起始地址与内存池返回的地址一样对齐
+    static_assert(sizeof(Packet) % alignof(std::max_align_t) == 0, "packet payload must stay aligned");
+
+    // 数据包的智能指针，接口与 std::shared_ptr<Packet> 的常用部分相同，原来的用法不需要修改
+    // 引用计数保存在包对象内部，包对象、消息头和数据在同一块内存中，不需要单独分配控制块
+    class PacketPtr
+    {
+    public:
+        PacketPtr() = default;
+
+        PacketPtr(std::nullptr_t)
+        {
+        }
+
+        // 接管包对象，引用计数加一
+        explicit PacketPtr(Packet *packet)
+            : packet_(packet)
+        {
+            if (packet_)
+            {
+                packet_->AddRef();
+            }
+        }
+
+        PacketPtr(const PacketPtr &other)
+            : PacketPtr(other.packet_)
+        {
+        }
+
+        PacketPtr(PacketPtr &&other) noexcept
+            : packet_(other.packet_)
+        {
+            other.packet_ = nullptr;
+        }
+
+        ~PacketPtr()
+        {
+            if (packet_)
+            {
+                packet_->Release();
+            }
+        }
+
+        PacketPtr &operator=(const PacketPtr &other)
+        {
+            PacketPtr(other).swap(*this);
+            return *this;
+        }
+
+        PacketPtr &operator=(PacketPtr &&other) noexcept
+        {
+            PacketPtr(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        PacketPtr &operator=(std::nullptr_t)
+        {
+            reset();
+            return *this;
+        }
+
+        // 释放引用，置为空
+        void reset()
+        {
+            PacketPtr().swap(*this);
+        }
+
+        void swap(PacketPtr &other) noexcept
+        {
+            std::swap(packet_, other.packet_);
+        }
+
+        Packet *get() const
+        {
+            return packet_;
+        }
+
+        Packet *operator->() const
+        {
+            return packet_;
+        }
+
+        Packet &operator*() const
+        {
+            return *packet_;
+        }
+
+        explicit operator bool() const
+        {
+            return packet_ != nullptr;
+        }
+
+        // 当前的引用数量，只用于调试和测试
+        long use_count() const
+        {
+            return packet_ ? packet_->refs_.load(std::memory_order_relaxed) : 0;
+        }
+
+    private:
+        Packet *packet_{nullptr};
+    };
+
+    inline bool operator==(const PacketPtr &a, const PacketPtr &b)
+    {
+        return a.get() == b.get();
+    }
+
+    inline bool operator!=(const PacketPtr &a, const PacketPtr &b)
+    {
+        return a.get() != b.get();
+    }
+
+    inline bool operator==(const PacketPtr &a, std::nullptr_t)
+    {
+        return !a;
     }
+
+    inline bool operator!=(const PacketPtr &a, std::nullptr_t)
+    {
+        return (bool)a;
+    }
+
+    inline bool operator==(std::nullptr_t, const PacketPtr &a)
+    {
+        return !a;
+    }
+
+    inline bool operator!=(std::nullptr_t, const PacketPtr &a)
+    {
+        return (bool)a;
+    }
+    }
+}
+
+namespace std
+{
+    // 可以作为无序容器的键，与 std::shared_ptr 一样按地址计算哈希
+    template <>
+    struct hash<lss::mm::PacketPtr>
+    {
+        size_t operator()(const lss::mm::PacketPtr &packet) const
+        {
+            return hash<lss::mm::Packet*>()(packet.get());
+        }
+    };
 }
\ No newline at end of file
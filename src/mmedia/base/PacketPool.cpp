@@ -0,0 +1,316 @@
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <algorithm>
+#include "PacketPool.h"
+
+using namespace lss::mm;
+
+namespace
+{
+    // 块头部的大小，保证返回的地址按 16 字节对齐
+    const size_t kHeaderSize = 16;
+
+    // 最小和最大的级别，单位：字节，包含块头部
+    const size_t kMinClassSize = 64;
+    const size_t kMaxClassSize = 4 * 1024 * 1024;
+
+    // 1KB 以下按 2 的幂分级，以上每个 2 的幂之间再分 4 级，浪费不超过 25%
+    const size_t kFineClassSize = 1024;
+
+    // 每个级别的空闲链表最多缓存的字节数，大块至少缓存 kMinHeldBlocks 个
+    const size_t kMaxHeldBytes = 4 * 1024 * 1024;
+    const size_t kMinHeldBlocks = 4;
+
+    // 超过最大级别的块的级别编号
+    const uint32_t kOversize = 0xffffffff;
+
+    // 空闲块，复用块头部的空间保存链表指针
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    struct ThreadPool;
+
+    // 块头部，记录所属线程的内存池和级别，释放时据此归还
+    struct BlockHeader
+    {
+        ThreadPool *owner;
+        uint32_t cls;
+    };
+
+    static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header too large");
+
+    // 一个级别的空闲链表和统计
+    struct ClassPool
+    {
+        // 本线程的空闲链表，只由所属线程访问
+        FreeBlock *local{nullptr};
+
+        // 本线程空闲链表中块的数量
+        size_t local_count{0};
+
+        // 以下统计由所属线程写入，其他线程只读
+        std::atomic<uint64_t> hits{0};
+        std::atomic<uint64_t> misses{0};
+        std::atomic<uint64_t> local_bytes{0};
+
+        // 与所属线程的字段隔开，其他线程释放时不让所属线程的缓存行失效
+        char pad[64];
+
+        // 其他线程释放的块，无锁栈，所属线程一次取走
+        std::atomic<FreeBlock*> remote{nullptr};
+
+        // 以下统计由释放块的其他线程累加
+        std::atomic<uint64_t> remote_frees{0};
+        std::atomic<uint64_t> remote_bytes{0};
+    };
+
+    // 计算所有级别的块大小
+    std::vector<size_t> make_classes()
+    {
+        std::vector<size_t> sizes;
+        size_t size = kMinClassSize;
+        while (size < kFineClassSize)
+        {
+            sizes.push_back(size);
+            size <<= 1;
+        }
+
+        for (size_t base = kFineClassSize; base < kMaxClassSize; base <<= 1)
+        {
+            for (size_t i = 0; i < 4; i++)
+            {
+                sizes.push_back(base + base / 4 * i);
+            }
+        }
+        sizes.push_back(kMaxClassSize);
+
+        return sizes;
+    }
+
+    // 级别的块大小，进程运行期间不变
+    const std::vector<size_t> &class_sizes()
+    {
+        static std::vector<size_t> sizes = make_classes();
+        return sizes;
+    }
+
+    // 每个线程的内存池
+    struct ThreadPool
+    {
+        ThreadPool()
+            : classes(new ClassPool[class_sizes().size()])
+        {
+        }
+
+        std::unique_ptr<ClassPool[]> classes;
+    };
+
+    // 所有线程的内存池，用于汇总统计
+    std::mutex &registry_lock()
+    {
+        static std::mutex lock;
+        return lock;
+    }
+
+    std::vector<ThreadPool*> &registry()
+    {
+        static std::vector<ThreadPool*> pools;
+        return pools;
+    }
+
+    // 超过最大级别的申请次数
+    std::atomic<uint64_t> oversize_count{0};
+
+    // 当前线程的内存池
+    thread_local ThreadPool *t_pool = nullptr;
+
+    // 获取当前线程的内存池，第一次使用时创建，之后不再释放
+    ThreadPool *current_pool()
+    {
+        if (!t_pool)
+        {
+            t_pool = new ThreadPool();
+
+            std::lock_guard<std::mutex> lk(registry_lock());
+            registry().push_back(t_pool);
+        }
+        return t_pool;
+    }
+
+    // 所属线程累加统计，不需要原子的读改写
+    void add(std::atomic<uint64_t> &counter, int64_t n)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    // 空闲链表是否已经缓存足够多的块
+    bool full(const ClassPool &pool, size_t size)
+    {
+        return pool.local_count >= kMinHeldBlocks && (pool.local_count + 1) * size > kMaxHeldBytes;
+    }
+
+    // 块放回所属线程的空闲链表，超过缓存上限时还给系统
+    void push_local(ClassPool &pool, FreeBlock *block, size_t size)
+    {
+        if (full(pool, size))
+        {
+            ::operator delete(block);
+            return;
+        }
+
+        block->next = pool.local;
+        pool.local = block;
+        pool.local_count++;
+        add(pool.local_bytes, size);
+    }
+
+    // 取走其他线程归还的块，放入本线程的空闲链表
+    void drain_remote(ClassPool &pool, size_t size)
+    {
+        FreeBlock *block = pool.remote.exchange(nullptr, std::memory_order_acquire);
+        while (block)
+        {
+            FreeBlock *next = block->next;
+            pool.remote_bytes.fetch_sub(size, std::memory_order_relaxed);
+            push_local(pool, block, size);
+            block = next;
+        }
+    }
+}
+
+void *PacketPool::Allocate(size_t size)
+{
+    size_t total = size + kHeaderSize;
+    auto &sizes = class_sizes();
+    auto iter = std::lower_bound(sizes.begin(), sizes.end(), total);
+
+    // 超过最大级别，直接向系统申请
+    if (iter == sizes.end())
+    {
+        oversize_count.fetch_add(1, std::memory_order_relaxed);
+
+        BlockHeader *header = static_cast<BlockHeader*>(::operator new(total));
+        header->owner = nullptr;
+        header->cls = kOversize;
+        return reinterpret_cast<char*>(header) + kHeaderSize;
+    }
+
+    uint32_t cls = static_cast<uint32_t>(iter - sizes.begin());
+    size_t block_size = *iter;
+    ThreadPool *owner = current_pool();
+    ClassPool &pool = owner->classes[cls];
+
+    // 本线程的空闲链表用完时取走其他线程归还的块
+    if (!pool.local)
+    {
+        drain_remote(pool, block_size);
+    }
+
+    void *block = nullptr;
+    if (pool.local)
+    {
+        FreeBlock *free_block = pool.local;
+        pool.local = free_block->next;
+        pool.local_count--;
+        add(pool.local_bytes, -static_cast<int64_t>(block_size));
+        add(pool.hits, 1);
+        block = free_block;
+    }
+    else
+    {
+        add(pool.misses, 1);
+        block = ::operator new(block_size);
+    }
+
+    BlockHeader *header = static_cast<BlockHeader*>(block);
+    header->owner = owner;
+    header->cls = cls;
+    return reinterpret_cast<char*>(header) + kHeaderSize;
+}
+
+void PacketPool::Free(void *p)
+{
+    if (!p)
+    {
+        return;
+    }
+
+    BlockHeader *header = reinterpret_cast<BlockHeader*>(static_cast<char*>(p) - kHeaderSize);
+    if (header->cls == kOversize)
+    {
+        ::operator delete(header);
+        return;
+    }
+
+    ThreadPool *owner = header->owner;
+    ClassPool &pool = owner->classes[header->cls];
+    size_t block_size = class_sizes()[header->cls];
+    FreeBlock *block = reinterpret_cast<FreeBlock*>(header);
+
+    // 所属线程释放，直接放回空闲链表
+    if (owner == t_pool)
+    {
+        push_local(pool, block, block_size);
+        return;
+    }
+
+    // 其他线程释放，压入所属线程的无锁栈
+    pool.remote_frees.fetch_add(1, std::memory_order_relaxed);
+    pool.remote_bytes.fetch_add(block_size, std::memory_order_relaxed);
+    FreeBlock *head = pool.remote.load(std::memory_order_relaxed);
+    do
+    {
+        block->next = head;
+    } while (!pool.remote.compare_exchange_weak(head, block, std::memory_order_release, std::memory_order_relaxed));
+}
+
+PacketPoolStats PacketPool::Stats()
+{
+    auto &sizes = class_sizes();
+
+    PacketPoolStats stats;
+    stats.classes.resize(sizes.size());
+    for (size_t i = 0; i < sizes.size(); i++)
+    {
+        stats.classes[i].size = sizes[i];
+    }
+
+    std::lock_guard<std::mutex> lk(registry_lock());
+    for (auto pool : registry())
+    {
+        for (size_t i = 0; i < sizes.size(); i++)
+        {
+            ClassPool &cp = pool->classes[i];
+            PacketPoolClassStats &cs = stats.classes[i];
+            cs.hits += cp.hits.load(std::memory_order_relaxed);
+            cs.misses += cp.misses.load(std::memory_order_relaxed);
+            cs.remote_frees += cp.remote_frees.load(std::memory_order_relaxed);
+            cs.bytes_held += cp.local_bytes.load(std::memory_order_relaxed) + cp.remote_bytes.load(std::memory_order_relaxed);
+        }
+    }
+
+    for (auto &cs : stats.classes)
+    {
+        stats.hits += cs.hits;
+        stats.misses += cs.misses;
+        stats.remote_frees += cs.remote_frees;
+        stats.bytes_held += cs.bytes_held;
+    }
+    stats.oversize = oversize_count.load(std::memory_order_relaxed);
+
+    return stats;
+}
+
+size_t PacketPool::Classes()
+{
+    return class_sizes().size();
+}
+
+size_t PacketPool::ClassSize(size_t index)
+{
+    return class_sizes()[index];
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lss
+{
+    namespace mm
+    {
+        // 一个大小级别的统计
+        struct PacketPoolClassStats
+        {
+            // 级别的块大小，单位：字节
+            size_t size{0};
+
+            // 从空闲链表分配的次数
+            uint64_t hits{0};
+
+            // 空闲链表为空，向系统申请的次数
+            uint64_t misses{0};
+
+            // 由其他线程释放、归还到所属线程的次数
+            uint64_t remote_frees{0};
+
+            // 空闲链表中缓存的字节数
+            uint64_t bytes_held{0};
+        };
+
+        // 内存池的统计，大小超过最大级别的申请计入 oversize，不经过内存池
+        struct PacketPoolStats
+        {
+            // 各个级别的统计
+            std::vector<PacketPoolClassStats> classes;
+
+            // 所有级别的汇总
+            uint64_t hits{0};
+            uint64_t misses{0};
+            uint64_t remote_frees{0};
+            uint64_t bytes_held{0};
+
+            // 超过最大级别直接向系统申请的次数
+            uint64_t oversize{0};
+        };
+
+        // 数据包的内存池，按大小分级，每个线程一个
+        // 分配和同一线程的释放只访问本线程的空闲链表，不加锁；其他线程释放的块通过无锁栈归还到所属线程，
+        // 所属线程的空闲链表用完时一次取走。分配出去的内存不清零
+        // 线程退出时内存池不释放，其他线程仍然可以归还内存块
+        class PacketPool
+        {
+        public:
+            // 从当前线程的内存池分配 size 字节，按 16 字节对齐
+            static void *Allocate(size_t size);
+
+            // 释放 Allocate 分配的内存，可以在任何线程调用
+            static void Free(void *p);
+
+            // 所有线程的内存池汇总的统计
+            static PacketPoolStats Stats();
+
+            // 级别的数量
+            static size_t Classes();
+
+            // 第 index 个级别的块大小
+            static size_t ClassSize(size_t index);
+        };
+    }
+}
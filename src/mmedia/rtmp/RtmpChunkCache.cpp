@@ -0,0 +1,167 @@
+#include <cstring>
+#include "RtmpChunkCache.h"
+#include "RtmpHeader.h"
+
+using namespace lss::mm;
+
+RtmpChunkCache::RtmpChunkCache(size_t slots)
+    : slots_(slots > 0 ? slots : 1)     // 至少保留一个槽位
+{
+}
+
+RtmpChunkLayoutPtr RtmpChunkCache::GetLayout(const PacketPtr &packet, int32_t chunk_size, uint32_t ext_timestamp)
+{
+    // 获取数据包的消息头
+    const RtmpMsgHeader *h = packet->Header();
+
+    // 如果消息头不存在，无法分块
+    if (!h)
+    {
+        return RtmpChunkLayoutPtr();
+    }
+
+    // 根据数据包索引定位槽位
+    auto &slot = slots_[(uint32_t)packet->Index() % slots_.size()];
+
+    {
+        // 加锁保护槽位
+        std::lock_guard<std::mutex> lk(lock_);
+
+        // 槽位中存放的是旧数据包的布局，清空后重新缓存
+        if (!slot.empty() && slot.front()->packet.get() != packet.get())
+        {
+            slot.clear();
+        }
+
+        // 查找分块参数相同的布局
+        for (auto const &l : slot)
+        {
+            if (l->chunk_size == chunk_size && l->cs_id == h->cs_id && l->ext_timestamp == ext_timestamp)
+            {
+                return l;
+            }
+        }
+    }
+
+    // 在锁外构建布局，避免阻塞其他播放者
+    auto layout = BuildLayout(packet, chunk_size, ext_timestamp);
+
+    // 缓存中的布局持有数据包，槽位被新数据包占用之前数据包一直有效
+    layout->packet = packet;
+
+    {
+        // 加锁保护槽位
+        std::lock_guard<std::mutex> lk(lock_);
+
+        // 构建期间槽位可能已被其他数据包占用
+        if (!slot.empty() && slot.front()->packet.get() != packet.get())
+        {
+            slot.clear();
+        }
+
+        // 其他线程可能已经构建了相同的布局，优先使用已缓存的
+        for (auto const &l : slot)
+        {
+            if (l->chunk_size == chunk_size && l->cs_id == h->cs_id && l->ext_timestamp == ext_timestamp)
+            {
+                return l;
+            }
+        }
+
+        // 缓存新构建的布局
+        slot.emplace_back(layout);
+    }
+
+    // 返回新构建的布局
+    return layout;
+}
+
+RtmpChunkLayoutPtr RtmpChunkCache::BuildLayout(const PacketPtr &packet, int32_t chunk_size, uint32_t ext_timestamp)
+{
+    // 获取数据包的消息头
+    const RtmpMsgHeader *h = packet->Header();
+
+    // 如果消息头不存在或块大小非法，无法分块
+    if (!h || chunk_size <= 0)
+    {
+        return RtmpChunkLayoutPtr();
+    }
+
+    // 创建布局并记录分块参数
+    auto layout = std::make_shared<RtmpChunkLayout>();
+    layout->chunk_size = chunk_size;
+    layout->cs_id = h->cs_id;
+    layout->ext_timestamp = ext_timestamp;
+
+    // 计算后续块头部的长度：基本头 1~3 字节，加上可选的 4 字节扩展时间戳
+    int32_t header_len = h->cs_id < 64 ? 1 : (h->cs_id < (64 + 256) ? 2 : 3);
+
+    if (ext_timestamp != 0)
+    {
+        header_len += 4;
+    }
+
+    // 计算块数量，空消息也占一个块
+    int32_t chunks = h->msg_len > 0 ? (h->msg_len + chunk_size - 1) / chunk_size : 1;
+
+    // 一次性分配全部后续块头部，保证 iovec 指向的地址不再变化
+    layout->headers.resize((chunks - 1) * header_len);
+    layout->iovs.reserve(chunks * 2 - 1);
+
+    // 指向当前要写入的后续块头部
+    char *p = layout->headers.data();
+
+    // 用于跟踪已经处理的数据字节数
+    int32_t bytes_parsed = 0;
+
+    while (true)
+    {
+        // 计算当前块的大小
+        int32_t size = std::min((int32_t)h->msg_len - bytes_parsed, chunk_size);
+
+        // 添加消息体块，跨越多个切片的块拆成多个片段，切片的数据块由布局持有的数据包保持有效
+        packet->ForEachSlice(bytes_parsed, size, [&layout](const BufferSlice &slice){
+            layout->iovs.push_back({(void*)slice.data, slice.size});
+        });
+        bytes_parsed += size;
+
+        // 消息体已经全部分块，退出循环
+        if (bytes_parsed >= (int32_t)h->msg_len)
+        {
+            break;
+        }
+
+        // 构建后续块（格式3）的头部
+        char *start = p;
+
+        if (h->cs_id < 64)
+        {
+            *p++ = (char)(0xC0 | h->cs_id);
+        }
+        else if (h->cs_id < (64 + 256))
+        {
+            *p++ = (char)(0xC0 | 0);
+            *p++ = (char)(h->cs_id - 64);
+        }
+        else
+        {
+            *p++ = (char)(0xC0 | 1);
+            uint16_t cs = h->cs_id - 64;
+            memcpy(p, &cs, sizeof(uint16_t));
+            p += sizeof(uint16_t);
+        }
+
+        // 写入扩展时间戳，与首块头部保持一致
+        if (ext_timestamp != 0)
+        {
+            memcpy(p, &ext_timestamp, 4);
+            p += 4;
+        }
+
+        // 添加后续块头部
+        layout->iovs.push_back({start, (size_t)(p - start)});
+    }
+
+    // 返回构建好的布局
+    return layout;
+}
@@ -0,0 +1,78 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <sys/uio.h>
+#include "network/net/Connection.h"
+#include "mmedia/base/Packet.h"
+
+namespace lss
+{
+    namespace mm
+    {
+        using namespace lss::network;
+
+        // 一个数据包按某种分块参数切好之后的布局，除首块头部外的所有内容都与具体连接无关
+        // 布局内的 iovec 被所有播放者共享，只读不写，发送时整段复制到连接的 iovec 数组中
+        struct RtmpChunkLayout
+        {
+            // 缓存中的布局持有数据包，保证消息体在发送期间有效
+            // 随数据包发布的布局为空，由数据包持有布局，发送方持有数据包，避免循环引用
+            PacketPtr packet;
+
+            // 分块大小
+            int32_t chunk_size{0};
+
+            // 块流 ID
+            uint32_t cs_id{0};
+
+            // 扩展时间戳，未使用扩展时间戳时为 0
+            uint32_t ext_timestamp{0};
+
+            // 所有后续块（格式3）的头部，连续存放
+            std::vector<char> headers;
+
+            // 首块头部之后的全部发送片段：消息体块与后续块头部交替排列，指向数据包和 headers 的内存
+            std::vector<struct iovec> iovs;
+        };
+
+        // 定义智能指针类型 RtmpChunkLayoutPtr
+        using RtmpChunkLayoutPtr = std::shared_ptr<RtmpChunkLayout>;
+
+        // 每个流一个的分块缓存，同一个数据包只分块一次，所有播放者共享结果
+        // 缓存槽位与流的数据包缓冲区一一对应，按数据包索引取模定位
+        // 默认块大小、不带扩展时间戳的布局由推流端构建并随数据包发布，播放端无锁读取，
+        // 只有其他块大小或者扩展时间戳才经过缓存和锁
+        class RtmpChunkCache
+        {
+        public:
+            // 构造函数，slots 为槽位数量，应与流的数据包缓冲区大小一致
+            explicit RtmpChunkCache(size_t slots = 1000);
+
+            /*
+             * 获取数据包的分块布局，不存在则构建并缓存
+             * packet: 数据包，必须带有 RtmpMsgHeader 扩展头
+             * chunk_size: 连接的输出块大小
+             * ext_timestamp: 后续块需要携带的扩展时间戳，不需要时为 0
+             */
+            RtmpChunkLayoutPtr GetLayout(const PacketPtr &packet, int32_t chunk_size, uint32_t ext_timestamp);
+
+            // 不经过缓存，直接构建分块布局，布局不持有数据包
+            static RtmpChunkLayoutPtr BuildLayout(const PacketPtr &packet, int32_t chunk_size, uint32_t ext_timestamp);
+
+            // 析构函数
+            ~RtmpChunkCache() = default;
+
+        private:
+            // 缓存槽位，同一数据包可能因分块参数不同存在多个布局
+            std::vector<std::vector<RtmpChunkLayoutPtr>> slots_;
+
+            // 互斥锁，保护槽位
+            std::mutex lock_;
+        };
+
+        // 定义智能指针类型 RtmpChunkCachePtr
+        using RtmpChunkCachePtr = std::shared_ptr<RtmpChunkCache>;
+    }
+}
@@ -15,7 +15,7 @@ RtmpClient::RtmpClient(EventLoop *loop, RtmpHandler *handler)
 void RtmpClient::OnWriteComplete(const TcpConnectionPtr &conn)
 {
     // 从连接对象中获取上下文对象，类型为 RtmpContext，使用预定义的键 kRtmpContext 进行查找
-    auto context = conn->GetContext<RtmpContext>(kRtmpContext);
+    auto context = conn->Context<RtmpContext>(kRtmpContext);
 
     // 如果上下文对象存在，调用其 OnWriteComplete 方法，处理写操作完成的后续逻辑
     if (context)
@@ -54,7 +54,7 @@ void RtmpClient::OnConnection(const TcpConnectionPtr& conn, bool connected)
 void RtmpClient::OnMessage(const TcpConnectionPtr& conn, MsgBuffer &buf)
 {
     // 从连接对象中获取与该连接关联的上下文对象，类型为 RtmpContext，使用键 kRtmpContext 查找
-    auto context = conn->GetContext<RtmpContext>(kRtmpContext);
+    auto context = conn->Context<RtmpContext>(kRtmpContext);
 
     // 如果上下文对象存在，调用其 Parse 方法，传入接收到的数据缓冲区 buf，进行消息解析
     if (context)
@@ -26,8 +26,9 @@ RtmpContext::RtmpContext(const TcpConnectionPtr &conn, RtmpHandler *handler, boo
     // 绑定 "publish" 命令到 HandlePublish 函数
     commands_["publish"] = std::bind(&RtmpContext::HandlePublish, this, std::placeholders::_1);
 
-    // 初始化 out_current_ 指针，使其指向 out_buffer_ 的起始位置
-    out_current_ = out_buffer_;
+    // 预留发送数组的容量，之后按需增长，发送完成时只清空不释放
+    sending_iovs_.reserve(256);
+    out_sending_packets_.reserve(16);
 }
 
 int32_t RtmpContext::Parse(MsgBuffer &buff)
@@ -132,11 +133,14 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
     // 已解析的字节数
     int32_t parsed = 0;
 
-    // 获取当前缓冲区指针
+    // 累加新收到的字节数
     in_bytes_ += (buff.ReadableBytes() - last_left_);
 
-    // 计算缓冲区内可读字节数
-    SendBytesRecv();
+    // 只有越过确认窗口时才发送确认消息，其余时候只做一次比较
+    if (in_bytes_ >= ack_size_)
+    {
+        SendBytesRecv();
+    }
 
     // 当缓冲区内有足够的数据时进行解析
     while (total_bytes > 1)
@@ -206,14 +210,11 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
         // 定义新的时间戳
         int32_t ts = 0;
 
-        // 获取上一次的消息头部，使用 CSID 作为键
-        RtmpMsgHeaderPtr &prev = in_message_headers_[csid];
+        // 获取块流的接收状态，消息头、数据包、时间戳增量和扩展时间戳标志都在这里，只查找一次
+        RtmpInChunkStream &stream = InStream(csid);
 
-        if (!prev)
-        {
-            // 如果之前没有消息头部，创建一个新的
-            prev = std::make_shared<RtmpMsgHeader>();
-        }
+        // 上一次的消息头部
+        RtmpMsgHeader *prev = &stream.prev;
 
         // 获取当前消息的长度
         msg_len = prev->msg_len;
@@ -230,17 +231,17 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             msg_len = in_chunk_size_;
         }
 
-        // 从 in_packets_ 中获取对应 csid 的数据包
-        PacketPtr &packet = in_packets_[csid];
+        // 获取块流正在接收的数据包
+        PacketPtr &packet = stream.packet;
 
         // 如果该数据包尚不存在，创建一个新的数据包
         if (!packet)
         {
-            // 根据消息长度创建新的数据包
-            packet = Packet::NewPacket(msg_len);
+            // 根据消息长度创建由切片组成的数据包，消息体直接引用接收缓冲区，不再复制
+            packet = Packet::NewSlicedPacket(msg_len);
 
-            // 创建新的消息头
-            RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+            // 初始化数据包内嵌的消息头
+            RtmpMsgHeader *header = packet->InitHeader();
 
             // 设置 chunk stream ID
             header->cs_id = csid;
@@ -256,13 +257,10 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
 
             // 设置时间戳为 0
             header->timestamp = 0;
-
-            // 将消息头附加到数据包中 
-            packet->SetExt(header);          
         }
 
         // 获取数据包的消息头
-        RtmpMsgHeaderPtr header = packet->Ext<RtmpMsgHeader>();
+        RtmpMsgHeader *header = packet->Header();
 
         // 根据不同的 FMT 值，解析消息头部
         if (fmt == kRtmpFmt0)   // FMT0：完整消息头部
@@ -271,7 +269,7 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             ts = BytesReader::ReadUint24T(pos + parsed);
             parsed += 3;
             // 重置时间戳增量
-            in_deltas_[csid] = 0;
+            stream.delta = 0;
             // 当前时间戳
             header->timestamp = ts;
             // 读取 24 位的消息长度
@@ -290,7 +288,7 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             ts = BytesReader::ReadUint24T(pos + parsed);
             parsed += 3;
             // 保存时间戳增量
-            in_deltas_[csid] = ts;
+            stream.delta = ts;
             // 计算当前时间戳
             header->timestamp = ts + prev->timestamp;
             // 读取 24 位的消息长度
@@ -308,7 +306,7 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             ts = BytesReader::ReadUint24T(pos + parsed);
             parsed += 3;
             // 保存时间戳增量
-            in_deltas_[csid] = ts;
+            stream.delta = ts;
             // 计算当前时间戳
             header->timestamp = ts + prev->timestamp;
             // 使用之前的消息长度
@@ -323,7 +321,7 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             if (header->timestamp == 0)
             {
                 // 使用之前的时间戳增量计算当前时间戳
-                header->timestamp = in_deltas_[csid] + prev->timestamp;
+                header->timestamp = stream.delta + prev->timestamp;
             }
             // 使用之前的消息长度
             header->msg_len = prev->msg_len;
@@ -338,11 +336,11 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
 
         if (fmt == kRtmpFmt3)   // FMT3 使用之前保存的扩展时间戳标志
         {
-            ext = in_ext_[csid];
+            ext = stream.ext;
         }
 
         // 更新扩展时间戳标志
-        in_ext_[csid] = ext;
+        stream.ext = ext;
 
         // 如果使用扩展时间戳
         if (ext)
@@ -364,7 +362,7 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
                 // 更新当前时间戳
                 header->timestamp = ts + prev->timestamp;
                 // 保存当前时间戳增量
-                in_deltas_[csid] = ts;
+                stream.delta = ts;
             }
         }
 
@@ -403,16 +401,21 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
         // 如果剩余数据不足以填充数据包
         if (total_bytes - parsed < bytes)
         {
+            // 大消息还没有到齐，提示连接按消息剩余的长度预留接收空间，剩余的块直接读入同一个存储块，再由切片引用
+            // 不预留时超出可写空间的数据先读到栈上的临时缓冲区，再复制回接收缓冲区
+            size_t left = packet->Space() + (packet->Space() / in_chunk_size_) * kRtmpMaxChunkHeader;
+            size_t buffered = total_bytes - parsed;
+            if (left > buffered)
+            {
+                connection_->SetReadHint(std::min(left - buffered, (size_t)kRtmpMaxReadHint));
+            }
+
             // 返回 1 表示需要更多数据
             return 1;
         }
 
-        // 获取当前数据包的写入位置
-        const char * body = packet->Data() + packet->PacketSize();
-        // 将数据从缓冲区复制到数据包中
-        memcpy((void*)body, pos + parsed, bytes);
-        // 更新数据包的大小
-        packet->UpdatePacketSize(bytes);
+        // 引用缓冲区中的块数据作为数据包的一个切片，同时更新数据包的大小
+        packet->AppendSlice(buff.Slice(parsed, bytes));
         // 更新解析的字节数
         parsed += bytes;
         
@@ -439,6 +442,12 @@ int32_t RtmpContext::ParseMessage(MsgBuffer &buff)
             packet->SetPacketType(header->msg_type);
             // 设置数据包的时间戳
             packet->SetTimeStamp(header->timestamp);
+            // 音视频以外的消息体积小，并且处理时需要连续的数据，在这里合并切片
+            // 音视频数据包保持切片，发送时按切片分块，不再调用 Data() 修改共享的数据包
+            if (header->msg_type != kRtmpMsgTypeAudio && header->msg_type != kRtmpMsgTypeVideo)
+            {
+                packet->Data();
+            }
             // 调用 MessageComplete 函数处理完整的消息
             MessageComplete(std::move(packet));
             // 重置数据包指针
@@ -573,17 +582,15 @@ void RtmpContext::MessageComplete(PacketPtr && data)
 bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool fmt0)
 {
     // 获取数据包的消息头
-    RtmpMsgHeaderPtr h = packet->Ext<RtmpMsgHeader>();
+    const RtmpMsgHeader *h = packet->Header();
 
     // 如果消息头存在，开始构建块
     if (h)
     {
-        out_sending_packets_.emplace_back(packet);
-
         // 获取该 CSID 上次发送的消息头
         RtmpMsgHeaderPtr &prev = out_message_headers_[h->cs_id];
         // 判断是否可以使用时间戳增量，减少数据冗余
-        bool use_delta = !fmt0 && !prev && timestamp >= prev->timestamp && h->msg_sid == prev->msg_sid;
+        bool use_delta = !fmt0 && prev && timestamp >= prev->timestamp && h->msg_sid == prev->msg_sid;
 
         // 如果没有上次的消息头，则创建一个新的
         if (!prev)
@@ -615,8 +622,9 @@ bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool f
             }
         }
 
-        // 设置输出缓冲区当前指针
-        char *p = out_current_;
+        // 在头部内存区中预留首块头部的最大长度
+        char *start = out_headers_.Reserve(kRtmpMaxFirstChunkHeader);
+        char *p = start;
 
         // 构建基本头部，根据 CSID 来决定如何编码
         if (h->cs_id < 64)
@@ -685,9 +693,8 @@ bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool f
         }    
 
         // 将构建好的消息头部数据保存到发送缓冲区
-        BufferNodePtr nheader = std::make_shared<BufferNode>(out_current_, p - out_current_);
-        sending_bufs_.emplace_back(std::move(nheader));
-        out_current_ = p;
+        sending_iovs_.push_back({start, (size_t)(p - start)});
+        out_headers_.Commit(p - start);
 
         // 更新上次的消息头信息
         prev->cs_id = h->cs_id;
@@ -704,10 +711,38 @@ bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool f
         {
             prev->timestamp += timestamp;
         }
+
+        // 推流端按默认块大小预先构建的布局随数据包发布，直接读取，不经过分块缓存的锁
+        // 布局由数据包持有，数据包保存到 out_sending_packets_，发送完成前保持有效
+        const RtmpChunkLayout *shared = packet->OutLayout<RtmpChunkLayout>();
+        if (shared && ts != 0xFFFFFF && shared->chunk_size == out_chunk_size_ && shared->cs_id == h->cs_id)
+        {
+            sending_iovs_.insert(sending_iovs_.end(), shared->iovs.begin(), shared->iovs.end());
+            out_sending_packets_.emplace_back(packet);
+
+            return true;
+        }
+
+        // 其他块大小或者扩展时间戳，经过共享分块缓存，后续块直接复用缓存中的节点
+        if (chunk_cache_)
+        {
+            // 获取分块布局，扩展时间戳与首块头部保持一致
+            auto layout = chunk_cache_->GetLayout(packet, out_chunk_size_, ts == 0xFFFFFF ? timestamp : 0);
+
+            if (layout)
+            {
+                // 追加消息体块和后续块头部
+                sending_iovs_.insert(sending_iovs_.end(), layout->iovs.begin(), layout->iovs.end());
+                // 布局持有数据包，发送完成前保持有效
+                out_sending_layouts_.emplace_back(std::move(layout));
+
+                return true;
+            }
+        }
+
+        out_sending_packets_.emplace_back(packet);
         
         // 处理消息体部分，将数据分块并添加到发送队列中
-        // 指向消息体数据的起始位置
-        const char *body = packet->Data();
         // 用于跟踪已经处理的数据字节数
         int32_t bytes_parsed = 0;
 
@@ -715,31 +750,23 @@ bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool f
         while (true)
         {
             // 计算每次发送的数据块大小
-            // 指向当前要处理的消息体数据的开始位置
-            const char *chunk = body + bytes_parsed;
             // 表示当前块的大小，等于剩余消息体长度和设定的最大块大小（out_chunk_size_）之间的较小值
             int32_t size = h->msg_len - bytes_parsed;
             size = std::min(size, out_chunk_size_);
 
-            // 创建一个新的 BufferNode 对象，将当前块数据封装进去，并添加到 sending_bufs_ 缓冲区队列中
-            BufferNodePtr node = std::make_shared<BufferNode>((void*)chunk, size);
-            sending_bufs_.emplace_back(std::move(node));
+            // 当前块可能跨越数据包的多个切片，每个切片添加一个 iovec，切片的数据块由 out_sending_packets_ 中的数据包保持有效
+            packet->ForEachSlice(bytes_parsed, size, [this](const BufferSlice &slice){
+                sending_iovs_.push_back({(void*)slice.data, slice.size});
+            });
             // 更新 bytes_parsed，以记录已经处理的数据量
             bytes_parsed += size;
 
             // 如果数据还未发送完，继续处理
             if (bytes_parsed < h->msg_len)
             {
-                // 如果缓冲区不够用，输出错误信息并停止处理
-                if (out_current_ - out_buffer_ >= 4096)
-                {
-                    RTMP_ERROR << " rtmp had no enough out header buffer.";
-
-                    break;
-                }
-
-                // 构建后续的数据块头部
-                char *p = out_current_;
+                // 构建后续的数据块头部，头部内存区不够时自动增长，不会截断消息
+                char *chunk_start = out_headers_.Reserve(kRtmpMaxChunkHeader);
+                char *p = chunk_start;
 
                 // 对于不同的 cs_id 范围，分别使用不同的方式构建头部
                 // 如果 Chunk Stream ID (cs_id) 小于 64
@@ -776,10 +803,9 @@ bool RtmpContext::BuildChunk(const PacketPtr &packet, uint32_t timestamp, bool f
                     p += 4;
                 } 
 
-                // 构建完头部后，将其保存到发送缓冲区，并更新 out_current_ 指针
-                BufferNodePtr nheader = std::make_shared<BufferNode>(out_current_, p - out_current_);
-                sending_bufs_.emplace_back(std::move(nheader));
-                out_current_ = p;      
+                // 构建完头部后，将其保存到发送数组，并提交写入的长度
+                sending_iovs_.push_back({chunk_start, (size_t)(p - chunk_start)});
+                out_headers_.Commit(p - chunk_start);
             }
             else 
             {
@@ -830,7 +856,7 @@ void RtmpContext::Send()
     }
 
     // 将准备好的数据块通过连接发送出去
-    connection_->Send(sending_bufs_);
+    connection_->Send(sending_iovs_.data(), sending_iovs_.size());
 }
 
 bool RtmpContext::Ready() const
@@ -839,10 +865,16 @@ bool RtmpContext::Ready() const
     return !sending_;
 }
 
+void RtmpContext::SetChunkCache(const RtmpChunkCachePtr &cache)
+{
+    // 保存共享的分块缓存
+    chunk_cache_ = cache;
+}
+
 bool RtmpContext::BuildChunk (PacketPtr &&packet, uint32_t timestamp, bool fmt0)
 {
     // 获取数据包中的 RTMP 消息头
-    RtmpMsgHeaderPtr h = packet->Ext<RtmpMsgHeader>();
+    const RtmpMsgHeader *h = packet->Header();
 
     // 如果消息头存在
     if (h)
@@ -883,8 +915,9 @@ bool RtmpContext::BuildChunk (PacketPtr &&packet, uint32_t timestamp, bool fmt0)
             }
         }
 
-        // 指向当前缓冲区位置的指针
-        char *p = out_current_;
+        // 在头部内存区中预留首块头部的最大长度
+        char *start = out_headers_.Reserve(kRtmpMaxFirstChunkHeader);
+        char *p = start;
 
         // 如果 chunk stream ID 小于 64，直接使用单字节表示
         if (h->cs_id < 64)
@@ -959,9 +992,8 @@ bool RtmpContext::BuildChunk (PacketPtr &&packet, uint32_t timestamp, bool fmt0)
         }    
 
         // 创建并保存数据块头部
-        BufferNodePtr nheader = std::make_shared<BufferNode>(out_current_, p - out_current_);
-        sending_bufs_.emplace_back(std::move(nheader));
-        out_current_ = p;
+        sending_iovs_.push_back({start, (size_t)(p - start)});
+        out_headers_.Commit(p - start);
 
         // 更新之前的消息头信息
         prev->cs_id = h->cs_id;
@@ -980,39 +1012,28 @@ bool RtmpContext::BuildChunk (PacketPtr &&packet, uint32_t timestamp, bool fmt0)
         }
         
         // 处理消息体，将其分块并添加到发送缓冲区
-        const char *body = packet->Data();
         int32_t bytes_parsed = 0;
 
         while(true)
         {
-            // 获取当前数据块
-            const char * chunk = body + bytes_parsed;
             // 计算剩余的消息体长度
             int32_t size = h->msg_len - bytes_parsed;
             // 计算本次发送的数据块大小
             size = std::min(size, out_chunk_size_);
 
-            // 创建数据块节点
-            BufferNodePtr node = std::make_shared<BufferNode>((void*)chunk, size);
-            // 添加到发送缓冲区
-            sending_bufs_.emplace_back(std::move(node));
+            // 按切片添加 iovec 到发送数组
+            packet->ForEachSlice(bytes_parsed, size, [this](const BufferSlice &slice){
+                sending_iovs_.push_back({(void*)slice.data, slice.size});
+            });
             // 更新已解析的字节数
             bytes_parsed += size;
 
             // 如果还有数据未发送完
             if (bytes_parsed < h->msg_len)
             {
-                // 检查缓冲区是否足够
-                if (out_current_ - out_buffer_ >= 4096)
-                {
-                    // 缓冲区不足时输出错误信息
-                    RTMP_ERROR << " rtmp had no enough out header buffer.";
-
-                    break;
-                }
-
-                // 获取当前缓冲区指针
-                char *p = out_current_;
+                // 在头部内存区中预留后续块头部的最大长度，不够时自动增长
+                char *chunk_start = out_headers_.Reserve(kRtmpMaxChunkHeader);
+                char *p = chunk_start;
 
                 // 对于不同的 cs_id 范围，分别使用不同的方式构建头部
                 // 如果 Chunk Stream ID (cs_id) 小于 64
@@ -1050,10 +1071,9 @@ bool RtmpContext::BuildChunk (PacketPtr &&packet, uint32_t timestamp, bool fmt0)
                 }      
 
                 // 创建并保存后续数据块头部
-                BufferNodePtr nheader = std::make_shared<BufferNode>(out_current_, p - out_current_);
-                sending_bufs_.emplace_back(std::move(nheader));
-                // 更新缓冲区指针
-                out_current_ = p;      
+                sending_iovs_.push_back({chunk_start, (size_t)(p - chunk_start)});
+                // 提交写入的长度
+                out_headers_.Commit(p - chunk_start);
             }
             else 
             {
@@ -1077,12 +1097,14 @@ void RtmpContext::CheckAndSend()
 {
     // 将发送标志设置为 false，表示当前不再发送数据
     sending_ = false;
-    // 重置当前缓冲区指针到缓冲区的起始位置
-    out_current_ = out_buffer_;
+    // 发送完成，回收头部内存区，增长过的内存块合并后留给下一批
+    out_headers_.Reset();
     // 清空正在发送的缓冲区
-    sending_bufs_.clear();
+    sending_iovs_.clear();
     // 清空正在发送的数据包列表
     out_sending_packets_.clear();
+    // 清空正在发送的分块布局
+    out_sending_layouts_.clear();
 
     // 如果等待发送队列不为空
     if (!out_waiting_queue_.empty())
@@ -1115,8 +1137,8 @@ void RtmpContext::SendSetChunkSize()
     // 创建一个新的数据包，初始大小为 64 字节
     PacketPtr packet = Packet::NewPacket(64);
 
-    // 创建一个 RTMP 消息头的共享指针
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的 RTMP 消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 如果消息头创建成功
     if (header)
@@ -1126,7 +1148,6 @@ void RtmpContext::SendSetChunkSize()
         header->msg_type = kRtmpMsgTypeChunkSize;   // 设置消息类型为设置 Chunk Size 类型
         header->timestamp = 0;                      // 设置时间戳为 0
         header->msg_sid = kRtmpMsID0;               // 设置消息 Stream ID 为 0，表示系统控制消息
-        packet->SetExt(header);                     // 将消息头附加到数据包中
     }
 
     // 获取数据包的指针
@@ -1150,8 +1171,8 @@ void RtmpContext::SendAckWindowSize()
     // 创建一个新的数据包，初始大小为 64 字节
     PacketPtr packet = Packet::NewPacket(64);
 
-    // 创建一个 RTMP 消息头的共享指针
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的 RTMP 消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 如果消息头创建成功
     if (header)
@@ -1161,7 +1182,6 @@ void RtmpContext::SendAckWindowSize()
         header->msg_type = kRtmpMsgTypeWindowACKSize;   // 设置消息类型为窗口确认大小
         header->timestamp = 0;                          // 设置时间戳为 0
         header->msg_sid = kRtmpMsID0;                   // 设置消息 Stream ID 为 0，表示系统控制消息
-        packet->SetExt(header);                         // 将消息头附加到数据包中
     }
 
     // 获取数据包的指针，用于写入数据
@@ -1185,8 +1205,8 @@ void RtmpContext::SendSetPeerBandwidth()
     // 创建一个新的数据包，初始大小为 64 字节
     PacketPtr packet = Packet::NewPacket(64);
 
-    // 创建一个 RTMP 消息头的共享指针
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的 RTMP 消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     if (header)  // 如果消息头创建成功
     {
@@ -1195,7 +1215,6 @@ void RtmpContext::SendSetPeerBandwidth()
         header->msg_type = kRtmpMsgTypeSetPeerBW;  // 设置消息类型为 Set Peer Bandwidth
         header->timestamp = 0;  // 设置时间戳为 0
         header->msg_sid = kRtmpMsID0;  // 设置消息 Stream ID 为 0，表示系统控制消息
-        packet->SetExt(header);  // 将消息头附加到数据包中
     }
 
     // 获取数据包的指针，用于写入数据
@@ -1227,8 +1246,8 @@ void RtmpContext::SendBytesRecv()
         // 创建一个新的数据包，初始大小为 64 字节
         PacketPtr packet = Packet::NewPacket(64);
 
-        // 创建一个 RTMP 消息头的共享指针
-        RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+        // 初始化数据包内嵌的 RTMP 消息头
+        RtmpMsgHeader *header = packet->InitHeader();
 
         // 如果消息头创建成功
         if (header)
@@ -1238,7 +1257,6 @@ void RtmpContext::SendBytesRecv()
             header->msg_type = kRtmpMsgTypeBytesRead;  // 设置消息类型为 Bytes Received (BytesRead) 消息
             header->timestamp = 0;  // 设置时间戳为 0
             header->msg_sid = kRtmpMsID0;  // 设置消息 Stream ID 为 0，表示系统控制消息
-            packet->SetExt(header);  // 将消息头附加到数据包中
         }
 
         // 获取数据包的指针，用于写入数据
@@ -1265,8 +1283,8 @@ void RtmpContext::SendUserCtrlMessage(short nType, uint32_t value1, uint32_t val
     // 创建一个新的数据包，初始大小为 64 字节
     PacketPtr packet = Packet::NewPacket(64);
     
-    // 创建一个 RTMP 消息头的共享指针
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的 RTMP 消息头
+    RtmpMsgHeader *header = packet->InitHeader();
     
     // 如果消息头创建成功
     if (header)
@@ -1276,7 +1294,6 @@ void RtmpContext::SendUserCtrlMessage(short nType, uint32_t value1, uint32_t val
         header->msg_type = kRtmpMsgTypeUserControl;  // 设置消息类型为 User Control Message
         header->timestamp = 0;  // 设置时间戳为 0
         header->msg_sid = kRtmpMsID0;  // 设置消息 Stream ID 为 0，表示系统控制消息
-        packet->SetExt(header);  // 将消息头附加到数据包中
     }
 
     // 获取数据包的指针，用于写入数据
@@ -1496,8 +1513,8 @@ void RtmpContext::SendConnect()
     // 创建一个新的Packet，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;
@@ -1511,9 +1528,6 @@ void RtmpContext::SendConnect()
     // 设置消息类型为AMF消息
     header->msg_type = kRtmpMsgTypeAMFMessage;
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -1603,8 +1617,8 @@ void RtmpContext::HandleConnect(AMFObject &obj)
     // 创建一个新的Packet，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;  
@@ -1618,9 +1632,6 @@ void RtmpContext::HandleConnect(AMFObject &obj)
     // 设置消息类型为AMF消息                  
     header->msg_type = kRtmpMsgTypeAMFMessage; 
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);                 
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -1683,8 +1694,8 @@ void RtmpContext::SendCreateStream()
     // 创建一个新的Packet，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;
@@ -1698,9 +1709,6 @@ void RtmpContext::SendCreateStream()
     // 设置消息类型为AMF消息
     header->msg_type = kRtmpMsgTypeAMFMessage; 
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -1735,8 +1743,8 @@ void RtmpContext::HandleCreateStream(AMFObject &obj)
     // 创建一个新的Packet，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;
@@ -1750,9 +1758,6 @@ void RtmpContext::HandleCreateStream(AMFObject &obj)
     // 设置消息类型为AMF消息
     header->msg_type = kRtmpMsgTypeAMFMessage;
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -1787,8 +1792,8 @@ void RtmpContext::SendStatus(const std::string &level, const std::string &code,
     // 创建一个新的Packet对象，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;
@@ -1802,9 +1807,6 @@ void RtmpContext::SendStatus(const std::string &level, const std::string &code,
     // 设置消息类型为AMF消息
     header->msg_type = kRtmpMsgTypeAMFMessage;
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -1853,8 +1855,8 @@ void RtmpContext::SendPlay()
     // 创建一个新的Packet对象，大小为1024字节
     PacketPtr packet = Packet::NewPacket(1024);
 
-    // 创建一个新的RTMP消息头对象，并初始化头部信息
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    // 初始化数据包内嵌的RTMP消息头
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置Chunk Stream ID为AMF初始化流的ID
     header->cs_id = kRtmpCSIDAMFIni;
@@ -1868,9 +1870,6 @@ void RtmpContext::SendPlay()
     // 设置消息类型为AMF消息
     header->msg_type = kRtmpMsgTypeAMFMessage;
 
-    // 将消息头部设置到Packet中
-    packet->SetExt(header);
-
     // 获取Packet的Data指针，指向消息体的开始位置
     char *body = packet->Data();
     char *p = body;
@@ -2006,7 +2005,7 @@ void RtmpContext::SendPublish()
     PacketPtr packet = Packet::NewPacket(1024);
 
     // 创建一个新的RTMP消息头对象
-    RtmpMsgHeaderPtr header = std::make_shared<RtmpMsgHeader>();
+    RtmpMsgHeader *header = packet->InitHeader();
 
     // 设置消息头的各个字段
     header->cs_id = kRtmpCSIDAMFIni; // 设置控制消息的CSID为AMF初始化
@@ -2014,9 +2013,6 @@ void RtmpContext::SendPublish()
     header->msg_len = 0;             // 初始消息长度为0
     header->msg_type = kRtmpMsgTypeAMFMessage; // 设置消息类型为AMF消息
 
-    // 将消息头附加到数据包中
-    packet->SetExt(header);
-
     // 获取数据包的内容区域
     char *body = packet->Data();
     char *p = body;
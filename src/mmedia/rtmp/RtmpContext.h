@@ -1,10 +1,13 @@
 #pragma once
 #include <cstdint>
 #include <unordered_map>
+#include <vector>
 #include "network/net/TcpConnection.h"
 #include "RtmpHandShake.h"
 #include "RtmpHandler.h"
 #include "RtmpHeader.h"
+#include "RtmpChunkCache.h"
+#include "RtmpHeaderArena.h"
 #include "mmedia/base/Packet.h"
 #include "mmedia/rtmp/amf/AMFObject.h"
 
@@ -38,6 +41,25 @@ namespace lss
         // 定义了 RTMP 协议中与用户控制消息相关的命令回调的别名
         using CommandFunc = std::function<void (AMFObject &obj)>;
 
+        // 块流 ID 小于该值的接收状态保存在数组中，按下标访问
+        #define kRtmpInlineChunkStreams 64
+
+        // 一个块流（Chunk Stream）的接收状态，解析一个块只需要查找一次
+        struct RtmpInChunkStream
+        {
+            // 上一个块的消息头，fmt1~fmt3 省略的字段从这里继承
+            RtmpMsgHeader prev;
+
+            // 正在接收的消息，收齐后交给上层处理
+            PacketPtr packet;
+
+            // 时间戳增量
+            uint32_t delta{0};
+
+            // 是否使用扩展时间戳
+            bool ext{false};
+        };
+
         class RtmpContext
         {
         public:
@@ -70,6 +92,9 @@ namespace lss
             // 判断当前是否准备好发送数据
             bool Ready() const;
 
+            // 设置共享的分块缓存，设置后 BuildChunk 直接复用缓存中的后续块
+            void SetChunkCache(const RtmpChunkCachePtr &cache);
+
             // 拉流函数，用于拉取指定的流
             void Play(const std::string &url);
 
@@ -179,27 +204,28 @@ namespace lss
             // RTMP 处理器指针 rtmp_handler_，用于处理 RTMP 相关的业务逻辑
             RtmpHandler *rtmp_handler_{nullptr};
 
-            // 无序映射表，用于存储接收到的消息头部，键为消息 ID，值为消息头指针
-            std::unordered_map<uint32_t, RtmpMsgHeaderPtr> in_message_headers_;
-
-            // 无序映射表，用于存储接收到的数据包，键为消息 ID，值为数据包指针
-            std::unordered_map<uint32_t, PacketPtr> in_packets_;
+            // 获取块流的接收状态，编码器实际只使用 2~8 号块流，小于 64 的直接访问数组
+            inline RtmpInChunkStream &InStream(uint32_t csid)
+            {
+                if (csid < kRtmpInlineChunkStreams)
+                {
+                    return in_streams_[csid];
+                }
+                return in_streams_ext_[csid];
+            }
 
-            // 无序映射表，用于存储时间戳增量信息，键为消息 ID，值为增量值
-            std::unordered_map<uint32_t, uint32_t> in_deltas_;
+            // 块流 ID 小于 64 的接收状态，按块流 ID 下标访问
+            RtmpInChunkStream in_streams_[kRtmpInlineChunkStreams];
 
-            // 无序映射表，用于标记是否使用扩展时间戳，键为消息 ID，值为布尔值
-            std::unordered_map<uint32_t, bool> in_ext_;
+            // 块流 ID 大于等于 64 的接收状态，键为块流 ID，元素的地址在插入其他元素后不变
+            std::unordered_map<uint32_t, RtmpInChunkStream> in_streams_ext_;
 
             // 输入块大小 in_chunk_size_，初始值为 128，表示解析时的块大小
             int32_t in_chunk_size_{128};
 
             // ------------------------------- 数据发送部分 -------------------------------
-            // 用于临时存储发送的数据块的缓冲区，大小为 4096 字节
-            char out_buffer_[4096];
-
-            // 指向缓冲区当前写入位置的指针
-            char *out_current_{nullptr};
+            // 存放发送的块头部的内存区，一批数据发送完成前地址不变，放不下时自动增长
+            RtmpHeaderArena out_headers_;
 
             // 用于存储不同 Chunk Stream ID (CSID) 的时间戳增量
             std::unordered_map<uint32_t, uint32_t> out_deltas_;
@@ -208,20 +234,27 @@ namespace lss
             std::unordered_map<uint32_t, RtmpMsgHeaderPtr> out_message_headers_;
 
             // 发送时使用的块大小，默认为 4096 字节
-            int32_t out_chunk_size_{4096};
+            int32_t out_chunk_size_{kRtmpOutChunkSize};
 
             // 用于存储等待发送的数据包队列
             std::list<PacketPtr> out_waiting_queue_;
 
-            // 用于存储正在发送的数据块列表
-            std::list<BufferNodePtr> sending_bufs_;
+            // 正在发送的数据块，直接以 iovec 描述，交给连接时只复制 iovec
+            // 发送完成后清空但保留容量，稳定之后构建分块不再分配内存
+            std::vector<struct iovec> sending_iovs_;
 
-            // 用于存储正在发送的数据包队列
-            std::list<PacketPtr> out_sending_packets_;
+            // 正在发送的数据包，保证消息体在发送完成前有效
+            std::vector<PacketPtr> out_sending_packets_;
 
             // 表示当前是否正在发送数据的标志位
             bool sending_{false};
 
+            // 共享的分块缓存，由所属的流持有
+            RtmpChunkCachePtr chunk_cache_;
+
+            // 正在发送的分块布局，保证共享的 iovec 在发送完成前有效
+            std::vector<RtmpChunkLayoutPtr> out_sending_layouts_;
+
             // ------------------------------- Rtmp协议控制消息和用户控制消息 -------------------------------
             // 确认窗口大小，单位是字节，默认值为2500000字节（约2.5MB）
             int32_t ack_size_{2500000};
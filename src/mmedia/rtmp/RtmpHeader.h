@@ -1,6 +1,7 @@
 #pragma once 
 #include <cstdint>
 #include <memory>
+#include "mmedia/base/Packet.h"
 
 namespace lss
 {
@@ -45,32 +46,13 @@ namespace lss
         #define kRtmpMsID0 0            // 定义消息流ID 0
         #define kRtmpMsID1 1            // 定义消息流ID 1
 
-        #pragma pack(push)              // 保存当前的内存对齐
-        #pragma pack(1)                 // 设置内存对齐为1字节
+        #define kRtmpMaxChunkHeader 7       // 后续块头部的最大长度：3 字节基本头加 4 字节扩展时间戳
+        #define kRtmpMaxFirstChunkHeader 18 // 首块头部的最大长度：3 字节基本头、11 字节消息头加 4 字节扩展时间戳
+        #define kRtmpOutChunkSize 4096      // 服务端发送时使用的块大小，推流端按这个大小预先分块
+        #define kRtmpMaxReadHint (1 << 20)  // 每次提示连接预留的接收空间上限，避免恶意的消息长度导致过大的分配
 
-            // 定义RTMP消息头结构
-            struct RtmpMsgHeader
-            {
-                uint32_t cs_id{0};      // 标识消息所属的通道
-                uint32_t timestamp{0};  // 时间戳（增量）
-                uint32_t msg_len{0};    // 消息长度
-                uint8_t  msg_type{0};   // 消息类型ID
-                uint32_t msg_sid{0};    // 消息流ID
-
-                // 构造函数
-                RtmpMsgHeader()
-                    : cs_id(0)
-                    , timestamp(0)
-                    , msg_len(0)
-                    , msg_type(0)
-                    , msg_sid(0)
-                {
-
-                }
-            };
-
-        // 恢复内存对齐到默认状态
-        #pragma pack()
+        // RTMP 消息头，内嵌在数据包中，见 Packet::Header()
+        using RtmpMsgHeader = PacketHeader;
 
         // 定义RtmpMsgHeader的智能指针类型
         using RtmpMsgHeaderPtr = std::shared_ptr<RtmpMsgHeader>;
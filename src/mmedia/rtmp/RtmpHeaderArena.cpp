@@ -0,0 +1,58 @@
+#include <algorithm>
+#include "RtmpHeaderArena.h"
+
+using namespace lss::mm;
+
+RtmpHeaderArena::RtmpHeaderArena(size_t block_size, size_t max_retained)
+    : block_size_(block_size > 0 ? block_size : 4096)
+    , max_retained_(std::max(max_retained, block_size_))
+{
+    AddBlock(block_size_);
+    UseBlock(0);
+}
+
+void RtmpHeaderArena::Reset()
+{
+    // 只用了一个内存块，直接从头开始
+    if (blocks_.size() > 1)
+    {
+        // 合并成一个内存块，大小等于这次用到的总大小，超过上限时按上限保留
+        size_t size = std::min(capacity_, max_retained_);
+        blocks_.clear();
+        capacity_ = 0;
+        AddBlock(size);
+    }
+
+    used_ = 0;
+    UseBlock(0);
+}
+
+void RtmpHeaderArena::NextBlock(size_t len)
+{
+    // 后面已有足够大的内存块时直接使用，内存块中剩余的空间放弃
+    if (index_ + 1 < blocks_.size() && blocks_[index_ + 1].size >= len)
+    {
+        UseBlock(index_ + 1);
+        return;
+    }
+
+    // 新的内存块大小翻倍，一次大批量发送只需要分配少量几次
+    AddBlock(std::max(len, blocks_.back().size * 2));
+    UseBlock(blocks_.size() - 1);
+}
+
+void RtmpHeaderArena::UseBlock(size_t index)
+{
+    index_ = index;
+    current_ = blocks_[index].data.get();
+    end_ = current_ + blocks_[index].size;
+}
+
+void RtmpHeaderArena::AddBlock(size_t size)
+{
+    Block block;
+    block.data.reset(new char[size]);
+    block.size = size;
+    blocks_.emplace_back(std::move(block));
+    capacity_ += size;
+}
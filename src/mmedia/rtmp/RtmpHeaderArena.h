@@ -0,0 +1,101 @@
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace lss
+{
+    namespace mm
+    {
+        // 发送时存放块头部的内存区，由若干内存块组成
+        // 写入的头部在 Reset 之前地址不变，可以直接作为 iovec 交给连接发送；空间不够时追加新的内存块，不移动已有数据
+        // 一次发送完成后 Reset 回收全部空间，用过多个内存块时合并成一个，之后同样大小的批量发送不再分配内存
+        class RtmpHeaderArena
+        {
+        public:
+            /*
+             * 构造函数
+             * block_size: 第一个内存块的大小
+             * max_retained: Reset 之后最多保留的字节数，偶尔一次的大批量发送之后不长期占用内存
+             */
+            explicit RtmpHeaderArena(size_t block_size = 4096, size_t max_retained = 256 * 1024);
+
+            // 返回至少 len 字节连续空间的写入位置，写入后调用 Commit 提交实际写入的长度
+            inline char *Reserve(size_t len)
+            {
+                if (current_ + len > end_)
+                {
+                    NextBlock(len);
+                }
+                return current_;
+            }
+
+            // 提交写入的 len 字节，len 不能超过 Reserve 的长度
+            inline void Commit(size_t len)
+            {
+                current_ += len;
+                used_ += len;
+            }
+
+            // 回收全部空间，之前写入的头部不再有效，只能在发送完成之后调用
+            void Reset();
+
+            // 已经写入的字节数
+            size_t Used() const
+            {
+                return used_;
+            }
+
+            // 所有内存块的总大小
+            size_t Capacity() const
+            {
+                return capacity_;
+            }
+
+            // 内存块的数量
+            size_t Blocks() const
+            {
+                return blocks_.size();
+            }
+
+        private:
+            // 一个内存块
+            struct Block
+            {
+                std::unique_ptr<char[]> data;
+                size_t size{0};
+            };
+
+            // 切换到下一个至少有 len 字节的内存块，没有时分配一个新的
+            void NextBlock(size_t len);
+
+            // 使用第 index 个内存块
+            void UseBlock(size_t index);
+
+            // 分配一个 size 字节的内存块，追加到末尾
+            void AddBlock(size_t size);
+
+            // 内存块，按使用顺序排列
+            std::vector<Block> blocks_;
+
+            // 正在使用的内存块
+            size_t index_{0};
+
+            // 当前的写入位置和所在内存块的末尾
+            char *current_{nullptr};
+            char *end_{nullptr};
+
+            // 已经写入的字节数
+            size_t used_{0};
+
+            // 所有内存块的总大小
+            size_t capacity_{0};
+
+            // 第一个内存块的大小
+            size_t block_size_{0};
+
+            // Reset 之后最多保留的字节数
+            size_t max_retained_{0};
+        };
+    }
+}
@@ -83,8 +83,8 @@ void RtmpServer::OnMessage(const TcpConnectionPtr &conn, MsgBuffer &buff)
     // 从连接的上下文中获取 RtmpHandShake 对象
     // RtmpHandShakePtr shake = conn->GetContext<RtmpHandShake>(kRtmpContext);
 
-    // 从连接的上下文中获取 RtmpContext 对象
-    RtmpContextPtr shake = conn->GetContext<RtmpContext>(kRtmpContext);
+    // 从连接的上下文槽位中获取 RtmpContext 对象，解析过程中关闭连接时上下文推迟析构，裸指针在本次回调中有效
+    RtmpContext *shake = conn->Context<RtmpContext>(kRtmpContext);
 
     // 如果握手对象存在，继续处理握手消息
     if (shake)
@@ -113,8 +113,8 @@ void RtmpServer::OnWriteComplete(const ConnectionPtr &conn)
     // 从连接的上下文中获取 RtmpHandShake 对象
     // RtmpHandShakePtr shake = conn->GetContext<RtmpHandShake>(kRtmpContext);
 
-    // 从连接的上下文中获取 RtmpContext 对象
-    RtmpContextPtr shake = conn->GetContext<RtmpContext>(kRtmpContext);
+    // 从连接的上下文槽位中获取 RtmpContext 对象
+    RtmpContext *shake = conn->Context<RtmpContext>(kRtmpContext);
 
     // 如果握手对象存在，调用 WriteComplete 方法处理写完成逻辑
     if (shake)
@@ -0,0 +1,263 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "network/base/MsgBuffer.h"
+#include "mmedia/base/Packet.h"
+
+using namespace lss::network;
+using namespace lss::mm;
+
+// 长度为 len 的测试数据，内容由 seed 决定
+std::string Pattern(size_t len, int seed)
+{
+    std::string s(len, 0);
+    for (size_t i = 0; i < len; i++)
+    {
+        s[i] = (char)(seed * 31 + i * 7);
+    }
+    return s;
+}
+
+// 切片的内容是否与 expect 相同
+bool Same(const BufferSlice &slice, const std::string &expect)
+{
+    return slice.size == expect.size() && memcmp(slice.data, expect.data(), expect.size()) == 0;
+}
+
+// 缓冲区当前使用的内存块
+const void *Block(const MsgBuffer &buf)
+{
+    return buf.Slice(0, 0).block.get();
+}
+
+// 取出切片之后继续 Retrieve 和 Append，直到缓冲区换了内存块，切片的内容始终不变
+// 被共享的内存块换成同样大小的新块，已经交出去的空间不会被搬移或复用
+bool TestAppend()
+{
+    MsgBuffer buf(1024);
+    std::string first = Pattern(300, 1);
+    buf.Append(first);
+    BufferSlice slice = buf.Slice(0, first.size());
+    const void *old = Block(buf);
+    size_t old_size = std::static_pointer_cast<std::vector<char>>(slice.block)->size();
+
+    bool ok = true;
+    int seed = 2;
+    // 不共享时 Retrieve 之后的空间会被搬移复用，共享时只能追加在后面，最多追加 1000 次
+    while (Block(buf) == old && seed < 1000)
+    {
+        buf.Retrieve(buf.ReadableBytes() / 2 + 1);
+        buf.Append(Pattern(100, seed++));
+        ok = ok && Same(slice, first);
+    }
+
+    // 新块与旧块一样大，未读的数据被复制过去
+    size_t new_size = std::static_pointer_cast<std::vector<char>>(buf.Slice(0, 0).block)->size();
+    ok = ok && Block(buf) != old && Same(slice, first) && new_size == old_size;
+    ok = ok && buf.ReadableBytes() > 0 && memcmp(buf.Peek() + buf.ReadableBytes() - 100, Pattern(100, seed - 1).data(), 100) == 0;
+
+    std::cout << "append\t\t: blocks switched after " << seed - 2 << " appends " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+// 有切片时 RetrieveAll 不回到内存块的开头，之后写入的数据不会覆盖切片
+// 切片释放之后恢复原来的行为，回到开头写入
+bool TestRetrieveAll()
+{
+    MsgBuffer buf(1024);
+    std::string first = Pattern(200, 3);
+    buf.Append(first);
+    BufferSlice slice = buf.Slice(0, first.size());
+    const char *peek = buf.Peek();
+
+    buf.RetrieveAll();
+    buf.Append(Pattern(200, 4));
+    bool ok = Same(slice, first) && buf.Peek() == peek + first.size();
+
+    slice = BufferSlice();
+    buf.RetrieveAll();
+    buf.Append(Pattern(200, 5));
+    ok = ok && buf.Peek() == peek;
+
+    std::cout << "retrieve all\t: " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+// 有切片时 AddInFront 不在原地写入：头部前面的空间和向后搬移可读数据都会覆盖切片
+bool TestAddInFront()
+{
+    MsgBuffer buf(1024);
+    std::string first = Pattern(100, 6);
+    std::string second = Pattern(100, 7);
+    std::string front = Pattern(50, 8);
+    buf.Append(first);
+    buf.Append(second);
+
+    // 已经读过的数据被切片引用，头部前面的空间不能写
+    BufferSlice retrieved = buf.Slice(0, first.size());
+    buf.Retrieve(first.size());
+    buf.AddInFront(front.data(), front.size());
+    bool ok = Same(retrieved, first) && buf.ReadableBytes() == front.size() + second.size();
+    ok = ok && std::string(buf.Peek(), front.size()) == front && std::string(buf.Peek() + front.size(), second.size()) == second;
+
+    // 可读的数据被切片引用，不能向后搬移
+    MsgBuffer other(1024);
+    other.Append(first);
+    BufferSlice readable = other.Slice(0, first.size());
+    other.AddInFront(front.data(), front.size());
+    ok = ok && Same(readable, first) && std::string(other.Peek(), front.size()) == front;
+    ok = ok && std::string(other.Peek() + front.size(), first.size()) == first;
+
+    // 没有切片时仍然在原地写入
+    MsgBuffer plain(1024);
+    plain.Append(first);
+    plain.Retrieve(front.size());
+    const char *peek = plain.Peek();
+    plain.AddInFront(front.data(), front.size());
+    ok = ok && plain.Peek() == peek - front.size();
+
+    std::cout << "add in front\t: " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+// 有切片时从套接字读数据，读满内存块之后换新的内存块，切片的内容不变，读到的数据完整
+bool TestReadFd()
+{
+    int fds[2];
+    ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    MsgBuffer buf(1024);
+    std::string first = Pattern(300, 9);
+    buf.Append(first);
+    BufferSlice slice = buf.Slice(0, first.size());
+    buf.Retrieve(first.size());
+    const void *old = Block(buf);
+
+    std::string sent;
+    std::string received;
+    bool ok = true;
+    int seed = 10;
+    while ((Block(buf) == old || sent.size() < 16 * 1024) && sent.size() < 1024 * 1024)
+    {
+        std::string data = Pattern(700, seed++);
+        ok = ok && ::write(fds[1], data.data(), data.size()) == (ssize_t)data.size();
+        sent += data;
+
+        int err = 0;
+        while (buf.ReadFd(fds[0], &err) > 0)
+        {
+        }
+
+        // 每次读完取走一部分，保留一些未读数据跨越内存块
+        size_t take = buf.ReadableBytes() > 100 ? buf.ReadableBytes() - 100 : 0;
+        received.append(buf.Peek(), take);
+        buf.Retrieve(take);
+        ok = ok && Same(slice, first);
+    }
+    received.append(buf.Peek(), buf.ReadableBytes());
+    ok = ok && Block(buf) != old && received == sent && Same(slice, first);
+
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    std::cout << "read fd\t\t: " << sent.size() << " bytes " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+// 切片组成的数据包按 [offset, offset + len) 拆分片段，跨越切片边界时每个切片一段，片段持有所在切片的内存块
+bool TestForEachSlice()
+{
+    std::vector<size_t> sizes = {5, 1, 7, 3, 10};
+    std::string data = Pattern(26, 11);
+
+    PacketPtr packet = Packet::NewSlicedPacket(data.size());
+    std::vector<std::shared_ptr<void>> blocks;
+    size_t pos = 0;
+    for (auto size : sizes)
+    {
+        std::shared_ptr<char> block(new char[size], std::default_delete<char[]>());
+        memcpy(block.get(), data.data() + pos, size);
+        blocks.push_back(block);
+
+        BufferSlice slice;
+        slice.block = block;
+        slice.data = block.get();
+        slice.size = size;
+        packet->AppendSlice(std::move(slice));
+        pos += size;
+    }
+
+    bool ok = packet->PacketSize() == (int32_t)data.size();
+    for (size_t offset = 0; offset <= data.size(); offset++)
+    {
+        for (size_t len = 0; offset + len <= data.size(); len++)
+        {
+            std::string joined;
+            size_t pieces = 0;
+            bool owned = true;
+            packet->ForEachSlice(offset, len, [&](const BufferSlice &slice){
+                joined.append(slice.data, slice.size);
+                pieces++;
+
+                // 片段落在某个切片的内存块内，并且持有该内存块
+                bool found = false;
+                for (size_t i = 0; i < blocks.size(); i++)
+                {
+                    const char *b = (const char*)blocks[i].get();
+                    if (slice.data >= b && slice.data + slice.size <= b + sizes[i] && slice.block == blocks[i])
+                    {
+                        found = true;
+                    }
+                }
+                owned = owned && found && slice.size > 0;
+            });
+
+            // 片段数量等于与区间相交的切片数量
+            size_t expect = 0;
+            size_t start = 0;
+            for (auto size : sizes)
+            {
+                if (len > 0 && start < offset + len && start + size > offset)
+                {
+                    expect++;
+                }
+                start += size;
+            }
+
+            ok = ok && joined == data.substr(offset, len) && pieces == expect && owned;
+        }
+    }
+
+    // 普通的包只有一个片段
+    PacketPtr plain = Packet::NewPacket(data.size());
+    memcpy(plain->Data(), data.data(), data.size());
+    plain->SetPacketSize(data.size());
+    size_t pieces = 0;
+    std::string joined;
+    plain->ForEachSlice(3, 20, [&](const BufferSlice &slice){
+        joined.append(slice.data, slice.size);
+        pieces++;
+    });
+    ok = ok && pieces == 1 && joined == data.substr(3, 20);
+
+    std::cout << "for each slice\t: " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+int main(int argc, const char **argv)
+{
+    bool ok = true;
+    ok = TestAppend() && ok;
+    ok = TestRetrieveAll() && ok;
+    ok = TestAddInFront() && ok;
+    ok = TestReadFd() && ok;
+    ok = TestForEachSlice() && ok;
+
+    std::cout << "msg buffer slice\t: " << (ok ? "ok" : "failed") << std::endl;
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <cstring>
+#include "mmedia/base/Packet.h"
+#include "mmedia/base/PacketPool.h"
+
+using namespace lss::mm;
+
+// 分配和释放的次数
+const int kRounds = 1000000;
+
+// 同一线程释放之后再分配，应该从空闲链表命中
+bool TestReuse()
+{
+    auto before = PacketPool::Stats();
+
+    void *p = PacketPool::Allocate(1000);
+    PacketPool::Free(p);
+    void *q = PacketPool::Allocate(1000);
+    PacketPool::Free(q);
+
+    auto after = PacketPool::Stats();
+    return p == q && after.hits == before.hits + 1 && after.misses == before.misses + 1;
+}
+
+// 其他线程释放的块归还到分配的线程，分配的线程下次分配时取回
+bool TestRemoteFree()
+{
+    auto before = PacketPool::Stats();
+
+    std::vector<PacketPtr> packets;
+    for (int i = 0; i < 16; i++)
+    {
+        packets.emplace_back(Packet::NewPacket(3000));
+    }
+    Packet *first = packets[0].get();
+
+    std::thread t([&packets](){
+        packets.clear();
+    });
+    t.join();
+
+    auto middle = PacketPool::Stats();
+    bool reused = false;
+    for (int i = 0; i < 16; i++)
+    {
+        packets.emplace_back(Packet::NewPacket(3000));
+        reused = reused || packets.back().get() == first;
+    }
+    packets.clear();
+
+    auto after = PacketPool::Stats();
+    return reused && middle.remote_frees >= before.remote_frees + 16 && after.hits >= middle.hits + 16;
+}
+
+// 超过最大级别的块不经过内存池
+bool TestOversize()
+{
+    auto before = PacketPool::Stats();
+    PacketPtr packet = Packet::NewPacket(8 * 1024 * 1024);
+    memset(packet->Data(), 0x01, 8 * 1024 * 1024);
+    packet.reset();
+
+    return PacketPool::Stats().oversize == before.oversize + 1;
+}
+
+// 数据包、消息头和数据只分配一块内存，引用计数在包对象内部，拷贝时消息头随数据一起拷贝
+bool TestInlineHeader()
+{
+    auto before = PacketPool::Stats();
+
+    PacketPtr packet = Packet::NewPacket(100);
+    PacketHeader *header = packet->InitHeader();
+    header->cs_id = 6;
+    header->msg_len = 100;
+    header->msg_type = 9;
+    header->msg_sid = 1;
+
+    PacketPtr copy = packet;
+    bool ok = copy == packet && packet.use_count() == 2 && copy->Header() == header;
+
+    PacketPtr clone = packet->Clone();
+    const PacketHeader *h = clone->Header();
+    ok = ok && h && h != header && h->cs_id == 6 && h->msg_len == 100 && h->msg_type == 9 && h->msg_sid == 1;
+
+    // 没有初始化消息头的数据包返回空
+    ok = ok && !Packet::NewPacket(100)->Header();
+
+    auto after = PacketPool::Stats();
+    ok = ok && (after.hits + after.misses) - (before.hits + before.misses) == 3;
+
+    copy.reset();
+    return ok && packet.use_count() == 1 && copy == nullptr;
+}
+
+// 对比原来的 new char[] + memset + 独立控制块
+void Bench(int32_t size)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; i++)
+    {
+        char *block = new char[size + sizeof(Packet)];
+        memset(block + sizeof(Packet), 0x00, size);
+        Packet *packet = new (block) Packet(size);
+        std::shared_ptr<Packet> p(packet, [](Packet *p){
+            p->~Packet();
+            delete [](char*)p;
+        });
+    }
+    auto heap = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < kRounds; i++)
+    {
+        PacketPtr p = Packet::NewPacket(size);
+    }
+    auto pool = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "size " << size << "\t: heap " << heap / kRounds << " ns, pool " << pool / kRounds << " ns" << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+    std::cout << "reuse\t\t: " << (TestReuse() ? "ok" : "failed") << std::endl;
+    std::cout << "remote free\t: " << (TestRemoteFree() ? "ok" : "failed") << std::endl;
+    std::cout << "oversize\t: " << (TestOversize() ? "ok" : "failed") << std::endl;
+    std::cout << "inline header\t: " << (TestInlineHeader() ? "ok" : "failed") << std::endl;
+
+    for (int32_t size : {64, 1024, 16 * 1024, 256 * 1024})
+    {
+        Bench(size);
+    }
+
+    auto stats = PacketPool::Stats();
+    for (auto &cs : stats.classes)
+    {
+        if (cs.hits + cs.misses > 0)
+        {
+            std::cout << "class " << cs.size << "\t: hits " << cs.hits << " misses " << cs.misses
+                      << " remote frees " << cs.remote_frees << " bytes held " << cs.bytes_held << std::endl;
+        }
+    }
+
+    return 0;
+}
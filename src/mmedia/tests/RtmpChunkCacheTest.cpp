@@ -0,0 +1,202 @@
+#include <iostream>
+#include <string>
+#include <future>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "network/net/EventLoopThread.h"
+#include "network/net/TcpConnection.h"
+#include "mmedia/rtmp/RtmpContext.h"
+#include "mmedia/rtmp/RtmpChunkCache.h"
+#include "mmedia/rtmp/RtmpHeader.h"
+
+using namespace lss::network;
+using namespace lss::mm;
+
+// 不处理任何消息
+class NullHandler : public RtmpHandler
+{
+public:
+    void OnNewConnection(const TcpConnectionPtr &conn) override {}
+    void OnConnectionDestroy(const TcpConnectionPtr &conn) override {}
+    void OnActive(const ConnectionPtr &conn) override {}
+    void OnRecv(const TcpConnectionPtr &conn, const PacketPtr &data) override {}
+    void OnRecv(const TcpConnectionPtr &conn, PacketPtr &&data) override {}
+};
+
+// 创建一个视频消息，消息体第 i 个字节为 i 的低 8 位；slices 大于 1 时按不等长的切片组成
+PacketPtr MakePacket(uint32_t cs_id, int32_t len, int slices, int32_t index)
+{
+    PacketPtr packet;
+    if (slices <= 1)
+    {
+        packet = Packet::NewPacket(len);
+        for (int32_t i = 0; i < len; i++)
+        {
+            packet->Data()[i] = (char)i;
+        }
+        packet->SetPacketSize(len);
+    }
+    else
+    {
+        // 切片的边界不与块的边界对齐，块会跨越多个切片
+        packet = Packet::NewSlicedPacket(len);
+        int32_t offset = 0;
+        for (int s = 0; s < slices; s++)
+        {
+            int32_t size = s == slices - 1 ? len - offset : len / slices + 37 * s;
+            std::shared_ptr<char> block(new char[size], std::default_delete<char[]>());
+            for (int32_t i = 0; i < size; i++)
+            {
+                block.get()[i] = (char)(offset + i);
+            }
+
+            BufferSlice slice;
+            slice.block = block;
+            slice.data = block.get();
+            slice.size = size;
+            packet->AppendSlice(std::move(slice));
+            offset += size;
+        }
+    }
+
+    RtmpMsgHeader *h = packet->InitHeader();
+    h->cs_id = cs_id;
+    h->msg_len = len;
+    h->msg_type = kRtmpMsgTypeVideo;
+    h->msg_sid = 1;
+    packet->SetIndex(index);
+    packet->SetPacketType(kPacketTypeVideo);
+    return packet;
+}
+
+// 首块使用格式0时头部的长度
+size_t FirstHeaderLen(uint32_t cs_id, uint32_t timestamp)
+{
+    size_t len = cs_id < 64 ? 1 : (cs_id < 64 + 256 ? 2 : 3);
+    len += 11;
+    if (timestamp >= 0xFFFFFF)
+    {
+        len += 4;
+    }
+    return len;
+}
+
+// 把布局中的所有片段拼接起来
+std::string Join(const RtmpChunkLayout *layout)
+{
+    std::string out;
+    for (auto const &iov : layout->iovs)
+    {
+        out.append((const char*)iov.iov_base, iov.iov_len);
+    }
+    return out;
+}
+
+// 在事件循环中用一个新的连接发送数据包，返回对端收到的全部字节；cache 不为空时经过分块缓存
+std::string Send(EventLoop *loop, const PacketPtr &packet, uint32_t timestamp, const RtmpChunkCachePtr &cache)
+{
+    std::promise<std::string> done;
+    loop->RunInLoop([loop, &packet, timestamp, &cache, &done](){
+        int fds[2];
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        ::fcntl(fds[1], F_SETFL, O_NONBLOCK);
+        InetAddress addr("127.0.0.1:0");
+        NullHandler handler;
+        {
+            auto conn = std::make_shared<TcpConnection>(loop, fds[0], addr, addr);
+            RtmpContext context(conn, &handler);
+            if (cache)
+            {
+                context.SetChunkCache(cache);
+            }
+            context.BuildChunk(packet, timestamp, true);
+            context.Send();
+        }
+
+        std::string out;
+        char buf[65536];
+        ssize_t n;
+        while ((n = ::read(fds[1], buf, sizeof(buf))) > 0)
+        {
+            out.append(buf, n);
+        }
+        ::close(fds[1]);
+        done.set_value(out);
+    });
+    return done.get_future().get();
+}
+
+// 缓存的布局、预先构建的布局与不经过缓存直接分块的输出逐字节相同
+bool TestMatch(EventLoop *loop, const char *name, uint32_t cs_id, int32_t len, int slices, uint32_t timestamp)
+{
+    uint32_t ext = timestamp >= 0xFFFFFF ? timestamp : 0;
+    PacketPtr packet = MakePacket(cs_id, len, slices, 1);
+    std::string expect = Send(loop, packet, timestamp, nullptr);
+    std::string body = expect.substr(FirstHeaderLen(cs_id, timestamp));
+
+    // 经过缓存，第二次获取命中同一个布局
+    auto cache = std::make_shared<RtmpChunkCache>(4);
+    auto layout = cache->GetLayout(packet, kRtmpOutChunkSize, ext);
+    bool ok = layout && Join(layout.get()) == body && cache->GetLayout(packet, kRtmpOutChunkSize, ext) == layout;
+
+    // 连接经过缓存发送
+    ok = ok && Send(loop, packet, timestamp, cache) == expect;
+
+    // 随数据包发布的布局，只有默认块大小、不带扩展时间戳时使用
+    auto shared = RtmpChunkCache::BuildLayout(packet, kRtmpOutChunkSize, ext);
+    ok = ok && !shared->packet && Join(shared.get()) == body;
+    packet->SetOutLayout(shared);
+    ok = ok && Send(loop, packet, timestamp, nullptr) == expect;
+
+    std::cout << name << "\t: " << expect.size() << " bytes, " << (layout ? layout->iovs.size() : 0) << " iovs " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+// 索引取模后落在同一个槽位的新数据包替换旧布局，旧数据包不再被缓存持有
+bool TestSlotReuse(EventLoop *loop)
+{
+    auto cache = std::make_shared<RtmpChunkCache>(4);
+    PacketPtr first = MakePacket(6, 10000, 1, 1);
+    PacketPtr second = MakePacket(6, 9000, 3, 5);
+
+    auto old_layout = cache->GetLayout(first, kRtmpOutChunkSize, 0);
+    // 缓存的布局持有一份引用
+    long refs = first.use_count();
+    auto layout = cache->GetLayout(second, kRtmpOutChunkSize, 0);
+    old_layout.reset();
+
+    std::string expect = Send(loop, second, 0, nullptr);
+    bool ok = layout && layout->packet == second && Join(layout.get()) == expect.substr(FirstHeaderLen(6, 0));
+    ok = ok && first.use_count() == refs - 1;
+
+    // 回到第一个数据包时重新构建，不会返回第二个数据包的布局
+    auto again = cache->GetLayout(first, kRtmpOutChunkSize, 0);
+    ok = ok && again && again->packet == first && again != layout;
+
+    std::cout << "slot reuse\t: " << (ok ? "ok" : "failed") << std::endl;
+    return ok;
+}
+
+int main(int argc, const char **argv)
+{
+    EventLoopThread thread;
+    thread.Run();
+    EventLoop *loop = thread.Loop();
+
+    bool ok = true;
+    ok = TestMatch(loop, "single chunk", 6, 1000, 1, 40) && ok;
+    ok = TestMatch(loop, "multi chunk", 6, 20000, 1, 40) && ok;
+    ok = TestMatch(loop, "multi slice", 6, 20000, 7, 40) && ok;
+    ok = TestMatch(loop, "cs_id 64", 64, 20000, 3, 40) && ok;
+    ok = TestMatch(loop, "cs_id 319", 319, 20000, 3, 40) && ok;
+    ok = TestMatch(loop, "cs_id 320", 320, 20000, 3, 40) && ok;
+    ok = TestMatch(loop, "cs_id 1000", 1000, 20000, 1, 40) && ok;
+    ok = TestMatch(loop, "ext timestamp", 6, 20000, 3, 0x1234567) && ok;
+    ok = TestMatch(loop, "ext cs_id 320", 320, 20000, 1, 0x1234567) && ok;
+    ok = TestSlotReuse(loop) && ok;
+
+    std::cout << "chunk cache\t: " << (ok ? "ok" : "failed") << std::endl;
+    return 0;
+}
@@ -0,0 +1,83 @@
+#include <iostream>
+#include <vector>
+#include <cstring>
+#include <sys/uio.h>
+#include "mmedia/rtmp/RtmpHeaderArena.h"
+#include "mmedia/rtmp/RtmpHeader.h"
+
+using namespace lss::mm;
+
+// 写入 count 个后续块头部，每个头部的内容是它的序号，返回对应的 iovec
+std::vector<struct iovec> Fill(RtmpHeaderArena &arena, int count)
+{
+    std::vector<struct iovec> iovs;
+    for (int i = 0; i < count; i++)
+    {
+        char *p = arena.Reserve(kRtmpMaxChunkHeader);
+        size_t len = 1 + i % kRtmpMaxChunkHeader;
+        memset(p, i & 0xff, len);
+        arena.Commit(len);
+        iovs.push_back({p, len});
+    }
+    return iovs;
+}
+
+// 校验所有头部的内容没有被后来的写入覆盖
+bool Check(const std::vector<struct iovec> &iovs)
+{
+    for (size_t i = 0; i < iovs.size(); i++)
+    {
+        const char *p = (const char*)iovs[i].iov_base;
+        for (size_t j = 0; j < iovs[i].iov_len; j++)
+        {
+            if (p[j] != (char)(i & 0xff))
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// 超过第一个内存块的头部不截断，已经写入的地址不变
+bool TestGrow()
+{
+    RtmpHeaderArena arena(4096);
+
+    // 128 字节的块大小发送一个 GOP，头部远超 4KB
+    auto iovs = Fill(arena, 20000);
+    return Check(iovs) && arena.Blocks() > 1 && arena.Used() > 4096;
+}
+
+// 回收后合并成一个内存块，同样大小的批量发送不再增长
+bool TestRecycle()
+{
+    RtmpHeaderArena arena(4096);
+    Fill(arena, 20000);
+    arena.Reset();
+
+    bool ok = arena.Blocks() == 1 && arena.Used() == 0;
+    size_t capacity = arena.Capacity();
+
+    auto iovs = Fill(arena, 20000);
+    return ok && Check(iovs) && arena.Blocks() == 1 && arena.Capacity() == capacity;
+}
+
+// 一次超大的批量发送之后只保留上限大小的内存
+bool TestRetainLimit()
+{
+    RtmpHeaderArena arena(4096, 16 * 1024);
+    Fill(arena, 50000);
+    arena.Reset();
+
+    return arena.Blocks() == 1 && arena.Capacity() == 16 * 1024;
+}
+
+int main(int argc, const char **argv)
+{
+    std::cout << "grow\t\t: " << (TestGrow() ? "ok" : "failed") << std::endl;
+    std::cout << "recycle\t\t: " << (TestRecycle() ? "ok" : "failed") << std::endl;
+    std::cout << "retain limit\t: " << (TestRetainLimit() ? "ok" : "failed") << std::endl;
+
+    return 0;
+}
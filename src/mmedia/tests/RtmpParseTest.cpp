@@ -0,0 +1,294 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <map>
+#include <future>
+#include <chrono>
+#include <cstring>
+#include <unistd.h>
+#include <sys/socket.h>
+#include "network/net/EventLoopThread.h"
+#include "network/net/TcpConnection.h"
+#include "mmedia/rtmp/RtmpContext.h"
+
+using namespace lss::network;
+using namespace lss::mm;
+
+// 每次读入接收缓冲区的字节数，模拟一次 read 读到的数据
+const size_t kReadSize = 16 * 1024;
+
+// 解析的轮数
+const int kRounds = 5;
+
+// 统计收到的音视频消息
+class CountHandler : public RtmpHandler
+{
+public:
+    void OnNewConnection(const TcpConnectionPtr &conn) override {}
+    void OnConnectionDestroy(const TcpConnectionPtr &conn) override {}
+    void OnActive(const ConnectionPtr &conn) override {}
+
+    void OnRecv(const TcpConnectionPtr &conn, const PacketPtr &data) override
+    {
+        Count(data);
+    }
+
+    void OnRecv(const TcpConnectionPtr &conn, PacketPtr &&data) override
+    {
+        Count(data);
+    }
+
+    void Count(const PacketPtr &data)
+    {
+        messages++;
+        bytes += data->PacketSize();
+        if (data->IsVideo())
+        {
+            last_video_ts = data->TimeStamp();
+        }
+    }
+
+    int64_t messages{0};
+    int64_t bytes{0};
+    uint64_t last_video_ts{0};
+};
+
+// 4 字节大端整数的消息体
+std::string Uint32Body(uint32_t v)
+{
+    std::string body(4, 0);
+    body[0] = (char)(v >> 24);
+    body[1] = (char)(v >> 16);
+    body[2] = (char)(v >> 8);
+    body[3] = (char)v;
+    return body;
+}
+
+// 按编码器的方式把消息分块：每个块流第一条消息用 fmt0，长度或类型变化用 fmt1，
+// 只有时间戳增量变化用 fmt2，完全相同用 fmt3，消息体超过块大小的部分使用 fmt3 的后续块
+class ChunkWriter
+{
+public:
+    void Write(uint32_t csid, uint8_t type, uint32_t ts, const std::string &body)
+    {
+        State &st = states_[csid];
+        uint32_t len = body.size();
+        uint32_t delta = ts - st.ts;
+
+        int fmt = 0;
+        if (st.started && ts >= st.ts)
+        {
+            fmt = 1;
+            if (len == st.len && type == st.type)
+            {
+                fmt = delta == st.delta ? 3 : 2;
+            }
+        }
+
+        out_.push_back((char)((fmt << 6) | csid));
+        if (fmt == 0)
+        {
+            PutUint24(ts);
+            PutUint24(len);
+            out_.push_back((char)type);
+            uint32_t sid = 1;
+            out_.append((const char*)&sid, 4);
+        }
+        else if (fmt == 1)
+        {
+            PutUint24(delta);
+            PutUint24(len);
+            out_.push_back((char)type);
+        }
+        else if (fmt == 2)
+        {
+            PutUint24(delta);
+        }
+
+        for (uint32_t offset = 0; offset < len; offset += chunk_size_)
+        {
+            if (offset > 0)
+            {
+                out_.push_back((char)(0xC0 | csid));
+            }
+            out_.append(body, offset, std::min(len - offset, chunk_size_));
+        }
+
+        st.started = true;
+        st.delta = fmt == 0 ? 0 : delta;
+        st.ts = ts;
+        st.len = len;
+        st.type = type;
+    }
+
+    void SetChunkSize(uint32_t size)
+    {
+        chunk_size_ = size;
+    }
+
+    std::string &Data()
+    {
+        return out_;
+    }
+
+private:
+    void PutUint24(uint32_t v)
+    {
+        out_.push_back((char)((v >> 16) & 0xff));
+        out_.push_back((char)((v >> 8) & 0xff));
+        out_.push_back((char)(v & 0xff));
+    }
+
+    struct State
+    {
+        bool started{false};
+        uint32_t ts{0};
+        uint32_t delta{0};
+        uint32_t len{0};
+        uint8_t type{0};
+    };
+
+    std::map<uint32_t, State> states_;
+    uint32_t chunk_size_{128};
+    std::string out_;
+};
+
+// 生成编码器推流的数据：设置块大小和确认窗口之后，30fps 视频走 6 号块流，每 2 秒一个 120KB 的关键帧，
+// 其余帧 8~20KB；44.1kHz AAC 音频走 4 号块流，每帧 372 字节；按时间戳交错
+std::string MakeCapture(uint32_t chunk_size, int seconds, int64_t &messages, uint32_t &last_video_ts)
+{
+    ChunkWriter writer;
+    writer.Write(2, kRtmpMsgTypeChunkSize, 0, Uint32Body(chunk_size));
+    writer.SetChunkSize(chunk_size);
+    // 确认窗口足够大，计时的部分不发送确认消息
+    writer.Write(2, kRtmpMsgTypeWindowACKSize, 0, Uint32Body(0x7fffffff));
+
+    messages = 0;
+    int video = 0, audio = 0;
+    uint32_t video_ts = 0, audio_ts = 0;
+    while (video_ts < (uint32_t)seconds * 1000)
+    {
+        if (video_ts <= audio_ts)
+        {
+            bool key = video % 60 == 0;
+            std::string body(key ? 120 * 1024 : 8 * 1024 + (video * 7919) % (12 * 1024), (char)video);
+            body[0] = key ? 0x17 : 0x27;
+            writer.Write(6, kRtmpMsgTypeVideo, video_ts, body);
+            last_video_ts = video_ts;
+            video++;
+            video_ts = video * 1000 / 30;
+        }
+        else
+        {
+            std::string body(372, (char)audio);
+            body[0] = (char)0xaf;
+            writer.Write(4, kRtmpMsgTypeAudio, audio_ts, body);
+            audio++;
+            audio_ts = audio * 1024 * 1000 / 44100;
+        }
+        messages++;
+    }
+
+    return std::move(writer.Data());
+}
+
+// 读取抓包得到的推流数据，文件内容是 TCP 连接上客户端发出的原始字节（例如用 tcpflow 从 OBS/ffmpeg 推流中提取）
+// 以 0x03 开头时跳过 C0、C1 和 C2 握手包
+bool LoadCapture(const char *path, std::string &data)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in)
+    {
+        return false;
+    }
+
+    std::stringstream ss;
+    ss << in.rdbuf();
+    data = ss.str();
+
+    const size_t handshake = 1 + 1536 + 1536;
+    if (!data.empty() && data[0] == 0x03 && data.size() > handshake)
+    {
+        data.erase(0, handshake);
+    }
+    return true;
+}
+
+// 在事件循环中按 kReadSize 分批解析 data，返回解析的耗时，单位：纳秒
+int64_t Parse(EventLoop *loop, const std::string &data, CountHandler &handler)
+{
+    std::promise<int64_t> done;
+    loop->RunInLoop([loop, &data, &handler, &done](){
+        int fds[2];
+        ::socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+        InetAddress addr("127.0.0.1:0");
+        {
+            // 连接只用于确认消息和接收提示，在事件循环中析构
+            auto conn = std::make_shared<TcpConnection>(loop, fds[0], addr, addr);
+            RtmpContext context(conn, &handler);
+            MsgBuffer buff;
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t offset = 0; offset < data.size(); offset += kReadSize)
+            {
+                buff.Append(data.data() + offset, std::min(kReadSize, data.size() - offset));
+                context.ParseMessage(buff);
+            }
+            done.set_value(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+        ::close(fds[1]);
+    });
+    return done.get_future().get();
+}
+
+// 解析 rounds 轮，校验消息数量和最后一个视频帧的时间戳，输出吞吐量
+void Bench(EventLoop *loop, const char *name, const std::string &data, int64_t messages, int64_t last_video_ts)
+{
+    int64_t total = 0;
+    int64_t parsed = 0;
+    bool ok = true;
+    for (int i = 0; i < kRounds; i++)
+    {
+        CountHandler handler;
+        total += Parse(loop, data, handler);
+        parsed += handler.messages;
+        ok = ok && (messages < 0 || handler.messages == messages) && (last_video_ts < 0 || (int64_t)handler.last_video_ts == last_video_ts);
+    }
+
+    double seconds = total / 1e9;
+    std::cout << name << "\t: " << parsed / kRounds << " messages, " << data.size() << " bytes, "
+              << (int64_t)(data.size() * kRounds / seconds / 1024 / 1024) << " MB/s, "
+              << (int64_t)(parsed / seconds) << " messages/s " << (ok ? "ok" : "failed") << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+    EventLoopThread thread;
+    thread.Run();
+    EventLoop *loop = thread.Loop();
+
+    // OBS 默认的 4096 字节块大小，和未修改块大小的编码器使用的 128 字节
+    for (uint32_t chunk_size : {4096u, 128u})
+    {
+        int64_t messages = 0;
+        uint32_t last_video_ts = 0;
+        std::string data = MakeCapture(chunk_size, 60, messages, last_video_ts);
+        std::string name = "chunk " + std::to_string(chunk_size);
+        Bench(loop, name.c_str(), data, messages, last_video_ts);
+    }
+
+    // 命令行指定的抓包文件，不校验内容，只输出吞吐量
+    for (int i = 1; i < argc; i++)
+    {
+        std::string data;
+        if (!LoadCapture(argv[i], data))
+        {
+            std::cout << argv[i] << "\t: open failed" << std::endl;
+            continue;
+        }
+        Bench(loop, argv[i], data, -1, -1);
+    }
+
+    return 0;
+}
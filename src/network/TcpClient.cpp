@@ -203,6 +203,16 @@ void TcpClient::Send(std::list<BufferNodePtr> &list)
     }
 }
 
+void TcpClient::Send(const struct iovec *iov, size_t count)
+{
+    // 如果状态为已连接
+    if (status_ == kTcpConStatusConnected)
+    {
+        // 调用基类的发送处理
+        TcpConnection::Send(iov, count);
+    }
+}
+
 void TcpClient::Send(const char *buff, size_t size)
 {
     // 如果状态为已连接
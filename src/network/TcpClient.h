@@ -45,9 +45,18 @@ namespace lss
             // 重写关闭事件处理
             void OnClose() override;  
 
+            // 连接建立要依赖可写事件，客户端始终使用就绪通知
+            bool WantAsyncIo() const override
+            {
+                return false;
+            }
+
             // 发送数据（缓冲区列表）
             void Send(std::list<BufferNodePtr> &list);
 
+            // 发送数据（iovec 数组）
+            void Send(const struct iovec *iov, size_t count);
+
             // 发送数据（原始数据）
             void Send(const char *buff, size_t size);          
 
@@ -41,6 +41,35 @@ void TcpServer::OnAccept(int fd, const InetAddress &addr)
     // 记录新连接信息
     NETWORK_TRACE << " new connection fd : " << fd << " host : " << addr.ToIpPort();
 
+    // 选择负责该连接的服务，没有选择器时由自己处理
+    TcpServer *target = selector_ ? selector_() : nullptr;
+    if (!target)
+    {
+        target = this;
+    }
+
+    // 投递之前就计入连接数，连续到达的连接可以看到这次分配
+    target->loop_->AddConnection(1);
+
+    // 交给其他事件循环时只传递文件描述符，连接对象和协议状态都在目标事件循环中创建
+    if (target != this)
+    {
+        target->loop_->RunInLoop([target, fd, addr](){
+            target->NewConnection(fd, addr);
+        });
+        return;
+    }
+
+    NewConnection(fd, addr);
+}
+
+void TcpServer::SetServerSelector(ServerSelector &&selector)
+{
+    selector_ = std::move(selector);
+}
+
+void TcpServer::NewConnection(int fd, const InetAddress &addr)
+{
     // 创建TcpConnection对象
     TcpConnectionPtr con = std::make_shared<TcpConnection>(loop_, fd, addr_, addr);
     // 设置连接关闭时的回调
@@ -64,8 +93,17 @@ void TcpServer::OnAccept(int fd, const InetAddress &addr)
     connections_.insert(con);
     // 将连接添加到事件循环中
     loop_->AddEvent(con);
-    // 启用空闲超时检查，单位：秒
-    con->EnableCheckIdleTimeout(30);
+    // 启用空闲超时检查，单位：秒，由服务配置
+    if (idle_timeout_ > 0)
+    {
+        con->EnableCheckIdleTimeout(idle_timeout_);
+    }
+
+    // 开启零拷贝发送，必须在添加到事件循环之后，此时才知道是否使用异步 IO
+    if (zerocopy_threshold_ > 0)
+    {
+        con->EnableZeroCopy(zerocopy_threshold_);
+    }
 
     if (new_connection_cb_)
     {
@@ -74,6 +112,40 @@ void TcpServer::OnAccept(int fd, const InetAddress &addr)
     }
 }
 
+void TcpServer::MigrateConnection(const TcpConnectionPtr &con, TcpServer *target, const MigrateCallback &done)
+{
+    loop_->AssertInLoopThread();
+
+    // 放到下一轮执行，此时连接的读事件已经处理完，上层的解析状态是完整的
+    loop_->QueueInLoop([this, con, target, done](){
+        if (target == this || !con->Detach(target->loop_))
+        {
+            if (done)
+            {
+                done(target == this);
+            }
+            return;
+        }
+
+        // 连接改由目标服务管理，关闭时从目标服务的集合中移除
+        connections_.erase(con);
+        loop_->AddConnection(-1);
+        target->loop_->AddConnection(1);
+        con->SetCloseCallback(std::bind(&TcpServer::OnConnectionClose, target, std::placeholders::_1));
+        NETWORK_TRACE << " host : " << con->PeerAddr().ToIpPort() << " migrate to another event loop.";
+
+        target->loop_->RunInLoop([con, target, done](){
+            target->connections_.insert(con);
+            con->Attach();
+
+            if (done)
+            {
+                done(true);
+            }
+        });
+    });
+}
+
 void TcpServer::OnConnectionClose(const TcpConnectionPtr &con)
 {
     // 记录关闭信息
@@ -85,6 +157,7 @@ void TcpServer::OnConnectionClose(const TcpConnectionPtr &con)
     connections_.erase(con);
     // 从事件循环中删除连接
     loop_->DelEvent(con);
+    loop_->AddConnection(-1);
 
     if (destroy_connection_cb_)
     {
@@ -117,6 +190,24 @@ void TcpServer::SetWriteCompleteCallback(WriteCompleteCallback &&cb)
     write_complete_cb_ = std::move(cb);
 }
 
+void TcpServer::SetIdleTimeout(int32_t seconds)
+{
+    // 将最大空闲时间赋值给成员变量
+    idle_timeout_ = seconds;
+}
+
+void TcpServer::SetZeroCopyThreshold(size_t threshold)
+{
+    // 将零拷贝发送的阈值赋值给成员变量
+    zerocopy_threshold_ = threshold;
+}
+
+void TcpServer::SetReuseportCpus(const std::vector<int> &cpus)
+{
+    // 交给接受器，监听之后挂载
+    acceptor_->SetReuseportCpus(cpus);
+}
+
 void TcpServer::SetMessageCallback(const MessageCallback &cb)
 {
     // 将回调函数赋值给成员变量
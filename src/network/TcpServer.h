@@ -16,6 +16,14 @@ namespace lss
 
         // 定义一个连接销毁回调类型，接受一个 TcpConnectionPtr 类型的参数
         using DestroyConnectionCallback = std::function<void (const TcpConnectionPtr &)>;
+
+        class TcpServer;
+
+        // 新连接的服务选择器，返回负责该连接的服务对象，返回空指针时由接受连接的服务自己处理
+        using ServerSelector = std::function<TcpServer *()>;
+
+        // 连接迁移完成的回调，在连接最终所在的事件循环中调用，参数表示是否迁移成功
+        using MigrateCallback = std::function<void (bool)>;
         
         // TcpServer 类的定义
         class TcpServer
@@ -37,8 +45,29 @@ namespace lss
             void SetDestroyConnectionCallback(DestroyConnectionCallback &&cb);
 
             // 处理新连接的函数，接受文件描述符和地址作为参数
+            // 设置了服务选择器时，文件描述符直接交给选中的服务所在的事件循环，再创建连接对象
             void OnAccept(int fd, const InetAddress &addr);
 
+            // 设置新连接的服务选择器，在接受连接的事件循环线程中调用
+            void SetServerSelector(ServerSelector &&selector);
+
+            // 服务所在的事件循环
+            EventLoop *Loop() const
+            {
+                return loop_;
+            }
+
+            // 服务监听的地址
+            const InetAddress &Addr() const
+            {
+                return addr_;
+            }
+
+            // 把本服务的连接迁移到 target 所在的事件循环，target 是同一服务在其他事件循环上的实例
+            // 只能在本服务的事件循环线程中调用，当前正在分发的事件处理完之后才迁移，上层可以在消息回调中调用
+            // 连接对象和上下文原样转交，迁移失败时连接留在原来的事件循环
+            void MigrateConnection(const TcpConnectionPtr &con, TcpServer *target, const MigrateCallback &done);
+
             // 处理连接关闭的函数，接受一个 TcpConnectionPtr 类型的参数
             void OnConnectionClose(const TcpConnectionPtr &con);
 
@@ -60,6 +89,15 @@ namespace lss
             // 设置消息回调函数（右值引用）
             void SetMessageCallback(MessageCallback &&cb);
 
+            // 设置连接的最大空闲时间，单位：秒，之后接受的连接生效，小于等于 0 时不检查空闲超时
+            void SetIdleTimeout(int32_t seconds);
+
+            // 设置零拷贝发送的阈值，单位：字节，之后接受的连接生效，为 0 时不使用零拷贝
+            void SetZeroCopyThreshold(size_t threshold);
+
+            // 设置同一端口的各个监听套接字所在的 CPU，按启动顺序排列，启动之前设置，内核按收到 SYN 的 CPU 选择监听套接字
+            void SetReuseportCpus(const std::vector<int> &cpus);
+
             // 启动服务器的虚函数
             virtual void Start();
 
@@ -70,6 +108,9 @@ namespace lss
             virtual ~TcpServer();
 
         private:
+            // 在服务所在的事件循环中为新的文件描述符创建连接对象
+            void NewConnection(int fd, const InetAddress &addr);
+
             // 事件循环指针
             EventLoop *loop_{nullptr};
 
@@ -96,6 +137,15 @@ namespace lss
 
             // 连接销毁回调函数
             DestroyConnectionCallback destroy_connection_cb_;
+
+            // 连接的最大空闲时间，单位：秒
+            int32_t idle_timeout_{30};
+
+            // 零拷贝发送的阈值，单位：字节
+            size_t zerocopy_threshold_{0};
+
+            // 新连接的服务选择器
+            ServerSelector selector_;
         };
     }
 }
\ No newline at end of file
@@ -13,15 +13,34 @@ namespace lss::network
 }
 
 MsgBuffer::MsgBuffer(size_t len)
-    : head_(kBufferOffset), initCap_(len), buffer_(len + head_), tail_(head_)
+    : head_(kBufferOffset), initCap_(len), buffer_(std::make_shared<std::vector<char>>(len + head_)), tail_(head_)
 {
 }
 
+MsgBuffer::MsgBuffer(const MsgBuffer &buf)
+    : head_(buf.head_),
+      initCap_(buf.initCap_),
+      buffer_(std::make_shared<std::vector<char>>(*buf.buffer_)),
+      tail_(buf.tail_)
+{
+}
+
+MsgBuffer &MsgBuffer::operator=(const MsgBuffer &buf)
+{
+    if (this != &buf)
+    {
+        MsgBuffer tmp(buf);
+        Swap(tmp);
+    }
+    return *this;
+}
+
 void MsgBuffer::EnsureWritableBytes(size_t len)
 {
     if (WritableBytes() >= len)
         return;
-    if (head_ + WritableBytes() >=
+    // the retrieved space may still be referenced by slices
+    if (!Shared() && head_ + WritableBytes() >=
         (len + kBufferOffset))  // move Readable bytes
     {
         std::copy(begin() + head_, begin() + tail_, begin() + kBufferOffset);
@@ -30,9 +49,13 @@ void MsgBuffer::EnsureWritableBytes(size_t len)
         return;
     }
     // create new buffer
+    // a shared block is replaced by one of the same size instead of growing,
+    // so the blocks kept alive by slices are filled before a new one is used
     size_t newLen;
-    if ((buffer_.size() * 2) > (kBufferOffset + ReadableBytes() + len))
-        newLen = buffer_.size() * 2;
+    if (Shared() && buffer_->size() >= (kBufferOffset + ReadableBytes() + len))
+        newLen = buffer_->size() - kBufferOffset;
+    else if ((buffer_->size() * 2) > (kBufferOffset + ReadableBytes() + len))
+        newLen = buffer_->size() * 2;
     else
         newLen = kBufferOffset + ReadableBytes() + len;
     MsgBuffer newbuffer(newLen);
@@ -51,14 +74,14 @@ void MsgBuffer::Swap(MsgBuffer &buf) noexcept
 void MsgBuffer::Append(const MsgBuffer &buf)
 {
     EnsureWritableBytes(buf.ReadableBytes());
-    memcpy(&buffer_[tail_], buf.Peek(), buf.ReadableBytes());
+    memcpy(begin() + tail_, buf.Peek(), buf.ReadableBytes());
     tail_ += buf.ReadableBytes();
 }
 
 void MsgBuffer::Append(const char *buf, size_t len)
 {
     EnsureWritableBytes(len);
-    memcpy(&buffer_[tail_], buf, len);
+    memcpy(begin() + tail_, buf, len);
     tail_ += len;
 }
 
@@ -131,9 +154,15 @@ void MsgBuffer::Retrieve(size_t len)
 
 void MsgBuffer::RetrieveAll()
 {
-    if (buffer_.size() > (initCap_ * 2))
+    // keep writing after the handed out bytes while slices are alive
+    if (Shared())
+    {
+        head_ = tail_;
+        return;
+    }
+    if (buffer_->size() > (initCap_ * 2))
     {
-        buffer_.resize(initCap_);
+        buffer_->resize(initCap_);
     }
     tail_ = head_ = kBufferOffset;
 }
@@ -159,7 +188,7 @@ ssize_t MsgBuffer::ReadFd(int fd, int *retErrno)
     }
     else
     {
-        tail_ = buffer_.size();
+        tail_ = buffer_->size();
         Append(extBuffer, n - writable);
     }
     return n;
@@ -202,15 +231,26 @@ uint64_t MsgBuffer::ReadInt64()
     return ret;
 }
 
+BufferSlice MsgBuffer::Slice(size_t offset, size_t len) const
+{
+    assert(offset + len <= ReadableBytes());
+    BufferSlice slice;
+    slice.block = buffer_;
+    slice.data = Peek() + offset;
+    slice.size = len;
+    return slice;
+}
+
 void MsgBuffer::AddInFront(const char *buf, size_t len)
 {
-    if (head_ >= len)
+    // writing in place would overwrite the bytes referenced by slices
+    if (head_ >= len && !Shared())
     {
         memcpy(begin() + head_ - len, buf, len);
         head_ -= len;
         return;
     }
-    if (len <= WritableBytes())
+    if (len <= WritableBytes() && !Shared())
     {
         std::copy(begin() + head_, begin() + tail_, begin() + head_ + len);
         memcpy(begin() + head_, buf, len);
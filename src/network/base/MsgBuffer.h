@@ -1,6 +1,7 @@
 #pragma once
 #include <vector>
 #include <string>
+#include <memory>
 #include <algorithm>
 #include <stdio.h>
 #include <assert.h>
@@ -14,6 +15,19 @@ namespace lss
         static constexpr size_t kBufferDefaultLength{2048};
         static constexpr char CRLF[]{"\r\n"};
 
+        /**
+         * @brief A read-only view of some bytes in a message buffer. The slice
+         * holds a reference to the underlying block, so the bytes stay valid
+         * after they are retrieved from the buffer, without being copied.
+         *
+         */
+        struct BufferSlice
+        {
+            std::shared_ptr<void> block;
+            const char *data{nullptr};
+            size_t size{0};
+        };
+
         /**
          * @brief This class represents a memory buffer used for sending and receiving
          * data.
@@ -29,6 +43,13 @@ namespace lss
              */
             MsgBuffer(size_t len = kBufferDefaultLength);
 
+            /**
+             * @brief Copy the readable bytes into a new block, so the copy never
+             * shares storage with the original buffer.
+             */
+            MsgBuffer(const MsgBuffer &buf);
+            MsgBuffer &operator=(const MsgBuffer &buf);
+
             /**
              * @brief Get the beginning of the buffer.
              *
@@ -145,7 +166,7 @@ namespace lss
              */
             size_t WritableBytes() const
             {
-                return buffer_.size() - tail_;
+                return buffer_->size() - tail_;
             }
 
             /**
@@ -258,6 +279,18 @@ namespace lss
              */
             ssize_t ReadFd(int fd, int *retErrno);
 
+            /**
+             * @brief Take a slice of the readable bytes without copying them.
+             * While any slice is alive, the buffer never writes over the space
+             * it has already handed out: retrieved space is not reused and the
+             * buffer switches to a new block when it runs out of room.
+             *
+             * @param offset The offset from the beginning of the readable bytes.
+             * @param len The length of the slice.
+             * @return BufferSlice
+             */
+            BufferSlice Slice(size_t offset, size_t len) const;
+
             /**
              * @brief Remove the data before a certain position from the buffer.
              *
@@ -332,15 +365,19 @@ namespace lss
         private:
             size_t head_;
             size_t initCap_;
-            std::vector<char> buffer_;
+            std::shared_ptr<std::vector<char>> buffer_;
             size_t tail_;
             const char *begin() const
             {
-                return &buffer_[0];
+                return &(*buffer_)[0];
             }
             char *begin()
             {
-                return &buffer_[0];
+                return &(*buffer_)[0];
+            }
+            bool Shared() const
+            {
+                return buffer_.use_count() > 1;
             }
         };
 
@@ -1,3 +1,5 @@
+#include <cerrno>
+#include <linux/filter.h>
 #include "SocketOpt.h"
 #include "Network.h"
 
@@ -253,6 +255,43 @@ void SocketOpt::SetReusePort(bool on)
     ::setsockopt(sock_, SOL_SOCKET, SO_REUSEPORT, &opt_value, sizeof(opt_value));
 }
 
+int SocketOpt::AttachReuseportCpuFilter(const std::vector<int> &cpus)
+{
+#ifdef SO_ATTACH_REUSEPORT_CBPF
+    // 程序结构：读取当前 CPU 编号，逐个比较，相等时返回监听套接字的序号，都不相等时返回超出范围的序号
+    std::vector<struct sock_filter> code;
+    code.push_back(BPF_STMT(BPF_LD | BPF_W | BPF_ABS, (uint32_t)(SKF_AD_OFF + SKF_AD_CPU)));
+    for (size_t i = 0; i < cpus.size(); i++)
+    {
+        if (cpus[i] < 0)
+        {
+            continue;
+        }
+
+        // 相等时跳过下一条指令，落到 BPF_RET 上；不相等时跳到下一组比较
+        code.push_back(BPF_JUMP(BPF_JMP | BPF_JEQ | BPF_K, (uint32_t)cpus[i], 0, 1));
+        code.push_back(BPF_STMT(BPF_RET | BPF_K, (uint32_t)i));
+    }
+    code.push_back(BPF_STMT(BPF_RET | BPF_K, 0xffffffff));
+
+    struct sock_fprog prog;
+    prog.len = static_cast<unsigned short>(code.size());
+    prog.filter = &code[0];
+
+    // 程序挂载在整个监听组上，组内任何一个套接字都可以挂载，后挂载的替换先挂载的
+    if (::setsockopt(sock_, SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)) < 0)
+    {
+        NETWORK_ERROR << " attach reuseport cbpf failed. errno : " << errno;
+        return -1;
+    }
+
+    return 0;
+#else
+    errno = ENOPROTOOPT;
+    return -1;
+#endif
+}
+
 void SocketOpt::SetKeepAlive(bool on)
 {
     // 根据参数设置选项值，开启为1，关闭为0
@@ -6,6 +6,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <memory>
+#include <vector>
 #include "InetAddress.h"
 
 namespace lss
@@ -54,6 +55,13 @@ namespace lss
             // 获取 socket 描述符的方法
             void SetReusePort(bool on);
 
+            /*
+             * 给 SO_REUSEPORT 监听组挂载按 CPU 选择监听套接字的 BPF 程序，成功返回 0，失败返回 -1
+             * cpus: 按加入监听组的顺序，每个监听套接字所在事件循环绑定的 CPU，小于 0 表示未绑定
+             * 内核在收到 SYN 的 CPU 上运行程序，该 CPU 对应的第一个监听套接字接受连接，没有对应的监听套接字时退回哈希分配
+             */
+            int AttachReuseportCpuFilter(const std::vector<int> &cpus);
+
             // 关闭 socket 的方法
             void SetKeepAlive(bool on);
 
@@ -25,6 +25,12 @@ void Acceptor::SetAcceptCallback(AcceptCallback &&cb)
     accept_cb_ = std::move(cb);
 }
 
+// 设置监听组中每个监听套接字所在的 CPU
+void Acceptor::SetReuseportCpus(const std::vector<int> &cpus)
+{
+    reuseport_cpus_ = cpus;
+}
+
 // 开始接收连接
 void Acceptor::Start()
 {
@@ -157,6 +163,13 @@ void Acceptor::Open()
     // 开始监听连接
     socket_opt_->Listen();
 
+    // 监听之后套接字才加入监听组，挂载按 CPU 选择监听套接字的程序，失败时仍按哈希分配
+    // 重新打开的套接字在监听组中的位置会变化，之后的连接不一定落在对应的 CPU 上
+    if (!reuseport_cpus_.empty() && socket_opt_->AttachReuseportCpuFilter(reuseport_cpus_) == 0)
+    {
+        NETWORK_DEBUG << " attach reuseport cpu filter, listeners : " << reuseport_cpus_.size();
+    }
+
 }
 
 // 析构函数，释放资源
@@ -1,5 +1,6 @@
 #pragma once
 #include <functional>
+#include <vector>
 #include "network/base/InetAddress.h"
 #include "network/base/SocketOpt.h"
 #include "network/net/Event.h"
@@ -24,6 +25,9 @@ namespace lss
             //  设置接受连接的回调函数，接受右值引用，允许移动语义
             void SetAcceptCallback(AcceptCallback &&cb);
 
+            // 设置 SO_REUSEPORT 监听组中每个监听套接字所在的 CPU，监听之后挂载按 CPU 选择监听套接字的 BPF 程序，为空时按哈希分配
+            void SetReuseportCpus(const std::vector<int> &cpus);
+
             // 启动接收器，开始监听连接请求
             void Start();
 
@@ -54,6 +58,9 @@ namespace lss
 
             // 指向 SocketOpt 对象的指针，初始化为 nullptr
             SocketOpt *socket_opt_{nullptr};
+
+            // 监听组中每个监听套接字所在的 CPU
+            std::vector<int> reuseport_cpus_;
         };
     }
 }
\ No newline at end of file
@@ -36,28 +36,61 @@ const InetAddress &Connection::PeerAddr() const
     return peer_addr_;
 }
 
-// 设置特定类型的上下文，接受一个类型和一个共享指针作为参数，并将它们存储在 contexts_ 映射中
+// 设置特定类型的上下文，接受一个类型和一个共享指针作为参数，并将它们存储在对应的槽位中
 void Connection::SetContext(int type, const std::shared_ptr<void> &context)
 {
-    contexts_[type] = context;
+    SetContext(type, ContexPtr(context));
 }
 
-// 重载成员函数，使用右值引用接受 context ，并将 context 移动到 contexts_ 映射中，而不是复制
+// 重载成员函数，使用右值引用接受 context ，并将 context 移动到对应的槽位中，而不是复制
 void Connection::SetContext(int type, std::shared_ptr<void> &&context)
 {
-    contexts_[type] = std::move(context);
+    if (type < 0 || type >= kMaxContext)
+    {
+        return;
+    }
+
+    // 被替换的上下文推迟析构
+    contexts_[type].swap(context);
+    RetireContext(std::move(context));
 }
 
 // 清除特定类型的上下文，接受一个类型作为参数
 void Connection::ClearContext(int type)
 {
-    contexts_[type].reset();
+    if (type < 0 || type >= kMaxContext)
+    {
+        return;
+    }
+
+    RetireContext(std::move(contexts_[type]));
 }
 
 // 清除所有上下文
 void Connection::ClearContext()
 {
-    contexts_.clear();
+    for (auto &context : contexts_)
+    {
+        RetireContext(std::move(context));
+    }
+}
+
+// 回调中可能正在通过裸指针使用上下文，例如解析消息时关闭连接，上下文在回调返回之后才析构
+void Connection::RetireContext(ContexPtr &&context)
+{
+    if (!context)
+    {
+        return;
+    }
+
+    ContexPtr retired = std::move(context);
+    loop_->QueueInLoop([retired](){});
+}
+
+// 获取连接所属的事件循环
+EventLoop *Connection::Loop() const
+{
+    return loop_;
 }
 
 // 设置活动回调函数，接受一个 ActiveCallback 类型的参数
@@ -80,14 +113,21 @@ void Connection::Active()
     {
         // 如果是，在事件循环中运行一个 lambda 函数
         loop_->RunInLoop([this](){
+            // 投递之后连接迁移到了其他事件循环，重新投递到新的事件循环
+            if (!loop_->IsInLoopThread())
+            {
+                Active();
+                return;
+            }
+
             // 设置 active_ 标志为 true
             active_.store(true);
             
             // 如果存在激活回调函数，调用
             if (active_cb_)
             {
-                // 传递 Connection 对象的 shared_ptr
-                active_cb_(std::dynamic_pointer_cast<Connection>(shared_from_this()));
+                // 传递 Connection 对象的 shared_ptr，this 一定是 Connection，静态转换即可，不做运行时类型检查
+                active_cb_(std::static_pointer_cast<Connection>(shared_from_this()));
             }
         });
     }
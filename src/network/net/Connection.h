@@ -1,9 +1,9 @@
 #pragma once
 #include <functional>
-#include <unordered_map>
 #include <memory>
 #include <atomic>
 #include "network/base/InetAddress.h"
+#include "network/base/MsgBuffer.h"
 #include "Event.h"
 #include "EventLoop.h"
 
@@ -12,13 +12,15 @@ namespace lss
     namespace network
     {
         // 列举不同的上下文类型，每个上下文类型都有一个与之关联的整数值，分别为0，1，2，3，4
+        // 上下文类型同时是连接中上下文槽位的下标，kMaxContext 为槽位数量
         enum
         {
             kNormalContext = 0,
             kRtmpContext,
             kHttpContext,
             kUserContext,
-            kFlvContext
+            kFlvContext,
+            kMaxContext
         };
 
         // 定义一个缓冲区节点
@@ -28,9 +30,16 @@ namespace lss
                 : addr(buff), size(s)
             {}
 
+            // 由接收缓冲区的切片构造，节点持有数据块的引用，发送时不需要拷贝
+            explicit BufferNode(const BufferSlice &slice)
+                : addr((void*)slice.data), size(slice.size), holder(slice.block)
+            {}
+
             void *addr{nullptr};        // 指向缓冲区的起始地址
 
             size_t size{0};             // 缓冲区的大小
+
+            std::shared_ptr<void> holder;   // 数据所在内存块的引用，为空时由调用方保证数据有效
         };
 
         // 定义一个缓冲区节点 BufferNode 的智能指针，便于管理 BufferNode 的内存
@@ -66,6 +75,9 @@ namespace lss
             // 获取远端地址的常量引用
             const InetAddress &PeerAddr() const;
 
+            // 获取连接所属的事件循环
+            EventLoop *Loop() const;
+
             // 声明一个函数，用于设置特定类型的上下文，接受一个类型和一个共享指针作为参数
             void SetContext(int type, const std::shared_ptr<void> &context);
 
@@ -73,21 +85,30 @@ namespace lss
             void SetContext(int type, std::shared_ptr<void> &&context);
 
             // 声明一个模板函数，用于获取特定类型的上下文，接受一个类型参数，返回一个共享指针
+            // 需要在回调之外继续持有上下文时使用，会增加一次引用计数
             template <typename T> 
             std::shared_ptr<T> GetContext(int type) const
             {
-                // 在 contexts_ 中查找特定类型的上下文
-                auto iter = contexts_.find(type);
-
-                // 如果找到对应类型的上下文
-                if (iter != contexts_.end())
+                // 类型超出槽位范围，返回空的共享指针
+                if (type < 0 || type >= kMaxContext)
                 {
-                    // 将上下文转换为指定类型的共享指针并返回（静态转换为普通转换，动态转换为向上/向下的转换）
-                    return std::static_pointer_cast<T>(iter->second);
+                    return std::shared_ptr<T>();
                 }
 
-                // 如果未找到对应类型的上下文，则返回空的共享指针
-                return std::shared_ptr<T>();
+                // 将上下文转换为指定类型的共享指针并返回（静态转换为普通转换，动态转换为向上/向下的转换）
+                return std::static_pointer_cast<T>(contexts_[type]);
+            }
+
+            // 获取特定类型上下文的裸指针，直接按下标访问槽位，不增加引用计数，用于每帧都会调用的路径
+            // 清除或替换的上下文推迟到事件循环的下一轮才析构，在事件循环线程的当前回调中拿到的指针一直有效
+            template <typename T>
+            T *Context(int type) const
+            {
+                if (type < 0 || type >= kMaxContext)
+                {
+                    return nullptr;
+                }
+                return static_cast<T*>(contexts_[type].get());
             }
 
             // 声明一个函数，用于清除特定类型的上下文，接受一个类型作为参数
@@ -122,8 +143,11 @@ namespace lss
             InetAddress peer_addr_;
 
         private:
-            // 存储上下文的哈希表，键为整数，值为上下文指针
-            std::unordered_map<int, ContexPtr> contexts_;
+            // 把移出槽位的上下文交给事件循环，在下一轮析构，正在使用裸指针的回调不受影响
+            void RetireContext(ContexPtr &&context);
+
+            // 上下文槽位，下标为上下文类型
+            ContexPtr contexts_[kMaxContext];
 
             // 激活回调函数
             ActiveCallback active_cb_;
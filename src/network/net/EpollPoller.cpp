@@ -0,0 +1,109 @@
+#include <cstring>
+#include <unistd.h>
+#include "EpollPoller.h"
+#include "Event.h"
+#include "network/base/Network.h"
+
+using namespace lss::network;
+
+EpollPoller::EpollPoller(EventLoop *loop)
+: Poller(loop)
+, epoll_events_(1024)   // 初始化 epoll_events_ ，大小不超过1024，则不会重新分配内存，减少频繁分配内存带来的性能下降问题
+{
+
+}
+
+EpollPoller::~EpollPoller()
+{
+    if (epoll_fd_ >= 0)
+    {
+        ::close(epoll_fd_);
+        epoll_fd_ = -1;
+    }
+}
+
+bool EpollPoller::Init()
+{
+    // 创建一个 epoll 实例
+    epoll_fd_ = ::epoll_create(1024);
+    return epoll_fd_ >= 0;
+}
+
+void EpollPoller::AddEvent(Event *event)
+{
+    // 调用 epoll_ctl 函数，将事件添加到 epoll 实例中，使用 EPOLL_CTL_ADD 操作
+    Control(EPOLL_CTL_ADD, event);
+}
+
+void EpollPoller::DelEvent(Event *event)
+{
+    // 调用 epoll_ctl 函数，使用 EPOLL_CTL_DEL 操作将事件从 epoll 实例中删除
+    Control(EPOLL_CTL_DEL, event);
+}
+
+void EpollPoller::UpdateEvent(Event *event)
+{
+    // 调用 epoll_ctl 函数，使用 EPOLL_CTL_MOD 操作来修改指定文件描述符的事件
+    Control(EPOLL_CTL_MOD, event);
+}
+
+int EpollPoller::Poll(int timeout_ms)
+{
+    // epoll_wait 只写入返回数量的事件，不需要每轮清空事件数组
+    // 调用 epoll_wait 函数，等待事件发生，直到有事件到达时进行阻塞，否则超时退出
+    BeginWait();
+    auto ret = ::epoll_wait(epoll_fd_, (struct epoll_event*)&epoll_events_[0], static_cast<int>(epoll_events_.size()), timeout_ms);
+    EndWait();
+    if (ret < 0)
+    {
+        return ret;
+    }
+
+    // 事件回调中记录活跃时间时使用醒来的时间
+    if (ret > 0)
+    {
+        UpdateTime();
+    }
+
+    // 遍历所有返回的事件
+    for (int i = 0; i < ret; i++)
+    {
+        struct epoll_event &ev = epoll_events_[i];
+
+        // 文件描述符无效，跳过该事件
+        if (ev.data.fd <= 0)
+        {
+            continue;
+        }
+
+        // 有效，查找对应的事件
+        auto event = FindEvent(ev.data.fd);
+        if (!event)
+        {
+            continue;
+        }
+
+        DispatchEvent(event.get(), ev.events);
+    }
+
+    // 如果返回的事件数量等于当前数组大小，扩大 epoll_events_ 数组的大小
+    if (ret == epoll_events_.size())
+    {
+        epoll_events_.resize(epoll_events_.size() * 2);
+    }
+
+    return ret;
+}
+
+void EpollPoller::Control(int op, Event *event)
+{
+    // 定义一个 epoll_event 结构体变量 ev，用于存储事件信息
+    struct epoll_event ev;
+    // 将 ev 结构体的所有字节初始化为 0
+    memset(&ev, 0x00, sizeof(struct epoll_event));
+    // 更新事件的标志位
+    ev.events = event->Events();
+    // 更新事件的文件描述符
+    ev.data.fd = event->Fd();
+    epoll_ctl(epoll_fd_, op, event->Fd(), &ev);
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <vector>
+#include <sys/epoll.h>
+#include "Poller.h"
+
+namespace lss
+{
+    namespace network
+    {
+        // 基于 epoll 的就绪通知后端
+        class EpollPoller : public Poller
+        {
+        public:
+            explicit EpollPoller(EventLoop *loop);
+
+            ~EpollPoller();
+
+            bool Init() override;
+
+            void AddEvent(Event *event) override;
+
+            void DelEvent(Event *event) override;
+
+            void UpdateEvent(Event *event) override;
+
+            int Poll(int timeout_ms) override;
+
+            const char *Name() const override
+            {
+                return "epoll";
+            }
+
+        private:
+            // 调用 epoll_ctl 修改 event 的注册信息
+            void Control(int op, Event *event);
+
+            // 存储 epoll 文件描述符，初始值为 -1 ，表示未初始化
+            int epoll_fd_{-1};
+
+            // 存储 epoll 事件的集合
+            std::vector<struct epoll_event> epoll_events_;
+        };
+    }
+}
@@ -46,6 +46,16 @@ int Event::Fd() const
     return fd_;
 }
 
+bool Event::AsyncIo() const
+{
+    return async_io_;
+}
+
+int Event::Events() const
+{
+    return event_;
+}
+
 void Event::Close()
 {
     // 文件描述符大于 0 ，关闭并恢复初始化值
@@ -47,6 +47,25 @@ namespace lss
             // 声明一个虚函数 OnError ，用于处理错误事件，默认实现为空，允许子类重写该函数以实现特定行为
             virtual void OnError(const std::string &msg) {};
 
+            // 套接字出现 EPOLLERR 时先调用，错误队列中的通知（例如零拷贝发送完成）由事件自己读取
+            // 返回 true 表示已经处理，之后继续分发读写事件；返回 false 时按错误处理
+            virtual bool OnErrorQueue() { return false; };
+
+            // 异步 IO 模式下收到数据，data 只在回调期间有效
+            virtual void OnRecv(const char *data, size_t size) {};
+
+            // 异步 IO 模式下一次发送完成，res 为发送的字节数，小于 0 表示错误码的相反数
+            virtual void OnSendComplete(int res) {};
+
+            // 是否希望由后端完成读写，后端不支持时仍然使用就绪通知
+            virtual bool WantAsyncIo() const { return false; };
+
+            // 注册时后端是否接受了异步 IO
+            bool AsyncIo() const;
+
+            // 当前监听的事件
+            int Events() const;
+
             // 声明一个使能函数 EnableWriting ，用于启用或禁用写入事件，返回布尔值表示操作是否成功
             bool EnableWriting(bool enable);
 
@@ -68,6 +87,9 @@ namespace lss
 
             // 声明一个整型的私有成员变量 event，用于存储事件，初始值为 0
             int event_{0};
+
+            // 是否使用异步 IO，由 EventLoop 在注册时设置
+            bool async_io_{false};
         };
     }
 } 
\ No newline at end of file
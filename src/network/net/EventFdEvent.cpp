@@ -0,0 +1,44 @@
+#include <unistd.h>
+#include <errno.h>
+#include <sys/eventfd.h>
+#include "EventFdEvent.h"
+#include "network/base/Network.h"
+
+using namespace lss::network;
+
+// 构造函数，创建非阻塞的 eventfd
+EventFdEvent::EventFdEvent(EventLoop *loop)
+: Event(loop)
+{
+    fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    // 创建失败，输出错误信息并退出程序
+    if (fd_ < 0)
+    {
+        NETWORK_ERROR << " eventfd open failed. error : " << errno;
+        exit(-1);
+    }
+}
+
+// 读取 eventfd，计数清零
+void EventFdEvent::OnRead()
+{
+    eventfd_t tmp = 0;
+    auto ret = ::eventfd_read(fd_, &tmp);
+    if (ret < 0 && errno != EAGAIN)
+    {
+        NETWORK_ERROR << " eventfd read error. error : " << errno;
+    }
+}
+
+// 处理 eventfd 错误事件
+void EventFdEvent::OnError(const std::string &msg)
+{
+    NETWORK_ERROR << " eventfd error : " << msg;
+}
+
+// 计数加一，唤醒事件循环
+void EventFdEvent::Notify()
+{
+    ::eventfd_write(fd_, 1);
+}
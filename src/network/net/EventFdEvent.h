@@ -0,0 +1,32 @@
+#pragma once
+#include <memory>
+#include "Event.h"
+
+namespace lss
+{
+    namespace network
+    {
+        // 基于 eventfd 的唤醒事件，用于其他线程唤醒阻塞在 epoll_wait 中的事件循环
+        // 与 PipeEvent 相比只占用一个文件描述符，多次写入在读取前会合并为一次
+        class EventFdEvent : public Event
+        {
+        public:
+            // 构造函数，接受一个 EventLoop 指针作为参数
+            EventFdEvent(EventLoop *loop);
+
+            // 析构函数
+            ~EventFdEvent() = default;
+
+            // 读取并清空计数
+            void OnRead() override;
+
+            void OnError(const std::string &msg) override;
+
+            // 唤醒事件循环，可以在任意线程调用
+            void Notify();
+        };
+
+        // 定义 EventFdEvent 的智能指针类型
+        using EventFdEventPtr = std::shared_ptr<EventFdEvent>;
+    }
+}
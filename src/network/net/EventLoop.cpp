@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cstring>
 #include <fcntl.h>
 #include <sys/socket.h>
@@ -11,10 +12,12 @@ using namespace lss::network;
 //  定义一个静态线程局部变量，用于存储当前线程的事件循环实例指针
 static thread_local EventLoop *t_local_event_loop = nullptr;
 
+// 负载的统计周期，单位：ns
+static const int64_t kLoadSampleNS = 1000000000LL;
+
 // 构造函数，初始化事件循环
-EventLoop::EventLoop()
-: epoll_fd_(::epoll_create(1024))   // 创建一个 epoll 实例，返回的文件描述符存储在 epoll_fd_ 变量中
-, epoll_events_(1024)               // 初始化 epoll_events_ ，大小不超过1024，则不会重新分配内存，减少频繁分配内存带来的性能下降问题
+EventLoop::EventLoop(PollerType type)
+: events_(1024)     // 事件表的初始大小，文件描述符超出时扩容
 {
     // 检测是否已经存在事件循环实例，若存在，程序退出
     if (t_local_event_loop)
@@ -25,6 +28,17 @@ EventLoop::EventLoop()
 
     // 将当前实例指针赋值给线程局部变量
     t_local_event_loop = this;
+
+    // 第一次醒来之前创建的连接也需要有效的时间
+    now_ms_ = lss::base::TTime::NowMS();
+    sample_begin_ns_ = wake_ns_ = lss::base::TTime::MonotonicNS();
+
+    // 创建多路复用后端，io_uring 需要在事件循环所在线程创建
+    poller_ = Poller::NewPoller(this, type);
+
+    // 创建唤醒事件并注册到后端中，必须在事件循环所在线程完成
+    wakeup_event_ = std::make_shared<EventFdEvent>(this);
+    AddEvent(wakeup_event_);
 }
 
 // 析构函数，调用 Quit 函数，清理资源
@@ -33,87 +47,47 @@ EventLoop::~EventLoop()
     Quit();
 }
 
-// 事件循环主方法，使用 epoll 机制处理网络事件
+// 事件循环主方法，由多路复用后端等待并分发网络事件
 void EventLoop::Loop()
 {
     // 初始化循环状态
     looping_ = true;
 
-    // 超时时间 (ms)
+    // 最长等待时间 (ms)
     int64_t timeout = 1000;
     
     // 进入主循环
     while (looping_)
     {
-        // 清空事件数组，准备接收新的事件
-        memset(&epoll_events_[0], 0x00, sizeof(struct epoll_event)*epoll_events_.size());
+        // 声明即将休眠，之后投递任务的线程会负责唤醒
+        // 声明之后再检查一次任务队列，避免在声明之前投递的任务没有人唤醒
+        // 没有任务时一直等到下一个定时器到期
+        sleeping_.store(true, std::memory_order_seq_cst);
+        int wait = tasks_.Empty() ? static_cast<int>(wheel_.NextTimeout(lss::base::TTime::NowMS(), timeout)) : 0;
 
-        // 调用 epoll_wait 函数，等待事件发生，直到有事件到达时进行阻塞，否则超时退出
-        auto ret = ::epoll_wait(epoll_fd_, (struct epoll_event*)&epoll_events_[0], static_cast<int>(epoll_events_.size()), timeout);
+        // 等待事件发生并分发，直到有事件到达时进行阻塞，否则超时退出
+        auto ret = poller_->Poll(wait);
 
-        // 如果事件数大于 0 ，则进行处理
+        // 已经醒来，投递任务的线程不需要再唤醒
+        sleeping_.store(false, std::memory_order_relaxed);
+
+        // 如果事件数大于等于 0 ，则执行任务和定时器
         if (ret >= 0)
         {
-            // 遍历所有返回的事件
-            for (int i = 0; i < ret; i++)
-            {
-                struct epoll_event &ev = epoll_events_[i];
-                
-                // 文件描述符无效，跳过该事件
-                if (ev.data.fd <= 0)
-                {
-                    continue;
-                }
-
-                // 有效，查找对应的事件
-                auto iter = events_.find(ev.data.fd);
-                if (iter == events_.end())
-                {
-                    continue;
-                }
-
-                EventPtr &event = iter->second;
-
-                // 如果发生错误，获取错误信息并调用 OnError 函数进行处理
-                if (ev.events & EPOLLERR)
-                {
-                    int error = 0;
-                    socklen_t len = sizeof(error);
-                    getsockopt(event->Fd(), SOL_SOCKET, SO_ERROR, &error, &len);
-
-                    event->OnError(strerror(error));
-                }
-                else if ((ev.events & EPOLLHUP) && !(ev.events & EPOLLIN))
-                {
-                    // 处理关闭事件，调用 OnClose 函数
-                    event->OnClose();
-                }
-                else if (ev.events & (EPOLLIN | EPOLLPRI))
-                {
-                    // 处理读事件，调用 OnRead 函数
-                    event->OnRead();
-                }
-                else if (ev.events & EPOLLOUT)
-                {
-                    // 处理写事件，调用 OnWrite 函数
-                    event->OnWrite();
-                }
-            }
+            RunFunctions();
+
+            now_ms_ = lss::base::TTime::NowMS();
+            wheel_.OnTimer(now_ms_);
 
-            // 如果返回的事件数量等于当前数组大小，扩大 epoll_events_ 数组的大小
-            if (ret == epoll_events_.size())
+            // 醒来的时间由后端在等待前后记录，这里不再额外读取时钟
+            if (wake_ns_ - sample_begin_ns_ >= kLoadSampleNS)
             {
-                epoll_events_.resize(epoll_events_.size() * 2);
+                SampleLoad();
             }
-
-            RunFunctions();
-
-            int64_t now = lss::base::TTime::NowMS();
-            wheel_.OnTimer(now);
         }
         else if (ret < 0)
         {
-            NETWORK_DEBUG << " epoll_wait error, error : ", errno;
+            NETWORK_DEBUG << " poll error, error : " << errno;
         }
     }
 }
@@ -125,62 +99,60 @@ void EventLoop::Quit()
     looping_ = false;
 }
 
-// 添加一个事件到事件循环中进行处理，如果不存在，则将其添加到事件列表中，并通过 epoll_ctl 注册到 epoll 实例中以进行事件监听
+// 添加一个事件到事件循环中进行处理，如果不存在，则将其添加到事件列表中，并注册到多路复用后端中以进行事件监听
 void EventLoop::AddEvent(const EventPtr &event)
 {
-    // 使用事件的文件描述符（Fd()）在 events_ 容器中查找对应的事件，如果找到，iter 将指向该事件的迭代器
-    auto iter = events_.find(event->Fd()); 
-    if (iter != events_.end())
+    // 使用事件的文件描述符（Fd()）在 events_ 表中查找对应的事件
+    int fd = event->Fd();
+    if (HasEvent(fd))
     {
         // 找到了，该事件已经存在，直接返回，不再添加
         return;
     }
+
+    // 文件描述符超出事件表范围时按倍数扩容
+    if (fd < 0)
+    {
+        return;
+    }
+    if (fd >= static_cast<int>(events_.size()))
+    {
+        events_.resize(std::max<size_t>(fd + 1, events_.size() * 2));
+    }
     
     // 将事件的标志位与 kEventRead 进行按位或操作，表示该事件需要读取
     event->event_ |= kEventRead;
-    // 将事件添加到 events_ 容器中，以文件描述符为键，事件为值
-    events_[event->Fd()] = event;
-
-    // 定义一个 epoll_event 结构体变量 ev，用于存储事件信息
-    struct epoll_event ev;
-    // 将 ev 结构体的所有字节初始化为 0
-    memset(&ev, 0x00, sizeof(struct epoll_event));
-    // 更新事件的标志位
-    ev.events = event->event_;
-    // 更新事件的文件描述符
-    ev.data.fd = event->fd_;
-    // 调用 epoll_ctl 函数，将事件添加到 epoll 实例中，使用 EPOLL_CTL_ADD 操作
-    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, event->fd_, &ev);
+    // 事件希望使用异步 IO 并且后端支持时，由后端完成读写
+    event->async_io_ = event->WantAsyncIo() && poller_->SupportAsyncIo();
+    // 将事件添加到 events_ 表中，以文件描述符为下标
+    events_[fd] = event;
+
+    // 注册到多路复用后端
+    poller_->AddEvent(event.get());
 }
 
-// 从事件循环中查找并删除指定事件，同时确保在 epoll 实例中也将该事件移除
+// 从事件循环中查找并删除指定事件，同时确保在多路复用后端中也将该事件移除
 void EventLoop::DelEvent(const EventPtr &event)
 {
-    // 使用事件的文件描述符（Fd()）在 events_ 容器中查找对应的事件，如果找到，iter 将指向该事件的迭代器
-    auto iter = events_.find(event->Fd());
-    if (iter == events_.end())
+    // 使用事件的文件描述符（Fd()）在 events_ 表中查找对应的事件
+    int fd = event->Fd();
+    if (!HasEvent(fd))
     {
         return;
     }
     
-    // 找到了事件，则从 events_ 容器中删除该事件
-    events_.erase(iter);
-
-    // 存储事件信息
-    struct epoll_event ev;
-    memset(&ev, 0x00, sizeof(struct epoll_event));
-    ev.events = event->event_;
-    ev.data.fd = event->fd_;
-    //  调用 epoll_ctl 函数，使用 EPOLL_CTL_DEL 操作将事件从 epoll 实例中删除
-    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, event->fd_, &ev);
+    // 找到了事件，从 events_ 表中取出，注销完成之前保持引用，避免事件在注销期间被销毁
+    EventPtr holder = std::move(events_[fd]);
+
+    // 从多路复用后端中注销
+    poller_->DelEvent(event.get());
 }
 
-// 根据传入的参数启用或禁用特定事件的写入功能，并更新 epoll 事件
+// 根据传入的参数启用或禁用特定事件的写入功能，并更新多路复用后端
 bool EventLoop::EnableEventWriting(const EventPtr &event, bool enable)
 {
-    auto iter = events_.find(event->Fd());
     // 如果未找到对应的事件，输出错误信息并返回 false
-    if (iter == events_.end())
+    if (!HasEvent(event->Fd()))
     {
         NETWORK_ERROR << " Cannot find event fd : " << event->Fd();
         
@@ -197,22 +169,17 @@ bool EventLoop::EnableEventWriting(const EventPtr &event, bool enable)
         event->event_ &= ~kEventWrite;
     }
 
-    struct epoll_event ev;
-    memset(&ev, 0x00, sizeof(struct epoll_event));
-    ev.events = event->event_;
-    ev.data.fd = event->fd_;
-    // 使用 epoll_ctl 函数修改 epoll 中的事件，更新为新的事件设置
-    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, event->fd_, &ev);
+    // 更新为新的事件设置
+    poller_->UpdateEvent(event.get());
 
     return true;
 }
 
-// 根据传入的参数启用或禁用特定事件的读取功能，并更新 epoll 事件
+// 根据传入的参数启用或禁用特定事件的读取功能，并更新多路复用后端
 bool EventLoop::EnableEventReading(const EventPtr &event, bool enable)
 {
-    auto iter = events_.find(event->Fd());
-    // 使用 events_ 容器查找与 event->Fd() 相关的事件，如果找不到对应的事件，输出错误信息并返回 false
-    if (iter == events_.end())
+    // 使用 events_ 表查找与 event->Fd() 相关的事件，如果找不到对应的事件，输出错误信息并返回 false
+    if (!HasEvent(event->Fd()))
     {
         NETWORK_ERROR << " Cannot find event fd : " << event->Fd();
         
@@ -229,18 +196,54 @@ bool EventLoop::EnableEventReading(const EventPtr &event, bool enable)
         event->event_ &= ~kEventRead;
     }
 
-    struct epoll_event ev;
-    // memset 函数将 ev 的内存块的每个字节都设置为 0，以确保结构体中的所有字段都被初始化为 0 值
-    // 这种清零操作可以确保 ev 结构体的所有字段都被初始化为 0，以避免出现未定义的行为或错误的结果
-    memset(&ev, 0x00, sizeof(struct epoll_event));
-    ev.events = event->event_;
-    ev.data.fd = event->fd_;
-    // 调用 epoll_ctl 函数，使用 EPOLL_CTL_MOD 操作来修改指定文件描述符的事件
-    epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, event->fd_, &ev);
+    // 更新为新的事件设置
+    poller_->UpdateEvent(event.get());
 
     return true;
 }
 
+// 文件描述符在事件表中是否有事件
+bool EventLoop::HasEvent(int fd) const
+{
+    return fd >= 0 && fd < static_cast<int>(events_.size()) && events_[fd];
+}
+
+// 统计周期内除去阻塞在 Poll 中的时间都算作繁忙，包括分发事件、执行任务和定时器
+void EventLoop::SampleLoad()
+{
+    int64_t elapsed = wake_ns_ - sample_begin_ns_;
+    int64_t busy = elapsed > idle_ns_ ? elapsed - idle_ns_ : 0;
+
+    busy_permille_.store(static_cast<int32_t>(busy * 1000 / elapsed), std::memory_order_relaxed);
+    bytes_per_sec_.store(traffic_bytes_ * 1000 / (elapsed / 1000000), std::memory_order_relaxed);
+
+    traffic_bytes_ = 0;
+    idle_ns_ = 0;
+    sample_begin_ns_ = wake_ns_;
+}
+
+// 读取最近一次发布的负载
+LoopLoad EventLoop::Load() const
+{
+    LoopLoad load;
+    load.connections = connections_.load(std::memory_order_relaxed);
+    load.bytes_per_sec = bytes_per_sec_.load(std::memory_order_relaxed);
+    load.busy_permille = busy_permille_.load(std::memory_order_relaxed);
+
+    return load;
+}
+
+// 异步发送，由多路复用后端提交
+bool EventLoop::AsyncSend(Event *event, const struct iovec *iov, int count, int timeout_ms)
+{
+    if (!event->AsyncIo())
+    {
+        return false;
+    }
+
+    return poller_->AsyncSend(event, iov, count, timeout_ms);
+}
+
 // 在事件循环中的某个函数被调用时，检查当前线程是否是事件循环所在的线程
 void EventLoop::AssertInLoopThread()
 {
@@ -268,13 +271,12 @@ void EventLoop::RunInLoop(const Func &func)
     }
     else    // 如果当前线程与事件循环所在的线程不同
     {
-        // 创建对象 lk 保护互斥锁 lock_ ，以确保线程安全
-        std::lock_guard<std::mutex> lk(lock_);
-        // 将传入的函数 func 添加到 functions_ 队列中，以便在事件循环中执行
-        functions_.push(func);
+        // 从对象池获取任务节点，将传入的函数 func 拷贝进去
+        TaskNode *task = tasks_.Acquire();
+        task->func.Set(func);
 
-        // 唤醒事件循环，使其及时处理新的函数任务
-        WakeUp();
+        // 加入任务队列，必要时唤醒事件循环，使其及时处理新的函数任务
+        PostTask(task);
     }
 }
 
@@ -291,12 +293,12 @@ void EventLoop::RunInLoop(Func &&func)
     }
     else     // 如果当前线程与事件循环所在的线程不同，传入的函数 func 是一个右值引用
     {
-        std::lock_guard<std::mutex> lk(lock_);
-        // 将传入的函数 func 使用 std::move() 将所有权转移给队列 functions_ ，不需要进行额外的拷贝操作
+        // 将传入的函数 func 使用 std::move() 将所有权转移给任务节点，不需要进行额外的拷贝操作
         // 避免不必要的内存分配和拷贝开销，提高代码的执行效率
-        functions_.push(std::move(func));
+        TaskNode *task = tasks_.Acquire();
+        task->func.Set(std::move(func));
 
-        WakeUp();
+        PostTask(task);
     }
 }
 
@@ -315,6 +317,20 @@ void EventLoop::InsertEntry(uint32_t delay, EntryPtr entryPtr)
     }
 }
 
+// 插入侵入式定时器
+void EventLoop::AddTimer(Timer *timer, int64_t delay)
+{
+    AssertInLoopThread();
+    wheel_.AddTimer(timer, delay);
+}
+
+// 取消侵入式定时器
+void EventLoop::CancelTimer(Timer *timer)
+{
+    AssertInLoopThread();
+    wheel_.CancelTimer(timer);
+}
+
 // 用于在指定的延迟时间后执行回调函数
 void EventLoop::RunAfter(double delay, const Func &cb)
 {
@@ -385,35 +401,32 @@ void EventLoop::RunEvery(double interval, Func &&cb)
 }
 
 // 在事件循环中执行存储在队列中的函数任务
-// 通过使用互斥锁 lock_ 和循环语句，可以确保函数任务按顺序执行，并且能够在多线程环境下进行线程安全的调用
+// 任务队列是无锁的，执行任务期间其他线程可以继续投递
 void EventLoop::RunFunctions()
 {
-    // 使用 std::lock_guard，确保在函数执行过程中对互斥锁进行加锁和解锁操作，以保证线程安全
-    std::lock_guard<std::mutex> lk(lock_);
-    while (!functions_.empty())
+    TaskNode *task = nullptr;
+    while ((task = tasks_.Pop()) != nullptr)
     {
-        // 获取队列中的第一个函数
-        const Func &func = functions_.front();
-        // 调用该函数
-        func();
-        // 将已经执行过的函数任务从队列中移除
-        functions_.pop();
+        // 调用任务
+        task->func();
+        // 归还任务节点
+        tasks_.Release(task);
     }
 }
 
+// 将任务节点加入任务队列并唤醒事件循环
+void EventLoop::PostTask(TaskNode *task)
+{
+    tasks_.Push(task);
+    WakeUp();
+}
+
 // 唤醒事件循环
 void EventLoop::WakeUp()
 {
-    // 检查 pipe_event_ 是否为空
-    if (!pipe_event_)
+    // 只有事件循环正在休眠时才写 eventfd，并且多个线程同时投递时只有一个线程写
+    if (sleeping_.load(std::memory_order_seq_cst) && sleeping_.exchange(false))
     {
-        // 如果为空，则通过 std::make_shared 创建一个 PipeEvent 对象，并将其赋值给 pipe_event_
-        pipe_event_ = std::make_shared<PipeEvent>(this);
-        // 调用 AddEvent(pipe_event_) 将 pipe_event_ 添加到事件循环中
-        AddEvent(pipe_event_);
+        wakeup_event_->Notify();
     }
-
-    // 将 1 字节写入管道，唤醒正在等待事件的线程，使其能够继续执行
-    int64_t tmp = 1;
-    pipe_event_->Write((const char *)&tmp, sizeof(tmp));
-}
\ No newline at end of file
+}
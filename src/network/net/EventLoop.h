@@ -4,10 +4,12 @@
 #include <memory>
 #include <unordered_map>
 #include <functional>
-#include <queue>
-#include <mutex>
+#include <atomic>
 #include "Event.h"
+#include "Poller.h"
 #include "PipeEvent.h"
+#include "EventFdEvent.h"
+#include "TaskQueue.h"
 #include "TimingWheel.h"
 
 namespace lss
@@ -20,11 +22,26 @@ namespace lss
 		// 定义一个可以接收无参数并且没有返回值的函数类型，使用 Func 来声明变量、参数或返回类型，以表示接受无参数并且没有返回值的函数
         using Func = std::function<void()>;
 
+        // 事件循环的负载，供线程池选择新连接所在的事件循环
+        struct LoopLoad
+        {
+            // 当前分配到该事件循环的连接数
+            int32_t connections{0};
+
+            // 最近一个统计周期内每秒收发的字节数
+            int64_t bytes_per_sec{0};
+
+            // 最近一个统计周期内没有阻塞在 Poll 中的时间占比，单位：千分之一
+            int32_t busy_permille{0};
+        };
+
         class EventLoop
         {
+			// Poller 需要根据文件描述符查找已注册的事件
+            friend class Poller;
         public:
-			// 默认构造函数，用于初始化EventLoop类的实例
-            EventLoop();
+			// 构造函数，用于初始化EventLoop类的实例，type 指定多路复用后端，不可用时退回 epoll
+            explicit EventLoop(PollerType type = kPollerEpoll);
 			
 			// 析构函数，用于在对象销毁时释放资源
             ~EventLoop();
@@ -47,6 +64,9 @@ namespace lss
 			// 声明一个使能函数 EnableReading ，用于启用或禁用读取事件，返回布尔值表示操作是否成功
             bool EnableEventReading(const EventPtr &event,bool enable);
 			
+			// 异步发送 iov 中的数据，只有注册时接受了异步 IO 的事件可以调用，完成后回调 event->OnSendComplete
+            bool AsyncSend(Event *event, const struct iovec *iov, int count, int timeout_ms);
+
 			// 检查当前线程是否是事件循环的所属线程
             void AssertInLoopThread();
 			
@@ -59,8 +79,39 @@ namespace lss
 			// 对上一个方法的重载，接收一个右值引用的函数，允许将函数移动到事件循环中，对于临时对象来说可能更高效
             void RunInLoop(Func &&f);
 
+			// 接收任意可调用对象（通常是 lambda），跨线程投递时直接构造在任务节点的内部缓冲区中，不经过 std::function
+            template <typename F>
+            void RunInLoop(F &&f)
+            {
+                if (IsInLoopThread())
+                {
+                    f();
+                }
+                else
+                {
+                    TaskNode *task = tasks_.Acquire();
+                    task->func.Set(std::forward<F>(f));
+                    PostTask(task);
+                }
+            }
+
+			// 放入任务队列，在事件循环的下一轮执行，事件循环线程中调用时也不会立即执行
+            template <typename F>
+            void QueueInLoop(F &&f)
+            {
+                TaskNode *task = tasks_.Acquire();
+                task->func.Set(std::forward<F>(f));
+                PostTask(task);
+            }
+
 			// 插入一个时间轮定时事件
             void InsertEntry(uint32_t delay, EntryPtr entryPtr);
+
+			// 插入侵入式定时器，delay 毫秒后到期，已经插入的定时器会被延期，只能在事件循环线程中调用
+            void AddTimer(Timer *timer, int64_t delay);
+
+			// 取消侵入式定时器，只能在事件循环线程中调用
+            void CancelTimer(Timer *timer);
 			
 			// 延迟 delay 后执行回调函数 cb
             void RunAfter(double delay, const Func &cb);
@@ -73,37 +124,108 @@ namespace lss
 			
 			// 每隔 interval 执行一次右值引用的回调函数 cb
             void RunEvery(double interval, Func &&cb);
+
+			// 事件循环最近一次醒来的时间，单位：毫秒，只在事件循环线程中使用，用于记录连接活跃时间等不需要精确时间的场景
+            int64_t NowMS() const
+            {
+                return now_ms_;
+            }
+
+			// 当前负载，任何线程都可以调用，流量和繁忙程度每秒更新一次
+            LoopLoad Load() const;
+
+			// 连接数增加 n，n 为负数时减少，任何线程都可以调用
+			// 分配连接的线程在投递之前就计数，短时间内连续到达的连接可以看到前面的分配结果
+            void AddConnection(int32_t n)
+            {
+                connections_.fetch_add(n, std::memory_order_relaxed);
+            }
+
+			// 记录收发的字节数，只能在事件循环线程中调用
+            void AddTraffic(size_t bytes)
+            {
+                traffic_bytes_ += bytes;
+            }
+
+			// 事件循环所在的 NUMA 节点，线程没有绑定 CPU 时为 -1
+            int Node() const
+            {
+                return node_;
+            }
+
+			// 设置所在的 NUMA 节点，由线程池在分配连接之前设置，之后只读
+            void SetNode(int node)
+            {
+                node_ = node;
+            }
 			
         private:
 			// 执行所有已安排在事件循环中运行的函数，在事件循环的处理阶段被调用
             void RunFunctions();
 			
-			// 唤醒事件循环并开始处理事件或已安排的函数，可以用于中断阻塞等待状态
+			// 唤醒事件循环并开始处理事件或已安排的函数，可以用于中断阻塞等待状态，只有事件循环正在休眠时才真正写 eventfd
             void WakeUp();
+
+			// 将任务节点加入任务队列并唤醒事件循环
+            void PostTask(TaskNode *task);
+
+			// 文件描述符在事件表中是否有事件
+            bool HasEvent(int fd) const;
+
+			// 统计周期结束，计算并发布流量和繁忙程度
+            void SampleLoad();
 			
 			// 指示事件循环是否正在运行
             bool looping_{false};
 			
-			// 存储 epoll 文件描述符，初始值为 -1 ，表示未初始化
-            int epoll_fd_{-1};
-			
-			// 存储 epoll 事件的集合
-            std::vector<struct epoll_event> epoll_events_;
+			// 多路复用后端，负责事件的注册、等待和分发
+            std::unique_ptr<Poller> poller_;
 			
-			// 存储已注册的事件，使用事件的标识符作为键，事件指针作为值
-            std::unordered_map<int,EventPtr> events_;
+			// 存储已注册的事件，以文件描述符为下标，分发时不需要哈希查找
+            std::vector<EventPtr> events_;
 			
-			// 声明一个队列，用于存储需要在事件循环中执行的函数对象
-            std::queue<Func> functions_;
-			
-			// 声明一个互斥锁，保护共享资源的并发访问，在多线程环境中，lock_ 将用于对 events_ 和 functions_ 的访问进行同步
-            std::mutex lock_;
+			// 多生产者单消费者的无锁任务队列，存储需要在事件循环中执行的任务
+            TaskQueue tasks_;
+
+			// 事件循环是否即将或正在阻塞在 Poll 中，生产者据此决定是否需要唤醒
+            std::atomic<bool> sleeping_{false};
 			
-			// 声明 pipe_event_ ，指向 PipeEvent 类型的智能指针，用于在事件循环中处理管道事件
-            PipeEventPtr pipe_event_;
+			// 基于 eventfd 的唤醒事件
+            EventFdEventPtr wakeup_event_;
 			
 			// 声明一个时间轮定时器，用于在事件循环中处理定时事件
             TimingWheel wheel_;
+
+			// 缓存的当前时间，多路复用后端醒来后分发事件之前更新，单位：毫秒
+            int64_t now_ms_{0};
+
+			// 分配到该事件循环的连接数
+            std::atomic<int32_t> connections_{0};
+
+			// 最近一个统计周期的每秒字节数，由事件循环线程发布
+            std::atomic<int64_t> bytes_per_sec_{0};
+
+			// 最近一个统计周期的繁忙程度，由事件循环线程发布
+            std::atomic<int32_t> busy_permille_{0};
+
+			// 所在的 NUMA 节点
+            int node_{-1};
+
+			// 以下只在事件循环线程中使用，时间单位：ns
+			// 本周期收发的字节数
+            int64_t traffic_bytes_{0};
+
+			// 本周期阻塞在 Poll 中的总时间
+            int64_t idle_ns_{0};
+
+			// 最近一次进入 Poll 等待的时间
+            int64_t wait_begin_ns_{0};
+
+			// 最近一次从 Poll 中醒来的时间
+            int64_t wake_ns_{0};
+
+			// 本周期的开始时间
+            int64_t sample_begin_ns_{0};
         };
     }
 }
\ No newline at end of file
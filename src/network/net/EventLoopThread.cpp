@@ -4,8 +4,9 @@ using namespace lss::network;
 
 // 默认构造函数，使用成员初始化列表来初始化 thread_ 成员变量
 // 在初始化 thread_ 时，使用 lambda 表达式作为参数，该 lambda 表达式会调用 StartEventLoop 函数，在构造函数结束时被调用
-EventLoopThread::EventLoopThread()
-: thread_([this](){StartEventLoop();})
+EventLoopThread::EventLoopThread(PollerType type)
+: poller_type_(type)
+, thread_([this](){StartEventLoop();})
 {
 
 }
@@ -58,7 +59,7 @@ EventLoop *EventLoopThread::Loop() const
 void EventLoopThread::StartEventLoop()
 {
     // 创建对象
-    EventLoop loop;
+    EventLoop loop(poller_type_);
     // 调用 std::unique_lock<std::mutex> 构造函数，创建一个互斥锁，保护共享资源的访问
     std::unique_lock<std::mutex> lk(lock_);
     // 调用 std::condition_variable::wait 函数，等待其他线程调用 Run 函数
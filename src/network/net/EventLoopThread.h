@@ -13,8 +13,8 @@ namespace lss
         class EventLoopThread
         {
         public:
-            // 默认构造函数
-            EventLoopThread();
+            // 构造函数，type 指定事件循环的多路复用后端
+            explicit EventLoopThread(PollerType type = kPollerEpoll);
 
             // 析构函数
             ~EventLoopThread();
@@ -48,6 +48,9 @@ namespace lss
 
             std::promise<int> promise_loop_;
 
+            // 事件循环的多路复用后端，必须在线程启动之前初始化
+            PollerType poller_type_{kPollerEpoll};
+
             // 事件循环的线程
             std::thread thread_;
         };
@@ -1,13 +1,17 @@
 #include <pthread.h>
+#include <algorithm>
+#include <cstdlib>
 #include "EventLoopThreadPool.h"
+#include "base/NumaUtils.h"
 
 using namespace lss::network;
+using namespace lss::base;
 
 // 定义一个匿名命名空间，限制其中的函数只在当前文件中可见
 namespace
 {
-    // 绑定 CPU ，接收一个线程引用和一个 CPU 核心编号
-    void bind_cpu(std::thread &t, int n)
+    // 绑定 CPU ，接收一个线程引用和一个 CPU 核心编号，返回是否绑定成功
+    bool bind_cpu(std::thread &t, int n)
     {
         // 定义一个 cpu_set_t 类型的变量，用于设置 CPU 亲和性
         cpu_set_t cpu;
@@ -17,11 +21,68 @@ namespace
         CPU_SET(n, &cpu);
 
         // 设置线程 t 的 CPU 亲和性，使其只在指定的核心上运行
-        pthread_setaffinity_np(t.native_handle(), sizeof(cpu), &cpu);
+        return pthread_setaffinity_np(t.native_handle(), sizeof(cpu), &cpu) == 0;
+    }
+
+    // 繁忙程度相差超过 10% 时按繁忙程度比较
+    const int32_t kBusyMargin = 100;
+
+    // 流量超过 1MB/s 并且相差超过 25% 时按流量比较
+    const int64_t kTrafficFloor = 1024 * 1024;
+
+    // a 的负载是否低于 b
+    // 依次比较繁忙程度、流量和连接数，前两项只有差距明显时才起作用，避免统计的抖动让连接集中到某一个事件循环
+    bool less_loaded(const LoopLoad &a, const LoopLoad &b)
+    {
+        if (std::abs(a.busy_permille - b.busy_permille) > kBusyMargin)
+        {
+            return a.busy_permille < b.busy_permille;
+        }
+
+        int64_t high = std::max(a.bytes_per_sec, b.bytes_per_sec);
+        int64_t low = std::min(a.bytes_per_sec, b.bytes_per_sec);
+        if (high > kTrafficFloor && high - low > high / 4)
+        {
+            return a.bytes_per_sec < b.bytes_per_sec;
+        }
+
+        return a.connections < b.connections;
+    }
+
+    // 按 NUMA 节点轮流选取 CPU：候选 CPU 为 (start + k) % cpus，按所在节点分组，
+    // 第 i 个线程使用第 i % 节点数 个节点中下一个未使用的 CPU，节点的 CPU 用完后从头复用
+    std::vector<int> numa_cpus(int thread_num, int start, int cpus)
+    {
+        std::vector<int> order;
+        std::vector<std::vector<int>> node_cpus;
+        for (int k = 0; k < cpus; k++)
+        {
+            int cpu = (start + k) % cpus;
+            int node = NumaUtils::NodeOfCpu(cpu);
+
+            auto iter = std::find(order.begin(), order.end(), node);
+            if (iter == order.end())
+            {
+                order.push_back(node);
+                node_cpus.emplace_back();
+                iter = order.end() - 1;
+            }
+            node_cpus[iter - order.begin()].push_back(cpu);
+        }
+
+        std::vector<int> result;
+        for (int i = 0; i < thread_num; i++)
+        {
+            auto &list = node_cpus[i % node_cpus.size()];
+            result.push_back(list[(i / node_cpus.size()) % list.size()]);
+        }
+
+        return result;
     }
 }
 
-EventLoopThreadPool::EventLoopThreadPool(int thread_num, int start, int cpus)
+EventLoopThreadPool::EventLoopThreadPool(int thread_num, int start, int cpus, PollerType type, bool numa)
+    : numa_(numa)
 {
     // 检查线程数量
     if (thread_num <= 0)
@@ -29,20 +90,34 @@ EventLoopThreadPool::EventLoopThreadPool(int thread_num, int start, int cpus)
         thread_num = 1;
     }
 
+    // 按 NUMA 节点分配时预先算好每个线程的 CPU
+    std::vector<int> assigned;
+    if (numa && cpus > 0)
+    {
+        assigned = numa_cpus(thread_num, start, cpus);
+    }
+
     // 循环创建指定数量的线程
     for (int i = 0; i < thread_num; i++)
     {
         // 创建一个 EventLoopThread 的共享指针并添加到线程容器中
-        threads_.emplace_back(std::make_shared<EventLoopThread>());
+        threads_.emplace_back(std::make_shared<EventLoopThread>(type));
 
         // 如果指定了 CPU 核心数量
         if (cpus > 0)
         {
             // 计算当前线程应该绑定的 CPU 核心编号
-            int n = (start + i) % cpus;
-            // 调用 bind_cpu 函数，将当前线程绑定到指定的 CPU 核心
-            bind_cpu(threads_.back()->Thread(), n);
+            int n = assigned.empty() ? (start + i) % cpus : assigned[i];
+            // 调用 bind_cpu 函数，将当前线程绑定到指定的 CPU 核心，CPU 不存在时绑定失败，记为未绑定
+            cpus_.push_back(bind_cpu(threads_.back()->Thread(), n) ? n : -1);
         }
+        else
+        {
+            cpus_.push_back(-1);
+        }
+
+        // 绑定了 CPU 的线程才能确定所在的节点
+        nodes_.push_back(cpus_.back() >= 0 ? NumaUtils::NodeOfCpu(cpus_.back()) : -1);
     }
 }
 
@@ -69,9 +144,24 @@ std::vector<EventLoop *> EventLoopThreadPool::GetLoops() const
     return result;
 }
 
+LoopPlacement EventLoopThreadPool::ParsePlacement(const std::string &name)
+{
+    if (name == "least_loaded" || name == "least-loaded" || name == "load")
+    {
+        return kPlacementLeastLoaded;
+    }
+
+    return kPlacementRoundRobin;
+}
+
 // 获取下一个 EventLoop 的指针
 EventLoop *EventLoopThreadPool::GetNextLoop()
 {
+    if (placement_ == kPlacementLeastLoaded && threads_.size() > 1)
+    {
+        return GetLeastLoadedLoop();
+    }
+
     // 将当前索引赋值给 index
     int index = loop_index_;
     // 增加索引，以便下次调用时获取下一个 EventLoop
@@ -81,6 +171,28 @@ EventLoop *EventLoopThreadPool::GetNextLoop()
     return threads_[index % threads_.size()]->Loop();
 }
 
+// 遍历所有事件循环，只读取原子变量，不需要加锁
+EventLoop *EventLoopThreadPool::GetLeastLoadedLoop()
+{
+    size_t size = threads_.size();
+    size_t start = static_cast<uint32_t>(loop_index_++) % size;
+
+    EventLoop *best = threads_[start]->Loop();
+    LoopLoad best_load = best->Load();
+    for (size_t i = 1; i < size; i++)
+    {
+        EventLoop *loop = threads_[(start + i) % size]->Loop();
+        LoopLoad load = loop->Load();
+        if (less_loaded(load, best_load))
+        {
+            best = loop;
+            best_load = load;
+        }
+    }
+
+    return best;
+}
+
 // 获取线程池中线程的数量
 size_t EventLoopThreadPool::Size()
 {
@@ -91,9 +203,20 @@ size_t EventLoopThreadPool::Size()
 // 启动线程池中的所有线程
 void EventLoopThreadPool::Start()
 {
-    for (auto &t : threads_)
+    for (size_t i = 0; i < threads_.size(); i++)
     {
         // 调用每个线程的 Run 方法，启动线程
-        t->Run();
+        threads_[i]->Run();
+
+        // 记录事件循环所在的节点，按节点分配时该线程之后分配的内存优先放在本节点
+        EventLoop *loop = threads_[i]->Loop();
+        int node = nodes_[i];
+        loop->SetNode(node);
+        if (numa_ && node >= 0)
+        {
+            loop->RunInLoop([node](){
+                NumaUtils::PreferNode(node);
+            });
+        }
     }
 }
\ No newline at end of file
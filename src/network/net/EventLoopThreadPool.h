@@ -1,5 +1,6 @@
 #pragma once
 #include <atomic>
+#include <string>
 #include "base/NonCopyable.h"
 #include "EventLoop.h"
 #include "EventLoopThread.h"
@@ -11,12 +12,20 @@ namespace lss
         // 定义一个类型别名 EventLoopThreadPtr，表示指向 EventLoopThread 的智能指针
         using EventLoopThreadPtr = std::shared_ptr<EventLoopThread>;
 
+        // 新连接选择事件循环的策略
+        enum LoopPlacement
+        {
+            kPlacementRoundRobin = 0,   // 轮询
+            kPlacementLeastLoaded,      // 选择负载最低的事件循环
+        };
+
         // 事件循环线程池，不可复制
         class EventLoopThreadPool : public base::NonCopyable
         {
         public:
-            // 构造函数声明。接收线程数量、起始线程索引和 CPU 数量
-            EventLoopThreadPool(int thread_num, int start = 0, int cpus = 4);
+            // 构造函数声明。接收线程数量、起始线程索引、CPU 数量和多路复用后端
+            // numa 为 true 时按 NUMA 节点轮流分配 CPU，事件循环均匀分布在各个节点上，并且优先在本节点分配内存
+            EventLoopThreadPool(int thread_num, int start = 0, int cpus = 4, PollerType type = kPollerEpoll, bool numa = false);
             
             // 析构函数，清理资源
             ~EventLoopThreadPool();
@@ -24,9 +33,24 @@ namespace lss
             // 获取事件循环，返回一个指向 EventLoop 的指针
             std::vector<EventLoop *> GetLoops() const;
 
-            // 获取下一个事件循环，返回一个指向 EventLoop 的指针
+            // 获取每个事件循环绑定的 CPU，与 GetLoops 的顺序一致，未绑定时为 -1
+            std::vector<int> GetCpus() const
+            {
+                return cpus_;
+            }
+
+            // 按照选择策略获取下一个事件循环，返回一个指向 EventLoop 的指针
             EventLoop *GetNextLoop();
 
+            // 设置选择策略，需要在开始分配连接之前设置
+            void SetPlacement(LoopPlacement placement)
+            {
+                placement_ = placement;
+            }
+
+            // 将配置中的名称转换为选择策略，无法识别时返回轮询
+            static LoopPlacement ParsePlacement(const std::string &name);
+
             // 返回线程池中事件循环的数量
             size_t Size();
             
@@ -34,11 +58,26 @@ namespace lss
             void Start();
 
         private:
+            // 选择负载最低的事件循环，负载相同时从轮询的位置开始，让连接均匀分布
+            EventLoop *GetLeastLoadedLoop();
+
             // 存储 EventLoopThreadPtr 类型的线程指针
             std::vector<EventLoopThreadPtr> threads_;
 
             // 原子整数 loop_index_ ，初始化为 0 ，用于跟踪下一个事件循环的索引
             std::atomic_int32_t loop_index_{0};
+
+            // 选择策略
+            LoopPlacement placement_{kPlacementRoundRobin};
+
+            // 每个事件循环绑定的 CPU，未绑定时为 -1
+            std::vector<int> cpus_;
+
+            // 每个事件循环所在的 NUMA 节点，未知时为 -1
+            std::vector<int> nodes_;
+
+            // 是否按 NUMA 节点分配
+            bool numa_{false};
         };
     }
 }
\ No newline at end of file
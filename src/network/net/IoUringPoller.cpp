@@ -0,0 +1,538 @@
+#include <cstring>
+#include <csignal>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "IoUringPoller.h"
+#include "Event.h"
+#include "network/base/Network.h"
+
+using namespace lss::network;
+
+namespace
+{
+    int io_uring_setup(unsigned entries, struct io_uring_params *p)
+    {
+        return (int)::syscall(__NR_io_uring_setup, entries, p);
+    }
+
+    int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, void *arg, size_t size)
+    {
+        return (int)::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, size);
+    }
+
+    int io_uring_register(int fd, unsigned opcode, void *arg, unsigned nr_args)
+    {
+        return (int)::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+    }
+}
+
+IoUringPoller::IoUringPoller(EventLoop *loop)
+: Poller(loop)
+{
+
+}
+
+IoUringPoller::~IoUringPoller()
+{
+    // 先关闭实例，内核释放所有请求后再释放缓冲区
+    if (ring_fd_ >= 0)
+    {
+        ::close(ring_fd_);
+        ring_fd_ = -1;
+    }
+
+    if (ring_)
+    {
+        ::munmap(ring_, ring_size_);
+        ring_ = nullptr;
+    }
+
+    if (sqes_)
+    {
+        ::munmap(sqes_, sqes_size_);
+        sqes_ = nullptr;
+    }
+
+    if (buf_ring_)
+    {
+        ::munmap(buf_ring_, buf_ring_size_);
+        buf_ring_ = nullptr;
+    }
+
+    delete [] buffers_;
+    buffers_ = nullptr;
+}
+
+bool IoUringPoller::Init()
+{
+    struct io_uring_params params;
+    memset(&params, 0x00, sizeof(params));
+
+    // 只有事件循环线程提交，内核不需要为跨线程提交加锁，也不需要打断线程执行任务
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN | IORING_SETUP_SINGLE_ISSUER;
+
+    ring_fd_ = io_uring_setup(kEntries, &params);
+    if (ring_fd_ < 0)
+    {
+        NETWORK_WARNING << " io_uring_setup error : " << errno;
+        return false;
+    }
+
+    // 依赖的特性：单次映射、完成项不丢失、提交后数据可以释放、等待时带超时
+    const unsigned required = IORING_FEAT_SINGLE_MMAP | IORING_FEAT_NODROP | IORING_FEAT_SUBMIT_STABLE | IORING_FEAT_EXT_ARG;
+    if ((params.features & required) != required)
+    {
+        NETWORK_WARNING << " io_uring features not supported : " << params.features;
+        return false;
+    }
+
+    // 映射提交队列和完成队列
+    size_t sq_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring_size_ = sq_size > cq_size ? sq_size : cq_size;
+    void *ring = ::mmap(nullptr, ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+    if (ring == MAP_FAILED)
+    {
+        NETWORK_WARNING << " io_uring mmap ring error : " << errno;
+        return false;
+    }
+    ring_ = ring;
+
+    // 映射提交项数组
+    sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+    void *sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED)
+    {
+        NETWORK_WARNING << " io_uring mmap sqes error : " << errno;
+        return false;
+    }
+    sqes_ = (struct io_uring_sqe*)sqes;
+
+    char *base = (char*)ring_;
+    sq_head_ = (unsigned*)(base + params.sq_off.head);
+    sq_tail_ = (unsigned*)(base + params.sq_off.tail);
+    sq_array_ = (unsigned*)(base + params.sq_off.array);
+    sq_mask_ = *(unsigned*)(base + params.sq_off.ring_mask);
+    sq_entries_ = params.sq_entries;
+    sq_local_tail_ = *sq_tail_;
+    sq_submitted_ = sq_local_tail_;
+
+    cq_head_ = (unsigned*)(base + params.cq_off.head);
+    cq_tail_ = (unsigned*)(base + params.cq_off.tail);
+    cq_mask_ = *(unsigned*)(base + params.cq_off.ring_mask);
+    cqes_ = (struct io_uring_cqe*)(base + params.cq_off.cqes);
+
+    // 创建接收缓冲区环并注册
+    buf_ring_size_ = kBufCount * sizeof(struct io_uring_buf);
+    void *buf_ring = ::mmap(nullptr, buf_ring_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (buf_ring == MAP_FAILED)
+    {
+        NETWORK_WARNING << " io_uring mmap buffer ring error : " << errno;
+        return false;
+    }
+    buf_ring_ = (struct io_uring_buf_ring*)buf_ring;
+
+    struct io_uring_buf_reg reg;
+    memset(&reg, 0x00, sizeof(reg));
+    reg.ring_addr = (uint64_t)(uintptr_t)buf_ring_;
+    reg.ring_entries = kBufCount;
+    reg.bgid = kBufGroup;
+    if (io_uring_register(ring_fd_, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        NETWORK_WARNING << " io_uring register buffer ring error : " << errno;
+        return false;
+    }
+
+    // 把所有缓冲区放入缓冲区环
+    buffers_ = new char[kBufCount * kBufSize];
+    for (unsigned i = 0; i < kBufCount; i++)
+    {
+        RecycleBuffer(i);
+    }
+
+    // 预先分配发送数据，提交队列满之前一定会提交，数量不会超过提交队列的一半
+    send_ops_.resize(sq_entries_ / 2 + 1);
+
+    return true;
+}
+
+void IoUringPoller::AddEvent(Event *event)
+{
+    // 申请了异步 IO 的事件只接收数据，发送由 AsyncSend 完成
+    if (event->AsyncIo())
+    {
+        ArmRecv(event->Fd());
+    }
+    else
+    {
+        ArmPoll(event);
+    }
+}
+
+void IoUringPoller::DelEvent(Event *event)
+{
+    int fd = event->Fd();
+    if (fd < 0)
+    {
+        return;
+    }
+
+    // 取消该文件描述符上所有的请求
+    struct io_uring_sqe *sqe = GetSqe();
+    if (sqe)
+    {
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = fd;
+        sqe->cancel_flags = IORING_ASYNC_CANCEL_FD | IORING_ASYNC_CANCEL_ALL;
+        sqe->user_data = Encode(kOpCancel, 0, fd);
+    }
+
+    // 代数加一，之后到达的完成项都会被丢弃
+    Generation(fd);
+    gens_[fd]++;
+
+    // 调用者随后会关闭文件描述符，必须立即提交，否则按文件描述符取消会失败
+    Submit();
+}
+
+void IoUringPoller::UpdateEvent(Event *event)
+{
+    // 异步 IO 事件一直在接收，不需要更新
+    if (event->AsyncIo())
+    {
+        return;
+    }
+
+    int fd = event->Fd();
+    struct io_uring_sqe *sqe = GetSqe();
+    if (!sqe)
+    {
+        return;
+    }
+
+    // 原地更新多次触发的就绪通知监听的事件
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = Encode(kOpPoll, Generation(fd), fd);
+    sqe->len = IORING_POLL_UPDATE_EVENTS;
+    sqe->poll32_events = event->Events();
+    sqe->user_data = Encode(kOpCancel, 0, fd);
+}
+
+int IoUringPoller::Poll(int timeout_ms)
+{
+    struct __kernel_timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+
+    struct io_uring_getevents_arg arg;
+    memset(&arg, 0x00, sizeof(arg));
+    arg.sigmask_sz = _NSIG / 8;
+    arg.ts = timeout_ms >= 0 ? (uint64_t)(uintptr_t)&ts : 0;
+
+    // 已经有完成项时不再等待
+    unsigned ready = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) - *cq_head_;
+    unsigned wait = (timeout_ms != 0 && ready == 0) ? 1 : 0;
+
+    // 提交本轮循环积累的所有提交项，并等待完成项
+    BeginWait();
+    auto ret = Enter(wait, IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+    EndWait();
+    if (ret < 0 && errno != ETIME && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+    {
+        return -1;
+    }
+
+    // 收割完成项，先推进头部再处理，处理过程中可以继续提交
+    int count = 0;
+    unsigned head = *cq_head_;
+    unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+    // 完成项回调中记录活跃时间时使用醒来的时间
+    if (head != tail)
+    {
+        UpdateTime();
+    }
+    while (head != tail)
+    {
+        struct io_uring_cqe &cqe = cqes_[head & cq_mask_];
+        uint64_t user_data = cqe.user_data;
+        int32_t res = cqe.res;
+        uint32_t flags = cqe.flags;
+
+        head++;
+        __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+        HandleCqe(user_data, res, flags);
+        count++;
+    }
+
+    return count;
+}
+
+bool IoUringPoller::AsyncSend(Event *event, const struct iovec *iov, int count, int timeout_ms)
+{
+    int fd = event->Fd();
+    if (fd < 0 || count <= 0)
+    {
+        return false;
+    }
+
+    // 发送数据用完，先提交之前的发送
+    if (send_ops_used_ == send_ops_.size())
+    {
+        Submit();
+        if (send_ops_used_ == send_ops_.size())
+        {
+            return false;
+        }
+    }
+
+    // 发送和超时必须相邻，一起获取
+    struct io_uring_sqe *sqe = GetSqe(2);
+    if (!sqe)
+    {
+        return false;
+    }
+
+    SendOp &op = send_ops_[send_ops_used_++];
+    int n = count < 64 ? count : 64;
+    memcpy(op.iov, iov, n * sizeof(struct iovec));
+    memset(&op.msg, 0x00, sizeof(op.msg));
+    op.msg.msg_iov = op.iov;
+    op.msg.msg_iovlen = n;
+    op.ts.tv_sec = timeout_ms / 1000;
+    op.ts.tv_nsec = (timeout_ms % 1000) * 1000000LL;
+
+    uint32_t gen = Generation(fd);
+
+    // 发送，链接到下一个提交项
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)&op.msg;
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->flags = IOSQE_IO_LINK;
+    sqe->user_data = Encode(kOpSend, gen, fd);
+
+    // 超时，到期后取消发送
+    sqe = GetSqe();
+    sqe->opcode = IORING_OP_LINK_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)(uintptr_t)&op.ts;
+    sqe->len = 1;
+    sqe->user_data = Encode(kOpTimeout, gen, fd);
+
+    return true;
+}
+
+struct io_uring_sqe *IoUringPoller::GetSqe(unsigned n)
+{
+    // 空闲的提交项不够，先提交
+    unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+    if (sq_local_tail_ + n - head > sq_entries_)
+    {
+        Submit();
+        head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+        if (sq_local_tail_ + n - head > sq_entries_)
+        {
+            NETWORK_ERROR << " io_uring submission queue full.";
+            return nullptr;
+        }
+    }
+
+    // 获取提交项并清零
+    unsigned index = sq_local_tail_ & sq_mask_;
+    struct io_uring_sqe *sqe = &sqes_[index];
+    sq_array_[index] = index;
+    sq_local_tail_++;
+    memset(sqe, 0x00, sizeof(struct io_uring_sqe));
+
+    return sqe;
+}
+
+int IoUringPoller::Enter(unsigned min_complete, unsigned flags, void *arg, size_t size)
+{
+    // 发布本地的提交队列尾部
+    __atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+
+    unsigned to_submit = sq_local_tail_ - sq_submitted_;
+    int ret = io_uring_enter(ring_fd_, to_submit, min_complete, flags, arg, size);
+    if (ret > 0)
+    {
+        sq_submitted_ += ret;
+    }
+
+    // 全部提交后发送数据可以复用
+    if (sq_submitted_ == sq_local_tail_)
+    {
+        send_ops_used_ = 0;
+    }
+
+    return ret;
+}
+
+int IoUringPoller::Submit()
+{
+    if (sq_local_tail_ == sq_submitted_)
+    {
+        return 0;
+    }
+
+    return Enter(0, 0, nullptr, 0);
+}
+
+void IoUringPoller::ArmPoll(Event *event)
+{
+    int fd = event->Fd();
+    struct io_uring_sqe *sqe = GetSqe();
+    if (!sqe)
+    {
+        return;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->poll32_events = event->Events();
+    sqe->user_data = Encode(kOpPoll, Generation(fd), fd);
+}
+
+void IoUringPoller::ArmRecv(int fd)
+{
+    struct io_uring_sqe *sqe = GetSqe();
+    if (!sqe)
+    {
+        return;
+    }
+
+    // 每次收到数据时从缓冲区组中取一个缓冲区
+    sqe->opcode = IORING_OP_RECV;
+    sqe->fd = fd;
+    sqe->ioprio = IORING_RECV_MULTISHOT;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = kBufGroup;
+    sqe->user_data = Encode(kOpRecv, Generation(fd), fd);
+}
+
+void IoUringPoller::HandleCqe(uint64_t user_data, int32_t res, uint32_t flags)
+{
+    OpType type = (OpType)(user_data >> 56);
+    uint32_t gen = (uint32_t)(user_data >> 32) & 0xFFFFFF;
+    int fd = (int)(uint32_t)user_data;
+    bool more = (flags & IORING_CQE_F_MORE) != 0;
+
+    switch (type)
+    {
+    case kOpPoll:
+    {
+        if (!IsCurrent(fd, gen))
+        {
+            break;
+        }
+
+        auto event = FindEvent(fd);
+        if (!event)
+        {
+            break;
+        }
+
+        // 结果就是就绪的事件掩码
+        if (res > 0)
+        {
+            DispatchEvent(event.get(), (uint32_t)res);
+        }
+
+        // 多次触发的请求结束了，事件仍然有效时重新注册
+        if (!more && res != -ECANCELED && IsCurrent(fd, gen))
+        {
+            ArmPoll(event.get());
+        }
+        break;
+    }
+    case kOpRecv:
+    {
+        bool has_buffer = (flags & IORING_CQE_F_BUFFER) != 0;
+        uint16_t bid = (uint16_t)(flags >> IORING_CQE_BUFFER_SHIFT);
+
+        if (IsCurrent(fd, gen))
+        {
+            auto event = FindEvent(fd);
+            if (event)
+            {
+                if (res > 0 && has_buffer)
+                {
+                    event->OnRecv(buffers_ + (size_t)bid * kBufSize, res);
+                }
+                else if (res == 0)
+                {
+                    // 对端关闭
+                    event->OnClose();
+                }
+                else if (res < 0 && res != -ENOBUFS && res != -ECANCELED)
+                {
+                    event->OnError(strerror(-res));
+                }
+
+                // 缓冲区耗尽或者内核结束了多次接收，事件仍然有效时重新注册
+                if (!more && (res > 0 || res == -ENOBUFS) && IsCurrent(fd, gen))
+                {
+                    ArmRecv(fd);
+                }
+            }
+        }
+
+        // 无论结果是否有效都要归还缓冲区
+        if (has_buffer)
+        {
+            RecycleBuffer(bid);
+        }
+        break;
+    }
+    case kOpSend:
+    {
+        if (!IsCurrent(fd, gen))
+        {
+            break;
+        }
+
+        auto event = FindEvent(fd);
+        if (event)
+        {
+            event->OnSendComplete(res);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void IoUringPoller::RecycleBuffer(uint16_t bid)
+{
+    struct io_uring_buf *bufs = (struct io_uring_buf*)buf_ring_;
+    struct io_uring_buf &buf = bufs[buf_tail_ & (kBufCount - 1)];
+    buf.addr = (uint64_t)(uintptr_t)(buffers_ + (size_t)bid * kBufSize);
+    buf.len = kBufSize;
+    buf.bid = bid;
+
+    // 发布新的尾部，内核看到尾部时一定能看到缓冲区内容
+    buf_tail_++;
+    __atomic_store_n(&buf_ring_->tail, buf_tail_, __ATOMIC_RELEASE);
+}
+
+uint32_t IoUringPoller::Generation(int fd)
+{
+    if (fd >= (int)gens_.size())
+    {
+        gens_.resize(fd + 1024, 0);
+    }
+
+    return gens_[fd] & 0xFFFFFF;
+}
+
+bool IoUringPoller::IsCurrent(int fd, uint32_t gen) const
+{
+    return fd >= 0 && fd < (int)gens_.size() && (gens_[fd] & 0xFFFFFF) == gen;
+}
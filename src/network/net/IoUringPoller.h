@@ -0,0 +1,154 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <sys/socket.h>
+#include <linux/io_uring.h>
+#include "Poller.h"
+
+namespace lss
+{
+    namespace network
+    {
+        // 基于 io_uring 的完成通知后端，直接使用系统调用，不依赖 liburing
+        // 普通事件（监听套接字、eventfd、UDP 等）使用多次触发的 POLL_ADD，行为与 epoll 一致
+        // 申请了异步 IO 的连接使用多次触发的 RECV 从注册的缓冲区环中取缓冲区接收数据，发送使用 SENDMSG 并链接超时
+        // 所有提交项在每轮循环进入等待前一次性提交
+        // 需要 Linux 6.0 及以上内核
+        class IoUringPoller : public Poller
+        {
+        public:
+            explicit IoUringPoller(EventLoop *loop);
+
+            ~IoUringPoller();
+
+            bool Init() override;
+
+            void AddEvent(Event *event) override;
+
+            void DelEvent(Event *event) override;
+
+            void UpdateEvent(Event *event) override;
+
+            int Poll(int timeout_ms) override;
+
+            bool SupportAsyncIo() const override
+            {
+                return true;
+            }
+
+            bool AsyncSend(Event *event, const struct iovec *iov, int count, int timeout_ms) override;
+
+            const char *Name() const override
+            {
+                return "io_uring";
+            }
+
+        private:
+            // 提交项的类型，编码在 user_data 的最高字节
+            enum OpType
+            {
+                kOpPoll = 1,    // 多次触发的就绪通知
+                kOpRecv,        // 多次触发的接收
+                kOpSend,        // 发送
+                kOpTimeout,     // 发送链接的超时
+                kOpCancel,      // 取消或更新，不关心结果
+            };
+
+            // 一次发送需要的数据，提交之后内核已经拷贝，可以复用
+            struct SendOp
+            {
+                struct msghdr msg;
+                struct iovec iov[64];
+                struct __kernel_timespec ts;
+            };
+
+            // 提交队列的大小
+            static const unsigned kEntries = 1024;
+
+            // 接收缓冲区的数量，必须是 2 的幂
+            static const unsigned kBufCount = 256;
+
+            // 每个接收缓冲区的大小
+            static const unsigned kBufSize = 16 * 1024;
+
+            // 接收缓冲区组编号
+            static const uint16_t kBufGroup = 0;
+
+            // 将类型、代数和文件描述符编码为 user_data
+            static uint64_t Encode(OpType type, uint32_t gen, int fd)
+            {
+                return ((uint64_t)type << 56) | ((uint64_t)(gen & 0xFFFFFF) << 32) | (uint32_t)fd;
+            }
+
+            // 获取一个空闲的提交项，保证之后还有 n - 1 个空闲提交项可以连续获取，提交队列满时先提交
+            struct io_uring_sqe *GetSqe(unsigned n = 1);
+
+            // 提交队列中的提交项，同时可以等待完成
+            int Enter(unsigned min_complete, unsigned flags, void *arg, size_t size);
+
+            // 提交队列中的提交项，不等待
+            int Submit();
+
+            // 为普通事件注册多次触发的就绪通知
+            void ArmPoll(Event *event);
+
+            // 为异步 IO 事件注册多次触发的接收
+            void ArmRecv(int fd);
+
+            // 处理一个完成项
+            void HandleCqe(uint64_t user_data, int32_t res, uint32_t flags);
+
+            // 将接收缓冲区放回缓冲区环
+            void RecycleBuffer(uint16_t bid);
+
+            // 文件描述符当前的代数，注销时加一，用于丢弃已经注销的请求的完成项
+            uint32_t Generation(int fd);
+
+            // 完成项是否属于当前的注册
+            bool IsCurrent(int fd, uint32_t gen) const;
+
+            // io_uring 实例
+            int ring_fd_{-1};
+
+            // 提交队列和完成队列共用的映射内存
+            void *ring_{nullptr};
+            size_t ring_size_{0};
+
+            // 提交项数组
+            struct io_uring_sqe *sqes_{nullptr};
+            size_t sqes_size_{0};
+
+            // 提交队列
+            unsigned *sq_head_{nullptr};
+            unsigned *sq_tail_{nullptr};
+            unsigned *sq_array_{nullptr};
+            unsigned sq_mask_{0};
+            unsigned sq_entries_{0};
+
+            // 本地的提交队列尾部和已经提交的位置
+            unsigned sq_local_tail_{0};
+            unsigned sq_submitted_{0};
+
+            // 完成队列
+            unsigned *cq_head_{nullptr};
+            unsigned *cq_tail_{nullptr};
+            unsigned cq_mask_{0};
+            struct io_uring_cqe *cqes_{nullptr};
+
+            // 注册给内核的接收缓冲区环
+            struct io_uring_buf_ring *buf_ring_{nullptr};
+            size_t buf_ring_size_{0};
+            uint16_t buf_tail_{0};
+
+            // 接收缓冲区
+            char *buffers_{nullptr};
+
+            // 按文件描述符索引的代数
+            std::vector<uint32_t> gens_;
+
+            // 尚未提交的发送使用的数据，全部提交后清零
+            std::vector<SendOp> send_ops_;
+            size_t send_ops_used_{0};
+        };
+    }
+}
@@ -0,0 +1,105 @@
+#include "IoVecRing.h"
+
+using namespace lss::network;
+
+IoVecRing::IoVecRing(size_t capacity)
+{
+    // 容量向上取整为 2 的幂，才能用掩码代替取模
+    size_t size = 1;
+    while (size < capacity)
+    {
+        size <<= 1;
+    }
+
+    ring_.resize(size);
+    mask_ = size - 1;
+}
+
+void IoVecRing::Push(const void *base, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+
+    if (count_ == ring_.size())
+    {
+        Grow();
+    }
+
+    struct iovec &vec = ring_[(head_ + count_) & mask_];
+    vec.iov_base = const_cast<void*>(base);
+    vec.iov_len = len;
+
+    ++count_;
+    bytes_ += len;
+}
+
+void IoVecRing::Consume(size_t bytes)
+{
+    while (bytes > 0 && count_ > 0)
+    {
+        struct iovec &vec = ring_[head_ & mask_];
+
+        // 当前数据块只发送了一部分，调整起始地址和长度后结束
+        if (vec.iov_len > bytes)
+        {
+            vec.iov_base = (char*)vec.iov_base + bytes;
+            vec.iov_len -= bytes;
+            bytes_ -= bytes;
+            break;
+        }
+
+        // 当前数据块已经全部发送，推进头部
+        bytes -= vec.iov_len;
+        bytes_ -= vec.iov_len;
+        ++head_;
+        --count_;
+    }
+
+    // 队列为空时头部归零，下一批数据从数组开头开始，减少绕回
+    if (count_ == 0)
+    {
+        head_ = 0;
+        bytes_ = 0;
+    }
+}
+
+void IoVecRing::Clear()
+{
+    head_ = 0;
+    count_ = 0;
+    bytes_ = 0;
+}
+
+int IoVecRing::Batch(int max) const
+{
+    // 头部到数组末尾之间的元素在内存中连续，绕回的部分留给下一次
+    size_t begin = head_ & mask_;
+    size_t n = ring_.size() - begin;
+    if (n > count_)
+    {
+        n = count_;
+    }
+    if (n > (size_t)max)
+    {
+        n = max;
+    }
+
+    return static_cast<int>(n);
+}
+
+void IoVecRing::Grow()
+{
+    std::vector<struct iovec> ring(ring_.size() * 2);
+
+    // 按顺序搬到新数组的开头
+    for (size_t i = 0; i < count_; i++)
+    {
+        ring[i] = ring_[(head_ + i) & mask_];
+    }
+
+    ring_.swap(ring);
+    mask_ = ring_.size() - 1;
+    head_ = 0;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <cstddef>
+#include <vector>
+#include <sys/uio.h>
+
+namespace lss
+{
+    namespace network
+    {
+        // 待发送数据的 iovec 环形队列
+        // 写完的数据只推进头部下标，不移动剩余的元素；容量为 2 的幂，满了以后按倍数扩容
+        // 同时记录队列中的总字节数，供上层查询积压的数据量
+        class IoVecRing
+        {
+        public:
+            // 构造函数，初始容量为 capacity，向上取整为 2 的幂
+            explicit IoVecRing(size_t capacity = 16);
+
+            // 追加一块数据，长度为 0 的数据块直接忽略
+            void Push(const void *base, size_t len);
+
+            // 移除头部已经发送的 bytes 字节，最后一块只发送了一部分时调整它的起始地址和长度
+            void Consume(size_t bytes);
+
+            // 清空队列
+            void Clear();
+
+            // 头部第一个 iovec 的地址
+            const struct iovec *Front() const
+            {
+                return &ring_[head_ & mask_];
+            }
+
+            // 从头部开始在内存中连续的 iovec 数量，最多 max 个，可以直接传给 writev
+            int Batch(int max) const;
+
+            // 队列是否为空
+            bool Empty() const
+            {
+                return count_ == 0;
+            }
+
+            // 队列中 iovec 的数量
+            size_t Size() const
+            {
+                return count_;
+            }
+
+            // 队列中尚未发送的总字节数
+            size_t Bytes() const
+            {
+                return bytes_;
+            }
+
+        private:
+            // 扩容为原来的两倍，扩容时把元素按顺序搬到新数组的开头
+            void Grow();
+
+            // 环形数组，大小为 2 的幂
+            std::vector<struct iovec> ring_;
+
+            // 下标掩码，等于数组大小减一
+            size_t mask_{0};
+
+            // 头部下标，只增不减，取模后才是数组下标
+            size_t head_{0};
+
+            // 队列中的元素数量
+            size_t count_{0};
+
+            // 队列中的总字节数
+            size_t bytes_{0};
+        };
+    }
+}
@@ -0,0 +1,119 @@
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/epoll.h>
+#include "Poller.h"
+#include "EpollPoller.h"
+#include "IoUringPoller.h"
+#include "EventLoop.h"
+#include "network/base/Network.h"
+#include "base/TTime.h"
+
+using namespace lss::network;
+
+Poller::Poller(EventLoop *loop)
+: loop_(loop)
+{
+
+}
+
+std::unique_ptr<Poller> Poller::NewPoller(EventLoop *loop, PollerType type)
+{
+    std::unique_ptr<Poller> poller;
+
+    // 优先创建指定的后端
+    if (type == kPollerIoUring)
+    {
+        poller.reset(new IoUringPoller(loop));
+        if (!poller->Init())
+        {
+            // 内核不支持或者资源不足，退回 epoll
+            NETWORK_WARNING << " io_uring init failed, fall back to epoll.";
+            poller.reset();
+        }
+    }
+
+    // 默认使用 epoll
+    if (!poller)
+    {
+        poller.reset(new EpollPoller(loop));
+        if (!poller->Init())
+        {
+            NETWORK_ERROR << " epoll init failed. error : " << errno;
+            exit(-1);
+        }
+    }
+
+    NETWORK_DEBUG << " event loop poller : " << poller->Name();
+    return poller;
+}
+
+PollerType Poller::ParseType(const std::string &name)
+{
+    if (name == "io_uring" || name == "iouring" || name == "uring")
+    {
+        return kPollerIoUring;
+    }
+
+    return kPollerEpoll;
+}
+
+std::shared_ptr<Event> Poller::FindEvent(int fd) const
+{
+    // 事件表以文件描述符为下标
+    if (fd < 0 || fd >= static_cast<int>(loop_->events_.size()))
+    {
+        return std::shared_ptr<Event>();
+    }
+
+    return loop_->events_[fd];
+}
+
+void Poller::UpdateTime()
+{
+    loop_->now_ms_ = lss::base::TTime::NowMS();
+}
+
+void Poller::BeginWait()
+{
+    loop_->wait_begin_ns_ = lss::base::TTime::MonotonicNS();
+}
+
+void Poller::EndWait()
+{
+    int64_t now = lss::base::TTime::MonotonicNS();
+    loop_->idle_ns_ += now - loop_->wait_begin_ns_;
+    loop_->wake_ns_ = now;
+}
+
+void Poller::DispatchEvent(Event *event, uint32_t revents)
+{
+    // 如果发生错误，事件没有从错误队列中处理掉时，获取错误信息并调用 OnError 函数进行处理
+    if ((revents & EPOLLERR) && !event->OnErrorQueue())
+    {
+        int error = 0;
+        socklen_t len = sizeof(error);
+        getsockopt(event->Fd(), SOL_SOCKET, SO_ERROR, &error, &len);
+
+        event->OnError(strerror(error));
+        return;
+    }
+
+    if ((revents & EPOLLHUP) && !(revents & EPOLLIN))
+    {
+        // 处理关闭事件，调用 OnClose 函数
+        event->OnClose();
+        return;
+    }
+
+    // 边缘触发模式下读写事件可能同时到达，两者都要处理，否则丢失的可写事件不会再次通知
+    if (revents & (EPOLLIN | EPOLLPRI))
+    {
+        // 处理读事件，调用 OnRead 函数
+        event->OnRead();
+    }
+    if (revents & EPOLLOUT)
+    {
+        // 处理写事件，调用 OnWrite 函数
+        event->OnWrite();
+    }
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <string>
+#include <memory>
+#include <sys/uio.h>
+
+namespace lss
+{
+    namespace network
+    {
+        class EventLoop;
+        class Event;
+
+        // 事件循环使用的多路复用后端
+        enum PollerType
+        {
+            kPollerEpoll = 0,   // epoll，就绪通知模式
+            kPollerIoUring,     // io_uring，完成通知模式
+        };
+
+        // 多路复用后端的抽象，负责事件的注册、等待和分发
+        // 事件表仍然由 EventLoop 维护，Poller 只负责与内核交互
+        class Poller
+        {
+        public:
+            // 构造函数，接收所属的事件循环
+            explicit Poller(EventLoop *loop);
+
+            virtual ~Poller() = default;
+
+            // 初始化后端，失败时返回 false，由调用者退回 epoll
+            virtual bool Init() = 0;
+
+            // 注册事件，监听 event->event_ 中的事件
+            virtual void AddEvent(Event *event) = 0;
+
+            // 注销事件，必须在关闭文件描述符之前调用
+            virtual void DelEvent(Event *event) = 0;
+
+            // event->event_ 发生变化后更新监听的事件
+            virtual void UpdateEvent(Event *event) = 0;
+
+            // 等待事件并分发，timeout_ms 为最长等待时间，返回分发的事件数量，出错返回 -1
+            virtual int Poll(int timeout_ms) = 0;
+
+            // 是否支持由后端完成读写的异步 IO
+            virtual bool SupportAsyncIo() const
+            {
+                return false;
+            }
+
+            // 异步发送 iov 中的数据，超过 timeout_ms 没有完成则取消，完成后回调 event->OnSendComplete
+            // iov 数组只需要在本次调用期间有效，数据本身需要保持有效直到完成回调
+            virtual bool AsyncSend(Event *event, const struct iovec *iov, int count, int timeout_ms)
+            {
+                return false;
+            }
+
+            // 后端名称
+            virtual const char *Name() const = 0;
+
+            // 创建指定类型的后端，初始化失败时退回 epoll
+            static std::unique_ptr<Poller> NewPoller(EventLoop *loop, PollerType type);
+
+            // 将配置中的名称转换为后端类型，无法识别时返回 epoll
+            static PollerType ParseType(const std::string &name);
+
+        protected:
+            // 根据文件描述符查找已注册的事件，返回共享指针，保证分发期间事件不会被销毁
+            std::shared_ptr<Event> FindEvent(int fd) const;
+
+            // 按照就绪事件掩码分发给事件的 OnError、OnClose、OnRead 或 OnWrite
+            void DispatchEvent(Event *event, uint32_t revents);
+
+            // 醒来之后、分发事件之前更新事件循环缓存的当前时间
+            void UpdateTime();
+
+            // 即将阻塞等待事件，记录开始时间
+            void BeginWait();
+
+            // 等待结束，累计阻塞的时间，供事件循环统计繁忙程度
+            void EndWait();
+
+            // 所属的事件循环
+            EventLoop *loop_{nullptr};
+        };
+    }
+}
@@ -0,0 +1,147 @@
+#include "TaskQueue.h"
+
+using namespace lss::network;
+
+TaskQueue::TaskQueue(uint32_t pool_size)
+: pool_(new TaskNode[pool_size])    // 预先分配对象池
+, pool_size_(pool_size)
+, head_(&stub_)                 // 空队列的头尾都指向哨兵节点
+, tail_(&stub_)
+{
+    // 将对象池中的节点串成空闲栈
+    for (uint32_t i = 0; i < pool_size_; i++)
+    {
+        pool_[i].index = i;
+        pool_[i].free_next.store(i + 1 < pool_size_ ? i + 1 : kHeapTask, std::memory_order_relaxed);
+    }
+
+    // 栈顶指向第一个节点，对象池为空时栈顶为空
+    free_head_.store(pool_size_ > 0 ? 0 : kHeapTask, std::memory_order_relaxed);
+}
+
+TaskQueue::~TaskQueue()
+{
+    // 销毁尚未执行的任务
+    TaskNode *task = nullptr;
+    while ((task = Pop()) != nullptr)
+    {
+        Release(task);
+    }
+}
+
+TaskNode *TaskQueue::Acquire()
+{
+    uint64_t head = free_head_.load(std::memory_order_acquire);
+
+    while (true)
+    {
+        uint32_t index = (uint32_t)head;
+
+        // 对象池已耗尽，临时从堆上分配一个节点
+        if (index == kHeapTask)
+        {
+            TaskNode *task = new TaskNode();
+            task->index = kHeapTask;
+            return task;
+        }
+
+        // 弹出栈顶节点，同时增加版本号，避免栈顶被其他线程弹出又压回时误判
+        uint32_t next = pool_[index].free_next.load(std::memory_order_relaxed);
+        uint64_t new_head = (((head >> 32) + 1) << 32) | next;
+
+        if (free_head_.compare_exchange_weak(head, new_head, std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            return &pool_[index];
+        }
+    }
+}
+
+void TaskQueue::Push(TaskNode *task)
+{
+    Enqueue(task);
+}
+
+void TaskQueue::Enqueue(TaskNode *task)
+{
+    task->next.store(nullptr, std::memory_order_relaxed);
+
+    // 交换队列头，再把前一个节点链接到当前节点
+    // 两步之间消费者可能看到断开的链表，此时 Pop 返回 nullptr，Empty 返回 false
+    TaskNode *prev = head_.exchange(task, std::memory_order_seq_cst);
+    prev->next.store(task, std::memory_order_release);
+}
+
+TaskNode *TaskQueue::Pop()
+{
+    TaskNode *tail = tail_;
+    TaskNode *next = tail->next.load(std::memory_order_acquire);
+
+    // 跳过哨兵节点
+    if (tail == &stub_)
+    {
+        if (next == nullptr)
+        {
+            return nullptr;
+        }
+
+        tail_ = next;
+        tail = next;
+        next = next->next.load(std::memory_order_acquire);
+    }
+
+    // 后面还有节点，直接取出当前节点
+    if (next)
+    {
+        tail_ = next;
+        return tail;
+    }
+
+    // 当前节点不是最后一个，说明生产者正在入队，稍后再取
+    TaskNode *head = head_.load(std::memory_order_acquire);
+    if (tail != head)
+    {
+        return nullptr;
+    }
+
+    // 当前节点是最后一个，重新放入哨兵节点后才能取出
+    Enqueue(&stub_);
+
+    next = tail->next.load(std::memory_order_acquire);
+    if (next)
+    {
+        tail_ = next;
+        return tail;
+    }
+
+    return nullptr;
+}
+
+void TaskQueue::Release(TaskNode *task)
+{
+    // 销毁任务内容
+    task->func.Reset();
+
+    // 临时分配的节点直接释放
+    if (task->index == kHeapTask)
+    {
+        delete task;
+        return;
+    }
+
+    // 压回空闲栈
+    uint64_t head = free_head_.load(std::memory_order_relaxed);
+    uint64_t new_head = 0;
+
+    do
+    {
+        task->free_next.store((uint32_t)head, std::memory_order_relaxed);
+        new_head = (((head >> 32) + 1) << 32) | task->index;
+    }
+    while (!free_head_.compare_exchange_weak(head, new_head, std::memory_order_release, std::memory_order_relaxed));
+}
+
+bool TaskQueue::Empty() const
+{
+    // 尾部是哨兵节点并且没有生产者追加过新节点
+    return tail_ == &stub_ && head_.load(std::memory_order_seq_cst) == &stub_;
+}
@@ -0,0 +1,183 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <memory>
+
+namespace lss
+{
+    namespace network
+    {
+        // 小缓冲区可调用对象，捕获内容不超过 kInlineSize 字节时直接构造在内部缓冲区中，不再分配堆内存
+        class TaskFunc
+        {
+        public:
+            // 内部缓冲区大小
+            static const size_t kInlineSize = 64;
+
+            TaskFunc() = default;
+
+            TaskFunc(const TaskFunc&) = delete;
+            TaskFunc &operator=(const TaskFunc&) = delete;
+
+            ~TaskFunc()
+            {
+                Reset();
+            }
+
+            // 保存可调用对象
+            template <typename F>
+            void Set(F &&f)
+            {
+                using T = typename std::decay<F>::type;
+
+                Reset();
+
+                // 放得下并且对齐满足要求时使用内部缓冲区，否则退化为堆分配
+                // 编译期选择分支，放不下的类型不会生成在内部缓冲区中构造的代码
+                Construct<T>(std::forward<F>(f), std::integral_constant<bool,
+                    sizeof(T) <= kInlineSize && alignof(T) <= alignof(std::max_align_t)>());
+
+                invoke_ = &Invoke<T>;
+            }
+
+            // 调用保存的可调用对象
+            void operator()()
+            {
+                invoke_(target_);
+            }
+
+            // 销毁保存的可调用对象
+            void Reset()
+            {
+                if (destroy_)
+                {
+                    destroy_(target_);
+                }
+
+                target_ = nullptr;
+                invoke_ = nullptr;
+                destroy_ = nullptr;
+            }
+
+        private:
+            template <typename T, typename F>
+            void Construct(F &&f, std::true_type)
+            {
+                target_ = new (&storage_) T(std::forward<F>(f));
+                destroy_ = &DestroyInline<T>;
+            }
+
+            template <typename T, typename F>
+            void Construct(F &&f, std::false_type)
+            {
+                target_ = new T(std::forward<F>(f));
+                destroy_ = &DestroyHeap<T>;
+            }
+
+            template <typename T>
+            static void Invoke(void *p)
+            {
+                (*static_cast<T*>(p))();
+            }
+
+            template <typename T>
+            static void DestroyInline(void *p)
+            {
+                static_cast<T*>(p)->~T();
+            }
+
+            template <typename T>
+            static void DestroyHeap(void *p)
+            {
+                delete static_cast<T*>(p);
+            }
+
+            // 内部缓冲区
+            typename std::aligned_storage<kInlineSize, alignof(std::max_align_t)>::type storage_;
+
+            // 指向可调用对象，位于内部缓冲区或者堆上
+            void *target_{nullptr};
+
+            // 调用函数
+            void (*invoke_)(void*){nullptr};
+
+            // 销毁函数
+            void (*destroy_)(void*){nullptr};
+        };
+
+        // 任务节点，同时也是侵入式队列的链表节点
+        struct TaskNode
+        {
+            // 队列中的下一个节点
+            std::atomic<TaskNode*> next{nullptr};
+
+            // 空闲链表中的下一个节点下标
+            std::atomic<uint32_t> free_next{0};
+
+            // 节点在对象池中的下标，kHeapTask 表示对象池耗尽时临时从堆上分配的节点
+            uint32_t index{0};
+
+            // 任务内容
+            TaskFunc func;
+        };
+
+        // 多生产者单消费者的侵入式无锁任务队列
+        // 任意线程可以调用 Acquire 和 Push，只有事件循环所在线程可以调用 Pop、Release 和 Empty
+        // 任务节点来自预先分配的对象池，空闲节点用带版本号的下标栈管理，稳定运行时投递任务不分配内存
+        class TaskQueue
+        {
+        public:
+            // 对象池耗尽时临时分配节点的下标
+            static const uint32_t kHeapTask = 0xFFFFFFFF;
+
+            // 构造函数，pool_size 为对象池中的节点数量
+            explicit TaskQueue(uint32_t pool_size = 1024);
+
+            ~TaskQueue();
+
+            TaskQueue(const TaskQueue&) = delete;
+            TaskQueue &operator=(const TaskQueue&) = delete;
+
+            // 获取一个空闲的任务节点
+            TaskNode *Acquire();
+
+            // 将任务节点加入队列
+            void Push(TaskNode *task);
+
+            // 取出一个任务节点，队列为空或者生产者正在入队时返回 nullptr
+            TaskNode *Pop();
+
+            // 执行完毕后归还任务节点
+            void Release(TaskNode *task);
+
+            // 队列是否为空，生产者正在入队时也视为非空
+            bool Empty() const;
+
+        private:
+            // 入队，不区分任务节点和哨兵节点
+            void Enqueue(TaskNode *task);
+
+            // 对象池
+            std::unique_ptr<TaskNode[]> pool_;
+
+            // 对象池大小
+            uint32_t pool_size_{0};
+
+            // 空闲栈顶，高 32 位为版本号，低 32 位为节点下标，用于避免 ABA 问题
+            std::atomic<uint64_t> free_head_{0};
+
+            // 队列头，生产者在此处追加
+            std::atomic<TaskNode*> head_;
+
+            // 队列尾，只由消费者访问
+            TaskNode *tail_{nullptr};
+
+            // 哨兵节点
+            TaskNode stub_;
+        };
+    }
+}
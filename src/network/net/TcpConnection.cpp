@@ -1,4 +1,9 @@
 #include <unistd.h>
+#include <climits>
+#include <cstring>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <linux/errqueue.h>
 #include "TcpConnection.h"
 #include "network/base/Network.h"
 
@@ -7,7 +12,8 @@ using namespace lss::network;
 TcpConnection::TcpConnection(EventLoop *loop, int sockfd, const InetAddress &localAddr, const InetAddress &peerAddr)
     : Connection(loop, sockfd, localAddr, peerAddr)     // 初始化基类 Connection，传递参数
 {
-
+    // 以边缘触发方式一次性注册读写事件，发送时不再切换可写事件，可写状态由连接自己记录
+    event_ = kEventRead | kEventWrite;
 }
 
 void TcpConnection::SetCloseCallback(const CloseConnectionCallback &cb)
@@ -37,7 +43,7 @@ void TcpConnection::OnClose()
         if (close_cb_)
         {
             // 调用关闭回调，并将当前对象转换为 TcpConnection 的共享指针
-            close_cb_(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()));
+            close_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()));
         }
     }
 
@@ -76,17 +82,28 @@ void TcpConnection::OnRead()
     {
         // 初始化错误码
         int err = 0;
+
+        // 上层提示了正在接收的消息的剩余长度，先预留空间，数据直接读入接收缓冲区
+        if (read_hint_ > 0)
+        {
+            message_buffer_.EnsureWritableBytes(read_hint_);
+            read_hint_ = 0;
+        }
+
         // 从文件描述符 fd_ 中读取数据到 message_buffer_，并获取返回值和错误码
         auto ret = message_buffer_.ReadFd(fd_, &err);
 
         // 如果成功读取到数据
         if (ret > 0)
         {
+            // 计入事件循环的流量
+            loop_->AddTraffic(ret);
+
             // 检查是否设置了消息回调
             if (message_cb_)
             {
                 // 调用消息回调，传递当前对象的共享指针和消息缓冲区
-                message_cb_(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()), message_buffer_);
+                message_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()), message_buffer_);
             }
         }
         // 如果返回值为 0，表示对端关闭了连接
@@ -147,87 +164,152 @@ void TcpConnection::OnWrite()
 
     ExtendLife();
 
-    // 检查待写入的数据列表是否为空
-    if (!io_vec_list_.empty())
+    // 边缘触发的可写事件只在发送缓冲区从满变为可写时到达，记录可写状态
+    writable_ = true;
+
+    // 检查待写入的数据列表是否为空，为空时只记录状态，等待下一次发送时直接写入
+    if (!io_vec_list_.Empty())
     {
-        // 开始一个无限循环，直到手动中断
-        while (true)
+        WriteInLoop();
+    }
+}
+
+void TcpConnection::WriteInLoop()
+{
+    // 开始一个无限循环，直到手动中断
+    while (!io_vec_list_.Empty())
+    {
+        // 每次最多写入 IOV_MAX 个数据块，超出的部分在下一轮写入
+        int count = io_vec_list_.Batch(IOV_MAX);
+        ssize_t ret = -1;
+
+        // 积压的数据足够多时使用零拷贝发送，内核直接引用用户内存，完成后通过错误队列通知
+        bool zerocopy = zerocopy_threshold_ > 0 && io_vec_list_.Bytes() >= zerocopy_threshold_;
+        if (zerocopy)
         {
-            // 使用 writev 函数将数据写入文件描述符 fd_
-            auto ret = ::writev(fd_, &io_vec_list_[0], io_vec_list_.size());
+            struct msghdr msg;
+            memset(&msg, 0x00, sizeof(msg));
+            msg.msg_iov = const_cast<struct iovec*>(io_vec_list_.Front());
+            msg.msg_iovlen = count;
 
-            // 如果写入成功
-            if (ret >= 0)
+            ret = ::sendmsg(fd_, &msg, MSG_ZEROCOPY | MSG_NOSIGNAL);
+            if (ret > 0)
             {
-                // 处理写入的字节数
-                while (ret > 0)
-                {
-                    // 如果当前数据块的长度大于已写入的字节数
-                    if (io_vec_list_.front().iov_len > ret)
-                    {
-                        // 更新当前数据块的基地址，移动已写入的字节数
-                        io_vec_list_.front().iov_base = (char*)io_vec_list_.front().iov_base + ret;
-                        // 更新当前数据块的长度，减少已写入的字节数
-                        io_vec_list_.front().iov_len -= ret;
-                        // 退出内层循环
-                        break;
-                    }
-                    else // 如果当前数据块的长度小于或等于已写入的字节数
-                    {
-                        // 减去当前数据块的长度
-                        ret -= io_vec_list_.front().iov_len;
-                        // 移除已写入的数据块
-                        io_vec_list_.erase(io_vec_list_.begin());
-                    }
-                }
-
-                // 如果所有数据块都已写入
-                if (io_vec_list_.empty())
-                {
-                    // 禁用写入
-                    EnableWriting(false);
-
-                    // 检查是否设置了写入完成的回调
-                    if (write_complete_cb_)
-                    {
-                        // 调用写入完成的回调，传递当前对象的共享指针
-                        write_complete_cb_(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()));
-                    }
-
-                    // 退出函数
-                    return;
-                }
+                ++zerocopy_pending_;
             }
-            else // 如果写入失败
+            else if (ret < 0 && errno == ENOBUFS)
             {
-                // 检查错误码是否为中断、暂时不可用或非阻塞
-                if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
-                {
-                    // 记录写入错误的日志
-                    NETWORK_ERROR << " host : " << peer_addr_.ToIpPort() << " write err : " << errno;
-                    // 调用关闭连接的函数
-                    OnClose();
-                    // 退出函数
-                    return;
-                }
-
-                // 退出循环
-                break;
+                // 内核锁定内存的额度不足，这一次退回普通写入
+                zerocopy = false;
             }
         }
-    }
-    else // 如果待写入的数据列表为空
-    {
-        // 禁用写入
-        EnableWriting(false);
 
-        // 检查是否设置了写入完成的回调
-        if(write_complete_cb_)
+        // 使用 writev 函数将数据写入文件描述符 fd_
+        if (!zerocopy)
         {
-            // 调用写入完成的回调，传递当前对象的共享指针
-            write_complete_cb_(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()));
+            ret = ::writev(fd_, io_vec_list_.Front(), count);
         }
+
+        // 如果写入成功
+        if (ret >= 0)
+        {
+            // 处理写入的字节数
+            io_vec_list_.Consume(ret);
+            loop_->AddTraffic(ret);
+
+            // 积压的数据减少，检查是否回落到低水位
+            CheckLowWaterMark();
+        }
+        else // 如果写入失败
+        {
+            // 发送缓冲区已满，等待边缘触发的可写事件
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                writable_ = false;
+                return;
+            }
+
+            // 被信号中断，重试
+            if (errno == EINTR)
+            {
+                continue;
+            }
+
+            // 记录写入错误的日志
+            NETWORK_ERROR << " host : " << peer_addr_.ToIpPort() << " write err : " << errno;
+            // 调用关闭连接的函数
+            OnClose();
+            // 退出函数
+            return;
+        }
+    }
+
+    // 所有数据块都已写入，通知上层
+    NotifyWriteComplete();
+}
+
+void TcpConnection::OnRecv(const char *data, size_t size)
+{
+    // 检查连接是否已关闭
+    if (closed_)
+    {
+        return;
+    }
+
+    ExtendLife();
+
+    // 数据只在回调期间有效，追加到消息缓冲区
+    message_buffer_.Append(data, size);
+    loop_->AddTraffic(size);
+
+    // 调用消息回调，传递当前对象的共享指针和消息缓冲区
+    if (message_cb_)
+    {
+        message_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()), message_buffer_);
+    }
+}
+
+void TcpConnection::OnSendComplete(int res)
+{
+    send_in_flight_ = false;
+
+    // 检查连接是否已关闭
+    if (closed_)
+    {
+        return;
+    }
+
+    // 发送失败或者超时被取消
+    if (res < 0)
+    {
+        NETWORK_ERROR << " host : " << peer_addr_.ToIpPort() << " async write err : " << -res;
+        OnClose();
+        return;
+    }
+
+    ExtendLife();
+
+    // 移除已经发送的数据
+    io_vec_list_.Consume(res);
+    loop_->AddTraffic(res);
+
+    // 积压的数据减少，检查是否回落到低水位
+    CheckLowWaterMark();
+
+    // 还有数据，继续发送
+    if (!io_vec_list_.Empty())
+    {
+        StartWriting();
+        return;
     }
+
+    // 所有数据都已写入，调用写入完成的回调
+    NotifyWriteComplete();
+}
+
+bool TcpConnection::WantAsyncIo() const
+{
+    return true;
 }
 
 void TcpConnection::SetWriteCompleteCallback(const WriteCompleteCallback &cb)
@@ -250,6 +332,14 @@ void TcpConnection::Send(std::list<BufferNodePtr>&list)
     });
 }
 
+void TcpConnection::Send(const struct iovec *iov, size_t count)
+{
+    // 在事件循环中调用 SendInLoop 函数，iovec 数组由调用方持有
+    loop_->RunInLoop([this, iov, count](){
+        SendInLoop(iov, count);
+    });
+}
+
 void TcpConnection::Send(const char *buff, size_t size)
 {
     // 在事件循环中调用 SendInLoop 函数，传递缓冲区和大小
@@ -272,14 +362,14 @@ void TcpConnection::SendInLoop(const char *buff, size_t size)
     // 初始化一个变量 send_len 用于存储实际发送的字节数
     size_t send_len = 0;
 
-    // 检查 io_vec_list_ 是否为空，如果为空，表示没有待发送的数据
-    if (io_vec_list_.empty())
+    // 检查 io_vec_list_ 是否为空并且套接字可写，如果是，直接写入
+    if (io_vec_list_.Empty() && writable_)
     {
-        // 调用系统的 write 函数，将数据从 buff 发送到文件描述符 fd_，并将返回的字节数存储在 send_len 中
-        send_len = ::write(fd_, buff, size);
+        // 调用系统的 write 函数，将数据从 buff 发送到文件描述符 fd_
+        auto ret = ::write(fd_, buff, size);
 
-        // 检查 send_len 是否小于 0，表示写入失败
-        if (send_len < 0)
+        // 检查返回值是否小于 0，表示写入失败
+        if (ret < 0)
         {
             // 检查错误码 errno，如果不是中断、暂时不可用或阻塞错误，记录错误日志并调用 OnClose() 关闭连接
             if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK)
@@ -290,8 +380,16 @@ void TcpConnection::SendInLoop(const char *buff, size_t size)
                 return;
             }
 
-            // 如果写入失败但错误是可恢复的，将 send_len 设置为 0
-            send_len = 0;
+            // 发送缓冲区已满，之后等待边缘触发的可写事件
+            if (errno != EINTR && !AsyncIo())
+            {
+                writable_ = false;
+            }
+        }
+        else
+        {
+            send_len = ret;
+            loop_->AddTraffic(send_len);
         }
 
         // 从待发送的字节数中减去已成功发送的字节数
@@ -300,12 +398,8 @@ void TcpConnection::SendInLoop(const char *buff, size_t size)
         // 检查 size 是否为 0，通常表示没有数据需要写入
         if (size == 0)
         {
-            // 如果 write_complete_cb_（写完成的回调函数）存在，则执行以下操作
-            if (write_complete_cb_)
-            {
-                // 使用 std::dynamic_pointer_cast 将当前对象（通过 shared_from_this() 获取）转换为 TcpConnection 类型的智能指针，并调用回调函数
-                write_complete_cb_(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()));
-            }
+            // 通知上层写入完成，之前的零拷贝发送尚未完成时会推迟
+            NotifyWriteComplete();
 
             // 结束当前函数的执行
             return;
@@ -315,18 +409,14 @@ void TcpConnection::SendInLoop(const char *buff, size_t size)
     // 如果还有未发送的数据
     if (size > 0)
     {
-        // 创建一个 iovec 结构体
-        struct iovec vec;
-        // 设置 iov_base 为 buff 的偏移地址，指向未发送的数据
-        vec.iov_base = (void*)(buff + send_len);
-        // 设置 iov_len 为剩余的待发送字节数
-        vec.iov_len = size;
-        
-        // 将 iovec 结构体添加到 io_vec_list_ 中，准备后续发送
-        io_vec_list_.push_back(vec);
+        // 将未发送的部分添加到 io_vec_list_ 中，准备后续发送
+        io_vec_list_.Push(buff + send_len, size);
 
-        // 调用 EnableWriting 函数，启用写入操作
-        EnableWriting(true);
+        // 启用写入操作
+        StartWriting();
+
+        // 写不完的部分留在队列中，检查是否越过高水位
+        CheckHighWaterMark();
     }
 }
 
@@ -342,21 +432,282 @@ void TcpConnection::SendInLoop(std::list<BufferNodePtr>&list)
     // 遍历传入的 BufferNodePtr 列表
     for (auto &l : list)
     {
-        // 定义一个 iovec 结构体
-        struct iovec vec;
-        // 设置 iov_base 为当前 BufferNodePtr 的地址
-        vec.iov_base = (void*)l->addr;
-        // 设置 iov_len 为当前 BufferNodePtr 的大小
-        vec.iov_len = l->size;
-        
-        // 将 iovec 结构体添加到 io_vec_list_ 中
-        io_vec_list_.push_back(vec);
+        // 将当前 BufferNodePtr 的地址和大小添加到 io_vec_list_ 中
+        io_vec_list_.Push(l->addr, l->size);
+    }
+
+    // 如果 io_vec_list_ 不为空，启用写入操作
+    if (!io_vec_list_.Empty())
+    {
+        StartWriting();
+
+        // 写不完的部分留在队列中，检查是否越过高水位
+        CheckHighWaterMark();
+    }
+}
+
+void TcpConnection::SendInLoop(const struct iovec *iov, size_t count)
+{
+    // 检查连接是否已关闭。如果是，记录日志并返回
+    if (closed_)
+    {
+        NETWORK_TRACE << " host : " << peer_addr_.ToIpPort() << " had closed.";
+        return;
+    }
+
+    // 只复制 iovec 本身，环形队列的容量够用时不分配内存
+    for (size_t i = 0; i < count; i++)
+    {
+        io_vec_list_.Push(iov[i].iov_base, iov[i].iov_len);
     }
 
-    // 如果 io_vec_list_ 不为空，调用 EnableWriting(true); 启用写入操作
-    if (!io_vec_list_.empty())
+    if (!io_vec_list_.Empty())
     {
-        EnableWriting(true);
+        StartWriting();
+
+        // 写不完的部分留在队列中，检查是否越过高水位
+        CheckHighWaterMark();
+    }
+}
+
+bool TcpConnection::EnableZeroCopy(size_t threshold)
+{
+    // 异步 IO 模式下读写由后端完成，收不到错误队列的通知
+    if (AsyncIo())
+    {
+        NETWORK_WARNING << " host : " << peer_addr_.ToIpPort() << " zerocopy is not supported in async io mode.";
+        return false;
+    }
+
+    int on = 1;
+    if (::setsockopt(fd_, SOL_SOCKET, SO_ZEROCOPY, &on, sizeof(on)) < 0)
+    {
+        NETWORK_WARNING << " host : " << peer_addr_.ToIpPort() << " enable zerocopy failed, err : " << errno;
+        return false;
+    }
+
+    zerocopy_threshold_ = threshold > 0 ? threshold : 1;
+    return true;
+}
+
+bool TcpConnection::OnErrorQueue()
+{
+    // 没有使用过零拷贝，按普通错误处理
+    if (closed_ || (zerocopy_threshold_ == 0 && zerocopy_pending_ == 0))
+    {
+        return false;
+    }
+
+    // 读取错误队列中的所有通知，每个通知表示一段连续编号的零拷贝发送已经完成
+    while (true)
+    {
+        char control[128];
+        struct msghdr msg;
+        memset(&msg, 0x00, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+
+        if (::recvmsg(fd_, &msg, MSG_ERRQUEUE) < 0)
+        {
+            break;
+        }
+
+        for (struct cmsghdr *cm = CMSG_FIRSTHDR(&msg); cm; cm = CMSG_NXTHDR(&msg, cm))
+        {
+            if (!((cm->cmsg_level == SOL_IP && cm->cmsg_type == IP_RECVERR) 
+                || (cm->cmsg_level == SOL_IPV6 && cm->cmsg_type == IPV6_RECVERR)))
+            {
+                continue;
+            }
+
+            auto serr = reinterpret_cast<struct sock_extended_err*>(CMSG_DATA(cm));
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY)
+            {
+                continue;
+            }
+
+            // 编号范围 [ee_info, ee_data]，按无符号数计算可以处理回绕
+            uint32_t done = serr->ee_data - serr->ee_info + 1;
+            zerocopy_pending_ = done < zerocopy_pending_ ? zerocopy_pending_ - done : 0;
+
+            // 内核退化为拷贝（例如本机回环），零拷贝只会增加额外的开销，之后不再使用
+            if ((serr->ee_code & SO_EE_CODE_ZEROCOPY_COPIED) && zerocopy_threshold_ > 0)
+            {
+                NETWORK_DEBUG << " host : " << peer_addr_.ToIpPort() << " zerocopy fell back to copy, disable it.";
+                zerocopy_threshold_ = 0;
+            }
+        }
+    }
+
+    // 错误队列之外还有真正的套接字错误
+    int error = 0;
+    socklen_t len = sizeof(error);
+    ::getsockopt(fd_, SOL_SOCKET, SO_ERROR, &error, &len);
+    if (error != 0)
+    {
+        OnError(strerror(error));
+        return true;
+    }
+
+    // 零拷贝发送全部完成，补发推迟的写入完成通知
+    if (zerocopy_pending_ == 0 && write_complete_deferred_ && io_vec_list_.Empty())
+    {
+        write_complete_deferred_ = false;
+        NotifyWriteComplete();
+    }
+
+    return true;
+}
+
+void TcpConnection::NotifyWriteComplete()
+{
+    // 内核仍在引用用户内存，上层此时释放或复用数据会破坏正在发送的内容
+    if (zerocopy_pending_ > 0)
+    {
+        write_complete_deferred_ = true;
+        return;
+    }
+
+    if (!write_complete_cb_)
+    {
+        return;
+    }
+
+    auto self = std::static_pointer_cast<TcpConnection>(shared_from_this());
+
+    // 上层在发送函数返回之后才更新自己的发送状态，同步回调会在发送过程中重入上层
+    if (writing_inline_)
+    {
+        loop_->QueueInLoop([self](){
+            self->RunWriteComplete();
+        });
+        return;
+    }
+
+    write_complete_cb_(self);
+}
+
+void TcpConnection::RunWriteComplete()
+{
+    if (closed_ || !write_complete_cb_)
+    {
+        return;
+    }
+
+    // 投递之后连接迁移到了其他事件循环，转到新的事件循环执行
+    if (!loop_->IsInLoopThread())
+    {
+        auto self = std::static_pointer_cast<TcpConnection>(shared_from_this());
+        loop_->RunInLoop([self](){
+            self->RunWriteComplete();
+        });
+        return;
+    }
+
+    write_complete_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()));
+}
+
+bool TcpConnection::Detach(EventLoop *loop)
+{
+    loop_->AssertInLoopThread();
+
+    // 异步 IO 的提交项和完成项属于当前事件循环的后端，发送队列和零拷贝通知也要在当前事件循环中处理完
+    if (closed_ || AsyncIo() || send_in_flight_ || !io_vec_list_.Empty() 
+        || zerocopy_pending_ > 0 || write_complete_deferred_)
+    {
+        return false;
+    }
+
+    // 空闲检查定时器属于当前事件循环的时间轮
+    loop_->CancelTimer(&idle_timer_);
+
+    // 注销之后当前事件循环不再分发该连接的事件，之前投递的任务发现所属事件循环变化后会转到新的事件循环
+    loop_->DelEvent(shared_from_this());
+    loop_ = loop;
+
+    return true;
+}
+
+void TcpConnection::Attach()
+{
+    loop_->AssertInLoopThread();
+
+    if (closed_)
+    {
+        return;
+    }
+
+    // 边缘触发模式下注册时内核会检查一次就绪状态，迁移期间到达的数据不会丢失
+    loop_->AddEvent(shared_from_this());
+
+    ExtendLife();
+    if (max_idle_time_ > 0)
+    {
+        EnableCheckIdleTimeout(max_idle_time_);
+    }
+}
+
+void TcpConnection::SetWaterMark(size_t low, size_t high)
+{
+    low_water_mark_ = low;
+    high_water_mark_ = high;
+}
+
+void TcpConnection::SetHighWaterMarkCallback(const WaterMarkCallback &cb)
+{
+    high_water_cb_ = cb;
+}
+
+void TcpConnection::SetHighWaterMarkCallback(WaterMarkCallback &&cb)
+{
+    high_water_cb_ = std::move(cb);
+}
+
+void TcpConnection::SetLowWaterMarkCallback(const WaterMarkCallback &cb)
+{
+    low_water_cb_ = cb;
+}
+
+void TcpConnection::SetLowWaterMarkCallback(WaterMarkCallback &&cb)
+{
+    low_water_cb_ = std::move(cb);
+}
+
+void TcpConnection::CheckHighWaterMark()
+{
+    // 没有设置高水位、已经越过或者连接已关闭
+    if (high_water_mark_ == 0 || above_high_water_ || closed_)
+    {
+        return;
+    }
+
+    if (io_vec_list_.Bytes() >= high_water_mark_)
+    {
+        above_high_water_ = true;
+
+        if (high_water_cb_)
+        {
+            high_water_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()));
+        }
+    }
+}
+
+void TcpConnection::CheckLowWaterMark()
+{
+    // 只有越过高水位之后才需要通知回落，避免在水位附近反复调用
+    if (!above_high_water_ || closed_)
+    {
+        return;
+    }
+
+    if (io_vec_list_.Bytes() <= low_water_mark_)
+    {
+        above_high_water_ = false;
+
+        if (low_water_cb_)
+        {
+            low_water_cb_(std::static_pointer_cast<TcpConnection>(shared_from_this()));
+        }
     }
 }
 
@@ -369,15 +720,48 @@ void TcpConnection::OnTimeout()
 
 void TcpConnection::EnableCheckIdleTimeout(int32_t max_time)
 {
-    auto tp = std::make_shared<TimeoutEntry>(std::dynamic_pointer_cast<TcpConnection>(shared_from_this()));
     max_idle_time_ = max_time;
-    timeout_entry_ = tp;
-    loop_->InsertEntry(max_time, tp);
+
+    // 不检查空闲超时，取消已经插入的定时器
+    if (max_time <= 0)
+    {
+        loop_->CancelTimer(&idle_timer_);
+        return;
+    }
+
+    // 读写时只记录活跃时间，定时器到期时才比较，不再每次读写都重新插入时间轮
+    // 定时器嵌入在连接中，连接销毁时自动从时间轮摘除，回调中可以直接使用 this
+    ExtendLife();
+    idle_timer_.cb = [this](){
+        CheckIdleTimeout();
+    };
+    loop_->AddTimer(&idle_timer_, (int64_t)max_time * 1000);
+}
+
+void TcpConnection::CheckIdleTimeout()
+{
+    if (closed_)
+    {
+        return;
+    }
+
+    int64_t now = loop_->NowMS();
+    int64_t deadline = last_active_ + (int64_t)max_idle_time_ * 1000;
+
+    // 期间有过读写，按剩余时间重新插入
+    if (now < deadline)
+    {
+        loop_->AddTimer(&idle_timer_, deadline - now);
+        return;
+    }
+
+    // 关闭连接可能释放最后一个引用，之后不能再访问成员
+    OnTimeout();
 }
 
 void TcpConnection::SetTimeoutCallback(int timeout, const TimeoutCallback &cb)
 {
-    auto cp = std::dynamic_pointer_cast<TcpConnection>(shared_from_this());
+    auto cp = std::static_pointer_cast<TcpConnection>(shared_from_this());
     loop_->RunAfter(timeout, [&cp, &cb](){
         cb(cp);
     });
@@ -385,19 +769,42 @@ void TcpConnection::SetTimeoutCallback(int timeout, const TimeoutCallback &cb)
 
 void TcpConnection::SetTimeoutCallback(int timeout, TimeoutCallback &&cb)
 {
-    auto cp = std::dynamic_pointer_cast<TcpConnection>(shared_from_this());
+    auto cp = std::static_pointer_cast<TcpConnection>(shared_from_this());
     loop_->RunAfter(timeout, [&cp, cb](){
         cb(cp);
     });
 }
 
-void TcpConnection::ExtendLife()
+void TcpConnection::StartWriting()
 {
-    auto tp = timeout_entry_.lock();
+    // 就绪通知模式，套接字可写时直接写入，否则等待边缘触发的可写事件，不需要修改注册的事件
+    if (!AsyncIo())
+    {
+        if (writable_)
+        {
+            writing_inline_ = true;
+            WriteInLoop();
+            writing_inline_ = false;
+        }
+        return;
+    }
+
+    // 异步 IO 模式，同一时间只有一个发送，完成后再发送剩余的数据
+    if (send_in_flight_ || io_vec_list_.Empty())
+    {
+        return;
+    }
 
-    if (tp)
+    // 发送超过最大空闲时间仍未完成，认为对端已经失效，不检查空闲超时时使用默认的 30 秒
+    int32_t timeout = max_idle_time_ > 0 ? max_idle_time_ : 30;
+    if (loop_->AsyncSend(this, io_vec_list_.Front(), io_vec_list_.Batch(IOV_MAX), timeout * 1000))
+    {
+        send_in_flight_ = true;
+    }
+    else
     {
-        loop_->InsertEntry(max_idle_time_, tp);
+        NETWORK_ERROR << " host : " << peer_addr_.ToIpPort() << " async write submit failed.";
+        OnClose();
     }
 }
 
@@ -5,6 +5,7 @@
 #include <list>
 #include <sys/uio.h>
 #include "Connection.h"
+#include "IoVecRing.h"
 #include "network/base/InetAddress.h"
 #include "network/base/MsgBuffer.h"
 
@@ -30,8 +31,8 @@ namespace lss
         // 定义超时回调函数类型，接受一个 TcpConnectionPtr 参数，用于处理超时事件
         using TimeoutCallback = std::function<void(const TcpConnectionPtr &)>;
 
-        // 前置声明，避免循环依赖
-        struct TimeoutEntry;
+        // 定义水位回调函数类型，接受一个 TcpConnectionPtr 参数，发送队列积压的字节数越过高水位或回落到低水位时调用
+        using WaterMarkCallback = std::function<void(const TcpConnectionPtr &)>;
 
         class TcpConnection : public Connection // 继承自 Connection 类，包含与 TCP 连接相关的功能和数据成员
         {
@@ -63,9 +64,21 @@ namespace lss
             // 发生错误时调用的函数
             void OnError(const std::string &msg) override;
 
+            // 读取错误队列中的零拷贝发送完成通知
+            bool OnErrorQueue() override;
+
             // 写入数据时调用的函数
             void OnWrite() override;
 
+            // 异步 IO 模式下收到数据时调用的函数
+            void OnRecv(const char *data, size_t size) override;
+
+            // 异步 IO 模式下一次发送完成时调用的函数
+            void OnSendComplete(int res) override;
+
+            // 连接希望由后端完成读写
+            bool WantAsyncIo() const override;
+
             // 设置写入完成的回调函数
             void SetWriteCompleteCallback(const WriteCompleteCallback &cb);
 
@@ -75,13 +88,62 @@ namespace lss
             // 发送数据列表的函数
             void Send(std::list<BufferNodePtr>&list);
 
+            // 发送一组 iovec 描述的数据，不拷贝数据也不创建节点，数据由调用方保证在写入完成回调之前有效
+            void Send(const struct iovec *iov, size_t count);
+
             // 发送指定大小的缓冲区数据的函数
             void Send(const char *buff, size_t size);
 
+            // 提示下一次读取之前至少预留 bytes 字节的接收空间，只对下一次读取有效，只能在事件循环线程中调用
+            // 上层解析到一半的大消息时设置，剩余的数据一次读入接收缓冲区，不再经过栈上的临时缓冲区
+            void SetReadHint(size_t bytes)
+            {
+                read_hint_ = bytes;
+            }
+
+            // 发送队列中尚未写入套接字的字节数，只能在事件循环线程中调用
+            size_t QueuedBytes() const
+            {
+                return io_vec_list_.Bytes();
+            }
+
+            // 开启零拷贝发送，待发送的数据不少于 threshold 字节时使用 MSG_ZEROCOPY，返回是否开启成功
+            // 只支持就绪通知模式，开启后写入完成的回调要等内核通知零拷贝发送完成后才调用，数据需要保持有效到那时
+            bool EnableZeroCopy(size_t threshold);
+
+            // 设置发送队列的低水位和高水位，单位：字节，高水位为 0 时不检查
+            void SetWaterMark(size_t low, size_t high);
+
+            // 设置积压的字节数达到高水位时的回调函数
+            void SetHighWaterMarkCallback(const WaterMarkCallback &cb);
+
+            // 设置积压的字节数达到高水位时的回调函数（右值引用）
+            void SetHighWaterMarkCallback(WaterMarkCallback &&cb);
+
+            // 设置越过高水位之后积压的字节数回落到低水位时的回调函数
+            void SetLowWaterMarkCallback(const WaterMarkCallback &cb);
+
+            // 设置越过高水位之后积压的字节数回落到低水位时的回调函数（右值引用）
+            void SetLowWaterMarkCallback(WaterMarkCallback &&cb);
+
+            // 积压的字节数是否越过了高水位且尚未回落到低水位
+            bool AboveHighWaterMark() const
+            {
+                return above_high_water_;
+            }
+
+            // 从当前事件循环注销，准备迁移到 loop，只能在当前事件循环线程中调用
+            // 连接已关闭、使用异步 IO、还有数据没有写完或者零拷贝发送没有完成时不能迁移，返回 false
+            // 成功后连接不再属于任何事件循环，直到在 loop 的线程中调用 Attach
+            bool Detach(EventLoop *loop);
+
+            // 在 Detach 指定的事件循环中重新注册，恢复空闲检查，只能在该事件循环线程中调用
+            void Attach();
+
             // 设置超时时间
             void OnTimeout();
 
-            // 设置最大空闲时间
+            // 设置最大空闲时间，单位：秒，小于等于 0 时不检查空闲超时
             void EnableCheckIdleTimeout(int32_t max_time);
 
             // 设置超时回调函数
@@ -100,8 +162,42 @@ namespace lss
             // 在事件循环中发送数据列表的函数
             void SendInLoop(std::list<BufferNodePtr>&list);
 
-            // 在事件循环中发送指定大小的缓冲区数据的函数
-            void ExtendLife();
+            // 在事件循环中发送一组 iovec 的函数
+            void SendInLoop(const struct iovec *iov, size_t count);
+
+            // 记录连接的活跃时间，读写路径上只有一次赋值
+            void ExtendLife()
+            {
+                last_active_ = loop_->NowMS();
+            }
+
+            // 空闲检查定时器到期时调用，距离最后一次活跃已超过最大空闲时间则关闭连接，否则按剩余时间重新插入
+            void CheckIdleTimeout();
+
+            // 开始发送待写入的数据，异步 IO 模式下提交给后端，否则套接字可写时直接写入
+            void StartWriting();
+
+            // 就绪通知模式下写入待写入的数据，直到写完或者发送缓冲区已满
+            void WriteInLoop();
+
+            // 通知上层写入完成，还有零拷贝发送没有完成时推迟到内核通知完成之后
+            // 在发送函数内部直接写完时推迟到事件循环的下一轮通知，上层在回调中继续发送不会重入
+            void NotifyWriteComplete();
+
+            // 执行推迟的写入完成回调，连接已经迁移时转到新的事件循环
+            void RunWriteComplete();
+
+            // 数据入队之后检查是否越过高水位
+            void CheckHighWaterMark();
+
+            // 数据写出之后检查是否回落到低水位
+            void CheckLowWaterMark();
+
+            // 就绪通知模式下套接字是否可写，写入遇到 EAGAIN 时置为 false，收到可写事件时置为 true
+            bool writable_{true};
+
+            // 异步 IO 模式下是否有发送尚未完成
+            bool send_in_flight_{false};
 
             // 连接是否关闭的标志
             bool closed_{false};
@@ -112,47 +208,53 @@ namespace lss
             // 存储接收到的消息的缓冲区
             MsgBuffer message_buffer_;
 
+            // 下一次读取之前预留的接收空间，单位：字节
+            size_t read_hint_{0};
+
             // 接收消息时的回调函数
             MessageCallback message_cb_; 
 
-            // 存储写入事件的数据队列(内存空间连续)
-            std::vector<struct iovec> io_vec_list_;
+            // 存储写入事件的数据队列，环形队列，写完的数据只推进头部
+            IoVecRing io_vec_list_;
 
             // 写入完成时的回调函数
             WriteCompleteCallback write_complete_cb_;
 
-            // 声明了一个指向 TimeoutEntry 对象的弱指针，使用弱指针可以避免循环引用，从而防止内存泄漏
-            // 弱指针不会管理所指向对象的生命周期，因此可以指向由 std::shared_ptr 管理的对象，而不会阻止该对象被销毁
-            std::weak_ptr<TimeoutEntry> timeout_entry_;
+            // 使用零拷贝发送的最小字节数，为 0 时不使用
+            size_t zerocopy_threshold_{0};
 
-            // 连接的最大空闲时间，单位:秒
-            int32_t max_idle_time_{30};
-        };
+            // 已经发出、内核尚未通知完成的零拷贝发送次数
+            uint32_t zerocopy_pending_{0};
 
-        // 定义一个超时时间节点
-        struct TimeoutEntry
-        {
-            // 构造函数接受一个 TcpConnectionPtr 类型的常量引用 c（一个智能指针，指向 TcpConnection 对象）
-            TimeoutEntry(const TcpConnectionPtr &c)
-                : conn(c) // 使用初始化列表将 conn 成员初始化为传入的 c
-            {}
+            // 数据已经全部写入，等待零拷贝发送完成后再通知上层
+            bool write_complete_deferred_{false};
 
-            ~TimeoutEntry()
-            {
-                // 尝试将 conn 转换为一个 std::shared_ptr<TcpConnection>，如果 conn 指向的对象仍然存在（即没有被销毁），lock() 方法将返回一个有效的 shared_ptr
-                auto c = conn.lock();
-
-                // 如果 c 是有效的，则调用 c->OnTimeout(); 
-                if (c)
-                {
-                    // 在超时发生时，相关的 TcpConnection 对象将执行其 OnTimeout 方法
-                    c->OnTimeout();
-                }
-            }
+            // 正在发送函数内部直接写入，写完时不能同步调用写入完成的回调
+            bool writing_inline_{false};
+
+            // 发送队列的低水位，单位：字节
+            size_t low_water_mark_{0};
+
+            // 发送队列的高水位，单位：字节，为 0 时不检查
+            size_t high_water_mark_{0};
+
+            // 是否越过了高水位且尚未回落到低水位，两个回调交替调用
+            bool above_high_water_{false};
 
-            // conn 是一个 std::weak_ptr<TcpConnection> 类型的成员变量，用于存储指向 TcpConnection 对象的弱引用
-            // 使用弱指针可以避免循环引用，从而防止内存泄漏。
-            std::weak_ptr<TcpConnection> conn;
+            // 越过高水位时的回调函数
+            WaterMarkCallback high_water_cb_;
+
+            // 回落到低水位时的回调函数
+            WaterMarkCallback low_water_cb_;
+
+            // 空闲检查定时器，嵌入在连接中，随连接一起销毁
+            Timer idle_timer_;
+
+            // 最后一次读写的时间，单位：毫秒，取事件循环缓存的时间
+            int64_t last_active_{0};
+
+            // 连接的最大空闲时间，单位:秒
+            int32_t max_idle_time_{30};
         };
     }
 }
\ No newline at end of file
@@ -1,204 +1,350 @@
+#include <cmath>
 #include "TimingWheel.h"
 #include "network/base/Network.h"
+#include "base/TTime.h"
 
 using namespace lss::network;
 
-// 分别调整了 wheels_ 向量的每个元素的大小，用于任务或事件调度
+// 初始化每一层的槽位，每个槽位是一个带哨兵的双向循环链表
 TimingWheel::TimingWheel()
-:wheels_(4)     // 初始化 wheels_ 向量，大小为 4
 {
-    // 根据不同的时间类型进行调整
-    wheels_[kTimingTypeSecond].resize(60);  // 秒
-    wheels_[kTimingTypeMinute].resize(60);  // 分钟
-    wheels_[kTimingTypeHour].resize(24);    // 小时
-    wheels_[kTimingTypeDay].resize(30);     // 天
+    for (int level = 0; level < kTimingLevels; level++)
+    {
+        // 第一层 256 个槽位，其余各层 64 个槽位，之后不再改变大小，哨兵的地址保持不变
+        slots_[level].resize(level == 0 ? kTimingRootSize : kTimingLevelSize);
+        for (auto &slot : slots_[level])
+        {
+            slot.prev = &slot;
+            slot.next = &slot;
+        }
+    }
 }
 
 TimingWheel::~TimingWheel()
 {
-    // TimingWheel 类的成员变量 EntryPtr 是智能指针（std::shared_ptr），会自动管理内存
-    // 当 TimingWheel 对象被销毁时，智能指针会自动释放其管理的资源，不需要在析构函数中手动释放资源
+    // 摘除所有仍在等待的定时器，嵌入在其他对象中的定时器之后析构时不会再访问时间轮
+    for (int level = 0; level < kTimingLevels; level++)
+    {
+        for (auto &slot : slots_[level])
+        {
+            while (!Empty(slot))
+            {
+                static_cast<Timer*>(slot.next)->Unlink();
+            }
+        }
+    }
 }
 
-// 将一个延迟任务插入到以秒为单位的定时轮中的相应位置
-void TimingWheel::InsertSecondEntry(uint32_t delay, EntryPtr entryPtr)
+// 插入定时器，已经在时间轮中的定时器先摘除再插入，所以重复插入就是延期
+void TimingWheel::AddTimer(Timer *timer, int64_t delay)
 {
-    // 使用 delay - 1 作为索引来访问 wheels_[kTimingTypeSecond] 向量中的一个元素，随后调用该元素的 insert 方法，将 entryPtr 插入到该元素中
-    wheels_[kTimingTypeSecond][delay - 1].insert(entryPtr);
-}
+    timer->Unlink();
 
-// 将一个延迟任务插入到以分钟为单位的定时轮中的相应位置，并在延迟时间到达时调用 InsertEntry 方法
-void TimingWheel::InsertMinuteEntry(uint32_t delay, EntryPtr entryPtr)
-{
-    // 计算剩余的分钟数
-    auto minute = delay / kTimingMinute;
-    // 计算剩余的秒数
-    auto second = delay % kTimingMinute;
+    if (delay < 0)
+    {
+        delay = 0;
+    }
 
-    // 使用 std::make_shared 创建了一个名为 newEntryPtr 的 CallbackEntry 对象的共享指针，该 CallbackEntry 对象是通过 lambda 表达式创建的，
-    // 该 lambda 表达式捕获了 this 指针、second 和 entryPtr，并在调用时调用 InsertEntry 方法，将 second 和 entryPtr 作为参数传递 
-    CallbackEntryPtr newEntryPtr = std::make_shared<CallbackEntry>([this, second, entryPtr]() {
-        InsertEntry(second, entryPtr);
-    });
+    // 尚未开始计时，以插入时间作为起点
+    if (current_ == 0)
+    {
+        current_ = lss::base::TTime::NowMS();
+    }
 
-    // 将 newEntryPtr 插入到以分钟为单位的定时轮中的相应位置
-    wheels_[kTimingTypeMinute][minute - 1].emplace(newEntryPtr);
+    timer->expire = current_ + delay;
+    Place(timer);
 }
 
-// 将一个延迟任务插入到以小时为单位的定时轮中的相应位置，并在延迟时间到达时调用 InsertEntry 方法
-void TimingWheel::InsertHourEntry(uint32_t delay, EntryPtr entryPtr)
+// 取消定时器，只需要从链表中摘除
+void TimingWheel::CancelTimer(Timer *timer)
 {
-    auto hour = delay / kTimingHour;
-    auto second = delay % kTimingHour;
-
-    CallbackEntryPtr newEntryPtr = std::make_shared<CallbackEntry>([this, second, entryPtr]() {
-        InsertEntry(second, entryPtr);
-    });
-
-    wheels_[kTimingTypeHour][hour - 1].emplace(newEntryPtr);
+    // 对象池中的定时器没有对外暴露，只会在到期时归还
+    timer->Unlink();
 }
 
-// 将一个延迟任务插入到以天为单位的定时轮中的相应位置，并在延迟时间到达时调用 InsertEntry 方法
-void TimingWheel::InsertDayEntry(uint32_t delay, EntryPtr entryPtr)
+// 按照到期时间与当前时间的差值选择层，再按到期时间的对应位选择槽位
+void TimingWheel::Place(Timer *timer)
 {
-    auto day = delay / kTimingDay;
-    auto second = delay % kTimingDay;
+    int64_t expire = timer->expire;
+    int64_t idx = expire - current_;
+    TimerLink *slot = nullptr;
 
-    CallbackEntryPtr newEntryPtr = std::make_shared<CallbackEntry>([this, second, entryPtr]() {
-        InsertEntry(second, entryPtr);
-    });
+    if (idx < 0)
+    {
+        // 已经到期，放到下一个要处理的槽位
+        slot = &slots_[0][current_ & kTimingRootMask];
+    }
+    else if (idx < kTimingRootSize)
+    {
+        slot = &slots_[0][expire & kTimingRootMask];
+    }
+    else
+    {
+        // 找到能容纳该差值的层
+        int level = 1;
+        for (; level < kTimingLevels - 1; level++)
+        {
+            if (idx < (1LL << (kTimingRootBits + level * kTimingLevelBits)))
+            {
+                break;
+            }
+        }
 
-    wheels_[kTimingTypeDay][day - 1].emplace(newEntryPtr);
+        // 超出最高层的范围时按最长时间处理
+        int shift = kTimingRootBits + (level - 1) * kTimingLevelBits;
+        int64_t max_idx = (1LL << (kTimingRootBits + (kTimingLevels - 1) * kTimingLevelBits)) - 1;
+        if (idx > max_idx)
+        {
+            expire = current_ + max_idx;
+        }
+
+        slot = &slots_[level][(expire >> shift) & kTimingLevelMask];
+    }
+
+    // 插入到槽位链表的尾部
+    timer->prev = slot->prev;
+    timer->next = slot;
+    slot->prev->next = timer;
+    slot->prev = timer;
 }
 
-// 根据延迟时间将任务插入到相应的时间单位的定时轮中
-void TimingWheel::InsertEntry(uint32_t delay, EntryPtr entryPtr)
+// 高层槽位中的定时器离到期已经不足一个低层周期，重新放置到低层
+int TimingWheel::Cascade(int level)
 {
-    if (delay <= 0)
-    {
-        entryPtr.reset();
-    }
+    int shift = kTimingRootBits + (level - 1) * kTimingLevelBits;
+    int index = (current_ >> shift) & kTimingLevelMask;
 
-    if (delay < kTimingMinute)
-    {
-        InsertSecondEntry(delay, entryPtr);
-    }
-    else if (delay < kTimingHour)
+    TimerLink list;
+    list.prev = &list;
+    list.next = &list;
+    Splice(slots_[level][index], list);
+
+    while (!Empty(list))
     {
-        InsertMinuteEntry(delay, entryPtr);
+        Timer *timer = static_cast<Timer*>(list.next);
+        timer->Unlink();
+        Place(timer);
     }
-    else if (delay < kTimingDay)
+
+    return index;
+}
+
+// 推进时间轮直到 now，逐毫秒处理第一层的槽位
+void TimingWheel::OnTimer(int64_t now)
+{
+    if (current_ == 0)
     {
-        InsertHourEntry(delay, entryPtr);
+        current_ = now;
     }
-    else
+
+    while (current_ <= now)
     {
-        auto day = delay / kTimingDay;
-        if (day > 30)
+        int index = current_ & kTimingRootMask;
+
+        // 第一层转完一圈，依次从高层下放
+        if (index == 0)
         {
-            NETWORK_ERROR << " Not support delay more than 30 days ! ";
-            
-            return;
+            for (int level = 1; level < kTimingLevels; level++)
+            {
+                if (Cascade(level) != 0)
+                {
+                    break;
+                }
+            }
         }
 
-        InsertDayEntry(delay, entryPtr);
+        // 先取出到期的链表再推进时间，回调中插入的定时器不会落入正在处理的槽位
+        TimerLink list;
+        list.prev = &list;
+        list.next = &list;
+        Splice(slots_[0][index], list);
+        ++current_;
+
+        Expire(list);
     }
 }
 
-// 实现了一个定时轮算法，用于处理不同级别的定时任务
-void TimingWheel::OnTimer(int64_t now)
+// 执行到期的定时器，回调中可以插入或取消任意定时器，包括链表中尚未执行的定时器
+void TimingWheel::Expire(TimerLink &list)
 {
-    if (last_ts_ == 0)
+    while (!Empty(list))
     {
-        last_ts_ = now;
+        Timer *timer = static_cast<Timer*>(list.next);
+        timer->Unlink();
+
+        // 通过 InsertEntry 插入的条目，先归还定时器再释放引用，条目析构时可以重新插入
+        if (timer->entry)
+        {
+            EntryPtr entry = std::move(timer->entry);
+            ReleaseTimer(timer);
+            entry.reset();
+            continue;
+        }
+
+        // 回调中可能销毁嵌入定时器的对象，先记录是否来自对象池
+        bool pooled = timer->pooled;
+
+        // 重复执行的定时器先重新插入，回调中可以取消
+        if (timer->interval > 0)
+        {
+            timer->expire += timer->interval;
+            if (timer->expire < current_)
+            {
+                timer->expire = current_;
+            }
+            Place(timer);
+        }
+
+        if (timer->cb)
+        {
+            timer->cb();
+        }
+
+        // 对象池中的单次定时器执行完毕后归还
+        if (pooled && !timer->Pending())
+        {
+            ReleaseTimer(timer);
+        }
     }
+}
 
-    // ms
-    if (now - last_ts_ < 1000)
+// 第一层有定时器时返回精确的等待时间，否则等到第一层转完一圈再下放高层的定时器
+int64_t TimingWheel::NextTimeout(int64_t now, int64_t max_wait) const
+{
+    if (current_ == 0)
     {
-        return;
+        return max_wait;
     }
 
-    last_ts_ = now;
-    ++tick_;
-
-    // 处理秒级定时器
-    PopUp(wheels_[kTimingTypeSecond]);
-
-    if (tick_ % kTimingMinute == 0)
+    int64_t limit = max_wait + now - current_;
+    if (limit > kTimingRootSize)
     {
-        // 处理分钟级定时器
-        PopUp(wheels_[kTimingTypeMinute]);
+        limit = kTimingRootSize;
     }
-    else if (tick_ % kTimingHour == 0)
+
+    // 第一层中的定时器都在 [current_, current_ + 256) 之内到期
+    for (int64_t d = 0; d < limit; d++)
     {
-        // 处理小时级定时器
-        PopUp(wheels_[kTimingTypeHour]);
+        if (!Empty(slots_[0][(current_ + d) & kTimingRootMask]))
+        {
+            int64_t wait = current_ + d - now;
+            return wait > 0 ? wait : 0;
+        }
     }
-    else if (tick_ % kTimingDay == 0)
+
+    // 第一层为空，最晚在第一层转完一圈时醒来下放
+    int64_t wait = kTimingRootSize - (current_ & kTimingRootMask) + current_ - now;
+    for (int level = 1; level < kTimingLevels; level++)
     {
-        // 处理天级定时器
-        PopUp(wheels_[kTimingTypeDay]); 
+        for (auto &slot : slots_[level])
+        {
+            if (!Empty(slot))
+            {
+                return wait < max_wait ? (wait > 0 ? wait : 0) : max_wait;
+            }
+        }
     }
+
+    // 没有任何定时器
+    return max_wait;
 }
 
-// 弹出时间轮中的元素
-void TimingWheel::PopUp(Wheel &bq)
+// 根据延迟时间将条目插入时间轮，到期时释放一次引用
+void TimingWheel::InsertEntry(uint32_t delay, EntryPtr entryPtr)
 {
-    // bq.front().clear();
-    WheelEntry tmp;             // 创建一个临时变量 tmp
-    bq.front().swap(tmp);       // 将 bq 中的第一个元素交换到 tmp 中
-    bq.pop_front();             // 将 bq 中的第一个元素弹出
-    bq.push_back(WheelEntry()); // 将 bq 中的最后一个元素设置为一个空的 WheelEntry 对象
+    if (delay <= 0)
+    {
+        entryPtr.reset();
+        return;
+    }
 
+    Timer *timer = AcquireTimer();
+    timer->entry = std::move(entryPtr);
+    AddTimer(timer, (int64_t)delay * 1000);
 }
 
 // 在指定的延迟时间后执行传入的函数对象cb
 void TimingWheel::RunAfter(double delay, const Func &cb)
 {
-    // 创建了一个名为 cbEntryPtr 的智能指针，指向一个 CallbackEntry 对象
-    // CallbackEntry 是一个自定义的类，接收一个函数对象作为构造函数参数
-    // 使用 lambda 表达式创建了一个匿名函数，该函数没有参数，但会调用传入的函数对象 cb
-    CallbackEntryPtr cbEntryPtr = std::make_shared<CallbackEntry>([cb]() {
-        cb();
-    });
-
-    // 将匿名函数作为参数传递给 CallbackEntry 的构造函数，创建一个 CallbackEntry 对象，并将其存储在 cbEntryPtr 指向的内存位置
-    InsertEntry(delay, cbEntryPtr);
+    Timer *timer = AcquireTimer();
+    timer->cb = cb;
+    AddTimer(timer, ToMs(delay));
 }
 
-// 右值引用：提高性能和资源利用效率，实现完美转发（将传入的函数对象以相同的方式传递给其他函数，可以避免函数重载和模板函数的冗余代码，提高代码的可维护性和灵活性）
-// 使用左值引用 (const Func&) ，会导致额外的拷贝构造函数调用，从而产生额外的开销，使用右值引用 (Func&&) 可以避免额外的拷贝操作，直接将函数对象的所有权转移给新创建的 CallbackEntry 对象
+// 右值引用：直接将函数对象的所有权转移给定时器，避免额外的拷贝
 void TimingWheel::RunAfter(double delay, Func &&cb)
 {
-    CallbackEntryPtr cbEntryPtr = std::make_shared<CallbackEntry>([cb]() {
-        cb();
-    });
-
-    InsertEntry(delay, cbEntryPtr);
+    Timer *timer = AcquireTimer();
+    timer->cb = std::move(cb);
+    AddTimer(timer, ToMs(delay));
 }
 
-// 在指定的间隔时间内重复执行传入的函数对象 cb ，并将每次执行的回调函数都存储在 CallbackEntry 对象中
+// 在指定的间隔时间内重复执行传入的函数对象 cb，定时器到期后按间隔重新插入，不再每次创建新的条目
 void TimingWheel::RunEvery(double interval, const Func &cb)
 {
-    CallbackEntryPtr cbEntryPtr = std::make_shared<CallbackEntry>([this, cb, interval]() {
-        cb();
-
-        RunEvery(interval, cb);
-    });
-
-    // 调用 InsertEntry 函数，将间隔和 cbEntryPtr 作为参数传递进去
-    InsertEntry(interval, cbEntryPtr);
+    Timer *timer = AcquireTimer();
+    timer->cb = cb;
+    timer->interval = ToMs(interval) > 0 ? ToMs(interval) : 1;
+    AddTimer(timer, timer->interval);
 }
 
 // 右值引用
 void TimingWheel::RunEvery(double interval, Func &&cb)
 {
-    CallbackEntryPtr cbEntryPtr = std::make_shared<CallbackEntry>([this, cb, interval]() {
-        cb();
+    Timer *timer = AcquireTimer();
+    timer->cb = std::move(cb);
+    timer->interval = ToMs(interval) > 0 ? ToMs(interval) : 1;
+    AddTimer(timer, timer->interval);
+}
 
-        RunEvery(interval, cb);
-    });
+// 从对象池获取定时器，对象池为空时才分配
+Timer *TimingWheel::AcquireTimer()
+{
+    if (free_list_)
+    {
+        Timer *timer = free_list_;
+        free_list_ = static_cast<Timer*>(timer->next);
+        timer->next = nullptr;
+        return timer;
+    }
+
+    pool_.emplace_back(new Timer());
+    Timer *timer = pool_.back().get();
+    timer->pooled = true;
+    return timer;
+}
 
-    InsertEntry(interval, cbEntryPtr);
-}
\ No newline at end of file
+// 清理定时器的内容后放回对象池
+void TimingWheel::ReleaseTimer(Timer *timer)
+{
+    timer->cb = nullptr;
+    timer->entry.reset();
+    timer->interval = 0;
+    timer->next = free_list_;
+    free_list_ = timer;
+}
+
+void TimingWheel::Splice(TimerLink &from, TimerLink &to)
+{
+    if (Empty(from))
+    {
+        return;
+    }
+
+    // 把 from 的首尾节点接到 to 的尾部
+    TimerLink *first = from.next;
+    TimerLink *last = from.prev;
+
+    first->prev = to.prev;
+    to.prev->next = first;
+    last->next = &to;
+    to.prev = last;
+
+    from.prev = &from;
+    from.next = &from;
+}
+
+int64_t TimingWheel::ToMs(double seconds)
+{
+    return (int64_t)std::llround(seconds * 1000);
+}
@@ -3,70 +3,93 @@
 #include <functional>
 #include <cstdint>
 #include <vector>
-#include <deque>
-#include <unordered_set>
 
 namespace lss
 {
     namespace network
     {
         // EntryPtr 是 std::shared_ptr<void> 的别名，用于管理动态分配的内存资源，void 表示这个智能指针可以指向任意类型的对象
+        // 通过 InsertEntry 插入的条目在到期时释放一次引用，最后一个引用释放时由条目的析构函数执行超时逻辑
         using EntryPtr = std::shared_ptr<void>;
 
-        // WheelEntry 是 std::unordered_set<EntryPtr> 的别名，用于存储不重复的元素，WheelEntry 是一个无序集合，其中的元素类型是 EntryPtr
-        using WheelEntry = std::unordered_set<EntryPtr>;
-
-        // Wheel 是 std::deque<WheelEntry> 的别名，用于在两端进行高效的插入和删除操作，Wheel 是一个双端队列，其中的元素类型是 WheelEntry
-        using Wheel = std::deque<WheelEntry>;
-
-        // Wheels 是 std::vector<Wheel> 的别名，用于存储可变大小的元素序列，Wheels 是一个动态数组，其中的元素类型是 Wheel
-        using Wheels = std::vector<Wheel>;
-
         // Func 是 std::function<void()> 的别名，用于存储和调用各种可调用对象（函数、函数指针、成员函数指针等），Func是一个函数类型，接收无参数并且没有返回值
         using Func = std::function<void()>;
 
-        // 一分钟的秒数，用于实现定时轮算法的相关功能
-        const int kTimingMinute = 60;
+        // 时间轮的层数
+        const int kTimingLevels = 5;
 
-        // 一小时的秒数，用于实现定时轮算法的相关功能
-        const int kTimingHour = 60 * 60;
+        // 第一层的槽位数（位数），每个槽位 1 毫秒，覆盖 256 毫秒
+        const int kTimingRootBits = 8;
+        const int kTimingRootSize = 1 << kTimingRootBits;
+        const int kTimingRootMask = kTimingRootSize - 1;
 
-        // 一天的秒数，用于实现定时轮算法的相关功能
-        const int kTimingDay = 60 * 60 * 24;
+        // 其余各层的槽位数（位数），每层覆盖的时间是上一层的 64 倍，共约 49 天
+        const int kTimingLevelBits = 6;
+        const int kTimingLevelSize = 1 << kTimingLevelBits;
+        const int kTimingLevelMask = kTimingLevelSize - 1;
 
-        enum TimingType
+        // 定时器链表节点
+        struct TimerLink
         {
-            kTimingTypeSecond = 0,  // 秒级定时类型
-            kTimingTypeMinute = 1,  // 分钟级定时类型
-            kTimingTypeHour = 2,    // 小时级定时类型
-            kTimingTypeDay = 3      // 天级定时类型
+            TimerLink *prev{nullptr};
+            TimerLink *next{nullptr};
         };
 
-        class CallbackEntry
+        // 侵入式定时器，可以直接嵌入到其他对象中，插入和取消不分配内存
+        // 定时器析构时如果仍在时间轮中会自动摘除，所以嵌入的对象可以在任意时刻销毁
+        struct Timer : public TimerLink
         {
-        public:
-            // 构造函数，接收一个 Func 类型的参数 cb，将其赋值给成员变量 cb_
-            CallbackEntry(const Func &cb) : cb_(cb) {}
+            Timer() = default;
 
-            // 析构函数，当 CallbackEntry 对象被销毁时调用
-            ~CallbackEntry()
+            explicit Timer(const Func &f) : cb(f) {}
+
+            explicit Timer(Func &&f) : cb(std::move(f)) {}
+
+            Timer(const Timer&) = delete;
+            Timer &operator=(const Timer&) = delete;
+
+            ~Timer()
             {
-                // 检查 cb_ 是否为空，如果不为空，则调用回调函数 cb_()
-                if (cb_)
+                Unlink();
+            }
+
+            // 是否在时间轮中等待
+            bool Pending() const
+            {
+                return prev != nullptr;
+            }
+
+            // 从所在的链表中摘除
+            void Unlink()
+            {
+                if (prev)
                 {
-                    cb_();
+                    prev->next = next;
+                    next->prev = prev;
+                    prev = nullptr;
+                    next = nullptr;
                 }
             }
 
-        private:
-            // 存储回调函数
-            Func cb_;
-        };
+            // 到期时间，单位：毫秒
+            int64_t expire{0};
 
-        // CallbackEntryPtr 是一个指向 CallbackEntry 类对象的 std::shared_ptr 智能指针的别名，用于创建和管理 CallbackEntry 对象的共享指针
-        // 使用共享指针可以自动管理对象的生命周期，避免内存泄漏和悬空指针的问题
-        using CallbackEntryPtr = std::shared_ptr<CallbackEntry>;
+            // 重复间隔，单位：毫秒，大于 0 时到期后自动重新插入
+            int64_t interval{0};
 
+            // 到期回调
+            Func cb;
+
+            // 由时间轮的对象池分配，执行完毕后归还
+            bool pooled{false};
+
+            // 通过 InsertEntry 插入的条目，到期时释放
+            EntryPtr entry;
+        };
+
+        // 分层时间轮，精度为 1 毫秒
+        // 第一层 256 个槽位，每个槽位 1 毫秒；其余 4 层各 64 个槽位，高层的槽位到期时整体下放到低层
+        // 插入和取消都是 O(1)，只能在事件循环线程中使用
         class TimingWheel
         {
         public:
@@ -76,48 +99,75 @@ namespace lss
             // 析构函数，释放 TimingWheel 对象占用的资源
             ~TimingWheel();
 
-            // 插入一个延迟为 delay 的条目 entryPtr
+            TimingWheel(const TimingWheel&) = delete;
+            TimingWheel &operator=(const TimingWheel&) = delete;
+
+            // 插入定时器，delay 毫秒后到期，定时器已经在时间轮中时先取消
+            void AddTimer(Timer *timer, int64_t delay);
+
+            // 取消定时器
+            void CancelTimer(Timer *timer);
+
+            // 插入一个延迟为 delay 秒的条目 entryPtr
             void InsertEntry(uint32_t delay, EntryPtr entryPtr);
 
-            // 定时器触发时调用的函数，传入当前时间 now
+            // 定时器触发时调用的函数，传入当前时间 now，执行所有到期的定时器
             void OnTimer(int64_t now);
 
-            // 将 bq 中的条目弹出
-            void PopUp(Wheel &bq);
+            // 距离下一个定时器到期的毫秒数，最多返回 max_wait，用于计算事件循环的等待时间
+            int64_t NextTimeout(int64_t now, int64_t max_wait) const;
 
-            // 延迟 delay 后执行回调函数 cb
+            // 延迟 delay 秒后执行回调函数 cb，支持小数
             void RunAfter(double delay, const Func &cb);
 
-            // 延迟 delay 后执行右值引用的回调函数 cb
+            // 延迟 delay 秒后执行右值引用的回调函数 cb
             void RunAfter(double delay, Func &&cb);
 
-            // 每隔 interval 执行一次回调函数 cb
+            // 每隔 interval 秒执行一次回调函数 cb，支持小数
             void RunEvery(double interval, const Func &cb);
 
-            // 每隔 interval 执行一次右值引用的回调函数 cb
+            // 每隔 interval 秒执行一次右值引用的回调函数 cb
             void RunEvery(double interval, Func &&cb);
 
         private:
-            // 插入一个延迟为 delay 的秒级条目 entryPtr
-            void InsertSecondEntry(uint32_t delay, EntryPtr entryPtr);
+            // 按到期时间把定时器放入对应层的槽位
+            void Place(Timer *timer);
 
-            // 插入一个延迟为 delay 的分钟级条目 entryPtr
-            void InsertMinuteEntry(uint32_t delay, EntryPtr entryPtr);
+            // 把高层 level 中当前的槽位下放到低层，返回该层的槽位下标
+            int Cascade(int level);
+
+            // 执行一个链表中的所有定时器
+            void Expire(TimerLink &list);
+
+            // 从对象池获取一个定时器
+            Timer *AcquireTimer();
+
+            // 归还定时器到对象池
+            void ReleaseTimer(Timer *timer);
+
+            // 把 from 中的所有节点移到 to 的尾部
+            static void Splice(TimerLink &from, TimerLink &to);
+
+            // 链表是否为空
+            static bool Empty(const TimerLink &list)
+            {
+                return list.next == &list;
+            }
 
-            // 插入一个延迟为 delay 的小时级条目 entryPtr
-            void InsertHourEntry(uint32_t delay, EntryPtr entryPtr);
+            // 秒转换为毫秒
+            static int64_t ToMs(double seconds);
 
-            // 插入一个延迟为 delay 的天级条目 entryPtr
-            void InsertDayEntry(uint32_t delay, EntryPtr entryPtr);
+            // 各层的槽位，第一层 kTimingRootSize 个，其余各层 kTimingLevelSize 个
+            std::vector<TimerLink> slots_[kTimingLevels];
 
-            // 时间轮
-            Wheels wheels_;
+            // 下一个要处理的毫秒，0 表示尚未初始化
+            int64_t current_{0};
 
-            // 上次触发定时器的时间戳，默认为 0
-            int64_t last_ts_{0};
+            // 对象池中空闲的定时器
+            Timer *free_list_{nullptr};
 
-            // 定时器的滴答数，默认为 0
-            uint64_t tick_{0};
+            // 对象池中所有的定时器
+            std::vector<std::unique_ptr<Timer>> pool_;
         };
     }
-}
\ No newline at end of file
+}
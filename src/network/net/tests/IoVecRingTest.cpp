@@ -0,0 +1,175 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <list>
+#include <cstring>
+#include <climits>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "network/net/IoVecRing.h"
+#include "network/net/EventLoopThread.h"
+#include "network/TcpServer.h"
+
+using namespace lss::network;
+
+// 一次发送的数据块数量，超过 IOV_MAX
+const int kNodes = 5000;
+
+// 每个数据块的大小
+const size_t kNodeSize = 100;
+
+// 发送的数据，每个数据块的内容是它的序号
+static char payload[kNodes * kNodeSize];
+
+// 测试环形队列的绕回、扩容和部分消费
+bool TestRing()
+{
+    IoVecRing ring(4);
+    char buf[64];
+
+    // 推进头部之后再追加，让数据绕回数组开头
+    ring.Push(buf, 10);
+    ring.Push(buf + 10, 10);
+    ring.Push(buf + 20, 10);
+    ring.Consume(25);
+    ring.Push(buf + 30, 10);
+    ring.Push(buf + 40, 10);
+
+    // 头部到数组末尾只有 2 个连续的元素
+    if (ring.Size() != 3 || ring.Bytes() != 25 || ring.Batch(IOV_MAX) != 2)
+    {
+        return false;
+    }
+    if (ring.Front()->iov_base != buf + 25 || ring.Front()->iov_len != 5)
+    {
+        return false;
+    }
+
+    // 扩容后元素按顺序搬到开头，全部连续
+    ring.Push(buf + 50, 10);
+    ring.Push(buf + 60, 4);
+    if (ring.Size() != 5 || ring.Bytes() != 39 || ring.Batch(IOV_MAX) != 5 || ring.Batch(3) != 3)
+    {
+        return false;
+    }
+
+    ring.Consume(39);
+    return ring.Empty() && ring.Bytes() == 0;
+}
+
+// 客户端读取全部数据，校验内容
+bool RunClient(uint16_t port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    std::vector<char> buf(sizeof(payload));
+    size_t got = 0;
+    while (got < buf.size())
+    {
+        auto ret = ::read(fd, &buf[got], buf.size() - got);
+        if (ret <= 0)
+        {
+            break;
+        }
+        got += ret;
+    }
+
+    ::close(fd);
+    return got == buf.size() && memcmp(&buf[0], payload, buf.size()) == 0;
+}
+
+// 连接建立后一次发送 kNodes 个数据块，客户端应该收到完整有序的数据
+void TestSend(PollerType type, const char *name, uint16_t port)
+{
+    EventLoopThread thread(type);
+    thread.Run();
+    EventLoop *loop = thread.Loop();
+
+    std::list<BufferNodePtr> nodes;
+    for (int i = 0; i < kNodes; i++)
+    {
+        nodes.emplace_back(std::make_shared<BufferNode>(payload + i * kNodeSize, kNodeSize));
+    }
+
+    // 服务对象一直保留到进程结束，Acceptor 析构时会调用 shared_from_this
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *server = new TcpServer(loop, listen);
+    server->SetNewConnectionCallback([&nodes](const TcpConnectionPtr &con){
+        con->Send(nodes);
+    });
+
+    loop->RunInLoop([server](){
+        server->Start();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    bool ok = RunClient(port);
+    std::cout << name << "\t: send " << kNodes << " buffers " << (ok ? "ok" : "failed") << std::endl;
+
+    loop->RunInLoop([server](){
+        server->Stop();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+// 以 iovec 数组一次发送 kNodes 个数据块，不创建节点
+void TestSendIoVec(const char *name, uint16_t port)
+{
+    EventLoopThread thread(kPollerEpoll);
+    thread.Run();
+    EventLoop *loop = thread.Loop();
+
+    std::vector<struct iovec> iovs;
+    for (int i = 0; i < kNodes; i++)
+    {
+        iovs.push_back({payload + i * kNodeSize, kNodeSize});
+    }
+
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *server = new TcpServer(loop, listen);
+    server->SetNewConnectionCallback([&iovs](const TcpConnectionPtr &con){
+        con->Send(iovs.data(), iovs.size());
+    });
+
+    loop->RunInLoop([server](){
+        server->Start();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    bool ok = RunClient(port);
+    std::cout << name << "\t: send " << kNodes << " iovecs " << (ok ? "ok" : "failed") << std::endl;
+
+    loop->RunInLoop([server](){
+        server->Stop();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+int main(int argc, const char **argv)
+{
+    for (int i = 0; i < kNodes; i++)
+    {
+        memset(payload + i * kNodeSize, i & 0xff, kNodeSize);
+    }
+
+    std::cout << "ring\t: " << (TestRing() ? "ok" : "failed") << std::endl;
+
+    TestSend(kPollerEpoll, "epoll", 34511);
+    TestSend(kPollerIoUring, "io_uring", 34512);
+    TestSendIoVec("iovec", 34513);
+
+    return 0;
+}
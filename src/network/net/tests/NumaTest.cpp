@@ -0,0 +1,40 @@
+#include <iostream>
+#include <thread>
+#include "network/net/EventLoopThreadPool.h"
+#include "base/NumaUtils.h"
+
+using namespace lss::network;
+using namespace lss::base;
+
+// 按 NUMA 节点分配时事件循环轮流分布在各个节点上，记录的节点与绑定的 CPU 一致
+int main(int argc, const char **argv)
+{
+    int cpus = std::thread::hardware_concurrency();
+    int nodes = NumaUtils::Nodes();
+
+    EventLoopThreadPool pool(cpus, 0, cpus, kPollerEpoll, true);
+    pool.Start();
+
+    auto loops = pool.GetLoops();
+    auto bound = pool.GetCpus();
+    bool ok = true;
+    for (size_t i = 0; i < loops.size(); i++)
+    {
+        std::cout << "loop " << i << "\t: cpu " << bound[i] << " node " << loops[i]->Node() << std::endl;
+
+        if (loops[i]->Node() != NumaUtils::NodeOfCpu(bound[i]))
+        {
+            ok = false;
+        }
+
+        // 前 nodes 个事件循环各在一个节点上
+        if (i > 0 && i < (size_t)nodes && loops[i]->Node() == loops[i - 1]->Node())
+        {
+            ok = false;
+        }
+    }
+
+    std::cout << "nodes " << nodes << "\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    return 0;
+}
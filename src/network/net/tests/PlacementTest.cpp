@@ -0,0 +1,184 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <atomic>
+#include <string>
+#include <cstring>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "network/net/EventLoopThreadPool.h"
+#include "network/TcpServer.h"
+
+using namespace lss::network;
+
+// 输出事件循环的负载
+void PrintLoad(const char *name, EventLoop *loop)
+{
+    LoopLoad load = loop->Load();
+    std::cout << name << "\t: connections " << load.connections << " bytes/s " << load.bytes_per_sec
+              << " busy " << load.busy_permille / 10 << "%" << std::endl;
+}
+
+// 连接数不同时选择连接数最少的事件循环，某个事件循环繁忙时避开它
+bool TestLeastLoaded(EventLoopThreadPool &pool)
+{
+    auto loops = pool.GetLoops();
+    loops[0]->AddConnection(5);
+    loops[1]->AddConnection(2);
+
+    bool ok = pool.GetNextLoop() == loops[2];
+
+    // 连接数相同，第三个事件循环繁忙 1.5 秒，空闲时最长等待 1 秒才醒来发布统计结果，之后应该避开它
+    loops[2]->AddConnection(2);
+    loops[0]->AddConnection(-3);
+    loops[2]->RunInLoop([](){
+        auto end = std::chrono::steady_clock::now() + std::chrono::milliseconds(1500);
+        while (std::chrono::steady_clock::now() < end)
+        {
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(2700));
+
+    PrintLoad("loop0", loops[0]);
+    PrintLoad("loop1", loops[1]);
+    PrintLoad("loop2", loops[2]);
+
+    for (int i = 0; i < 10; i++)
+    {
+        if (pool.GetNextLoop() == loops[2])
+        {
+            ok = false;
+        }
+    }
+
+    // 恢复计数，不影响后面的测试
+    loops[0]->AddConnection(-2);
+    loops[1]->AddConnection(-2);
+    loops[2]->AddConnection(-2);
+
+    return ok;
+}
+
+// 一个服务接受连接，选择器把文件描述符交给另一个事件循环上的服务，连接对象在目标事件循环中创建
+bool TestHandoff(EventLoopThreadPool &pool, uint16_t port)
+{
+    auto loops = pool.GetLoops();
+
+    // 服务对象一直保留到进程结束，Acceptor 析构时会调用 shared_from_this
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *acceptor = new TcpServer(loops[0], listen);
+    TcpServer *target = new TcpServer(loops[1], listen);
+
+    std::promise<bool> created;
+    target->SetNewConnectionCallback([&created, target](const TcpConnectionPtr &con){
+        created.set_value(target->Loop()->IsInLoopThread());
+    });
+    acceptor->SetServerSelector([target]() -> TcpServer * {
+        return target;
+    });
+
+    loops[0]->RunInLoop([acceptor](){
+        acceptor->Start();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool ok = ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+
+    auto future = created.get_future();
+    ok = ok && future.wait_for(std::chrono::seconds(1)) == std::future_status::ready && future.get();
+    ok = ok && loops[1]->Load().connections == 1 && loops[0]->Load().connections == 0;
+
+    ::close(fd);
+    loops[0]->RunInLoop([acceptor](){
+        acceptor->Stop();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return ok;
+}
+
+// 收到第一条消息后把连接迁移到另一个事件循环，之后的消息在新的事件循环中处理并回显
+bool TestMigrate(EventLoopThreadPool &pool, uint16_t port)
+{
+    auto loops = pool.GetLoops();
+
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *source = new TcpServer(loops[0], listen);
+    TcpServer *target = new TcpServer(loops[2], listen);
+
+    std::atomic<bool> migrated{false};
+    std::atomic<bool> in_target{false};
+    source->SetMessageCallback([source, target, &migrated, &in_target](const TcpConnectionPtr &con, MsgBuffer &buf){
+        std::string msg(buf.Peek(), buf.ReadableBytes());
+        buf.RetrieveAll();
+
+        if (msg == "migrate")
+        {
+            source->MigrateConnection(con, target, [&migrated, target](bool ok){
+                migrated = ok && target->Loop()->IsInLoopThread();
+            });
+            return;
+        }
+
+        // 迁移之后的消息由目标事件循环分发
+        in_target = con->Loop() == target->Loop() && target->Loop()->IsInLoopThread();
+        con->Send(msg.data(), msg.size());
+    });
+
+    loops[0]->RunInLoop([source](){
+        source->Start();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    bool ok = ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+
+    ok = ok && ::write(fd, "migrate", 7) == 7;
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    ok = ok && ::write(fd, "hello", 5) == 5;
+
+    char buf[16] = {0};
+    ok = ok && ::read(fd, buf, sizeof(buf)) == 5 && memcmp(buf, "hello", 5) == 0;
+    ok = ok && migrated && in_target;
+    ok = ok && loops[2]->Load().connections == 1 && loops[0]->Load().connections == 0;
+
+    ::close(fd);
+    loops[0]->RunInLoop([source](){
+        source->Stop();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return ok;
+}
+
+int main(int argc, const char **argv)
+{
+    EventLoopThreadPool pool(3, 0, 0);
+    pool.SetPlacement(EventLoopThreadPool::ParsePlacement("least_loaded"));
+    pool.Start();
+
+    bool ok = TestLeastLoaded(pool);
+    std::cout << "least loaded\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    ok = TestHandoff(pool, 34521);
+    std::cout << "handoff\t\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    ok = TestMigrate(pool, 34522);
+    std::cout << "migrate\t\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,135 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <cstring>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "network/net/EventLoop.h"
+#include "network/net/EventLoopThread.h"
+#include "network/TcpServer.h"
+
+using namespace lss::network;
+
+// 请求大小
+const size_t kRequestSize = 1024;
+
+// 响应大小
+const size_t kResponseSize = 64 * 1024;
+
+// 客户端数量
+const int kClients = 8;
+
+// 每个客户端的请求次数
+const int kRounds = 2000;
+
+// 响应内容，发送完成之前必须保持有效
+static char response[kResponseSize];
+
+// 客户端：发送请求，读取完整的响应，重复 kRounds 次，返回是否成功
+bool RunClient(int port)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        ::close(fd);
+        return false;
+    }
+
+    char request[kRequestSize] = {0};
+    std::vector<char> buf(kResponseSize);
+    for (int i = 0; i < kRounds; i++)
+    {
+        if (::write(fd, request, kRequestSize) != (ssize_t)kRequestSize)
+        {
+            ::close(fd);
+            return false;
+        }
+
+        size_t left = kResponseSize;
+        while (left > 0)
+        {
+            auto ret = ::read(fd, &buf[0], left);
+            if (ret <= 0)
+            {
+                ::close(fd);
+                return false;
+            }
+            left -= ret;
+        }
+    }
+
+    ::close(fd);
+    return true;
+}
+
+// 在指定后端上启动服务，每收到一个完整的请求回复一个响应
+void Test(PollerType type, const char *name, uint16_t port)
+{
+    EventLoopThread thread(type);
+    thread.Run();
+    EventLoop *loop = thread.Loop();
+
+    // 服务对象一直保留到进程结束，Acceptor 析构时会调用 shared_from_this
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *server = new TcpServer(loop, listen);
+
+    server->SetMessageCallback([](const TcpConnectionPtr &con, MsgBuffer &buff){
+        while (buff.ReadableBytes() >= kRequestSize)
+        {
+            buff.Retrieve(kRequestSize);
+            con->Send(response, kResponseSize);
+        }
+    });
+
+    loop->RunInLoop([server](){
+        server->Start();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    std::atomic<int> ok{0};
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> clients;
+    for (int i = 0; i < kClients; i++)
+    {
+        clients.emplace_back([&ok, port](){
+            if (RunClient(port))
+            {
+                ok++;
+            }
+        });
+    }
+
+    for (auto &t : clients)
+    {
+        t.join();
+    }
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    int64_t requests = (int64_t)kClients * kRounds;
+    std::cout << name << "\t: " << ok << "/" << kClients << " clients ok, "
+              << requests * 1000000 / (us > 0 ? us : 1) << " req/s, "
+              << requests * kResponseSize / (us > 0 ? us : 1) << " MB/s" << std::endl;
+
+    loop->RunInLoop([server](){
+        server->Stop();
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+}
+
+int main(int argc, const char **argv)
+{
+    Test(kPollerEpoll, "epoll", 34501);
+    Test(kPollerIoUring, "io_uring", 34502);
+
+    return 0;
+}
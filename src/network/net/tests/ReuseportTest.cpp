@@ -0,0 +1,98 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <atomic>
+#include <cstring>
+#include <pthread.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include "network/net/EventLoopThreadPool.h"
+#include "network/TcpServer.h"
+
+using namespace lss::network;
+
+// 客户端发起的连接数
+const int kConnections = 8;
+
+// 在服务自己的事件循环中启动，开始监听之后才返回，保证加入监听组的顺序
+void StartInLoop(TcpServer *server)
+{
+    std::promise<void> listened;
+    server->Loop()->RunInLoop([server, &listened](){
+        server->Start();
+        listened.set_value();
+    });
+    listened.get_future().wait();
+}
+
+// 两个监听套接字，只有第二个对应 CPU 0；客户端绑定在 CPU 0 上，回环网络在发送端的 CPU 上处理 SYN，
+// 所有连接都应该由第二个监听套接字接受
+int main(int argc, const char **argv)
+{
+    cpu_set_t cpu;
+    CPU_ZERO(&cpu);
+    CPU_SET(0, &cpu);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpu), &cpu);
+
+    EventLoopThreadPool pool(2, 0, 0);
+    pool.Start();
+    auto loops = pool.GetLoops();
+
+    // 服务对象一直保留到进程结束，Acceptor 析构时会调用 shared_from_this
+    uint16_t port = 34531;
+    InetAddress listen("127.0.0.1", port);
+    TcpServer *first = new TcpServer(loops[0], listen);
+    TcpServer *second = new TcpServer(loops[1], listen);
+
+    std::atomic<int> accepted[2];
+    accepted[0] = 0;
+    accepted[1] = 0;
+    first->SetNewConnectionCallback([&accepted](const TcpConnectionPtr &con){
+        accepted[0]++;
+    });
+    second->SetNewConnectionCallback([&accepted](const TcpConnectionPtr &con){
+        accepted[1]++;
+    });
+
+    std::vector<int> cpus = {-1, 0};
+    first->SetReuseportCpus(cpus);
+    second->SetReuseportCpus(cpus);
+    StartInLoop(first);
+    StartInLoop(second);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0x00, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    std::vector<int> fds;
+    for (int i = 0; i < kConnections; i++)
+    {
+        int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0)
+        {
+            fds.push_back(fd);
+        }
+        else
+        {
+            ::close(fd);
+        }
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    std::cout << "accepted by first : " << accepted[0] << " , second : " << accepted[1] << std::endl;
+    bool ok = (int)fds.size() == kConnections && accepted[0] == 0 && accepted[1] == kConnections;
+    std::cout << "cpu steering\t: " << (ok ? "ok" : "failed") << std::endl;
+
+    for (auto fd : fds)
+    {
+        ::close(fd);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    return 0;
+}
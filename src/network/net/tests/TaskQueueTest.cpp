@@ -0,0 +1,96 @@
+#include <iostream>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include "network/net/EventLoop.h"
+#include "network/net/EventLoopThread.h"
+
+using namespace lss::network;
+
+// 两个事件循环线程
+EventLoopThread thread_a;
+EventLoopThread thread_b;
+
+// 批量投递的任务数量
+const int64_t kBurstTasks = 2000000;
+
+// 往返投递的次数
+const int64_t kPingPongRounds = 200000;
+
+// 在循环 B 中执行的计数
+std::atomic<int64_t> counter{0};
+
+// 批量投递：循环 A 连续向循环 B 投递任务，测试队列吞吐量
+void TestBurst(EventLoop *a, EventLoop *b)
+{
+    counter = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    a->RunInLoop([b](){
+        for (int64_t i = 0; i < kBurstTasks; i++)
+        {
+            b->RunInLoop([](){
+                counter.fetch_add(1, std::memory_order_relaxed);
+            });
+        }
+    });
+
+    // 等待循环 B 执行完所有任务
+    while (counter.load() < kBurstTasks)
+    {
+        std::this_thread::yield();
+    }
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "burst     : " << kBurstTasks << " tasks, " << us / 1000 << " ms, "
+              << kBurstTasks * 1000000 / (us > 0 ? us : 1) << " tasks/s" << std::endl;
+}
+
+// 往返投递：A 投递给 B，B 再投递回 A，每次投递时对方通常处于休眠状态，测试唤醒路径
+void PingPong(EventLoop *from, EventLoop *to, int64_t left, std::promise<void> *done)
+{
+    if (left == 0)
+    {
+        done->set_value();
+        return;
+    }
+
+    to->RunInLoop([from, to, left, done](){
+        PingPong(to, from, left - 1, done);
+    });
+}
+
+void TestPingPong(EventLoop *a, EventLoop *b)
+{
+    std::promise<void> done;
+    auto start = std::chrono::steady_clock::now();
+
+    a->RunInLoop([a, b, &done](){
+        PingPong(a, b, kPingPongRounds, &done);
+    });
+
+    done.get_future().wait();
+
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "ping-pong : " << kPingPongRounds << " tasks, " << us / 1000 << " ms, "
+              << kPingPongRounds * 1000000 / (us > 0 ? us : 1) << " tasks/s" << std::endl;
+}
+
+int main(int argc, const char **argv)
+{
+    // 启动两个事件循环
+    thread_a.Run();
+    thread_b.Run();
+
+    EventLoop *a = thread_a.Loop();
+    EventLoop *b = thread_b.Loop();
+
+    for (int i = 0; i < 3; i++)
+    {
+        TestBurst(a, b);
+        TestPingPong(a, b);
+    }
+
+    return 0;
+}
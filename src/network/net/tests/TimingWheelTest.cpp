@@ -0,0 +1,97 @@
+#include <iostream>
+#include <thread>
+#include <chrono>
+#include <future>
+#include <atomic>
+#include <vector>
+#include "network/net/EventLoop.h"
+#include "network/net/EventLoopThread.h"
+#include "base/TTime.h"
+
+using namespace lss::network;
+
+// 事件循环线程
+EventLoopThread eventloop_thread;
+
+// 插入和取消测试的定时器数量
+const int kTimers = 100000;
+
+// RunEvery 的执行次数，定时器一直运行，计数不能放在栈上
+std::atomic<int> every_count{0};
+
+// 测试亚秒级的 RunAfter，输出实际延迟
+void TestRunAfter(EventLoop *loop)
+{
+    for (double delay : {0.001, 0.005, 0.02, 0.1, 0.5, 1.5})
+    {
+        std::promise<int64_t> done;
+        int64_t start = lss::base::TTime::NowMS();
+        loop->RunAfter(delay, [&done](){
+            done.set_value(lss::base::TTime::NowMS());
+        });
+
+        int64_t end = done.get_future().get();
+        std::cout << "run after " << delay * 1000 << " ms, actual : " << end - start << " ms" << std::endl;
+    }
+}
+
+// 测试 20 毫秒间隔的 RunEvery，一秒内应该执行约 50 次
+void TestRunEvery(EventLoop *loop)
+{
+    loop->RunEvery(0.02, [](){
+        every_count++;
+    });
+
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::cout << "run every 20 ms, count in 1 s : " << every_count.load() << std::endl;
+}
+
+// 测试侵入式定时器的插入、延期和取消的耗时
+void TestAddCancel(EventLoop *loop)
+{
+    std::promise<void> done;
+
+    loop->RunInLoop([loop, &done](){
+        std::vector<Timer> timers(kTimers);
+
+        auto start = std::chrono::steady_clock::now();
+
+        // 插入，延迟分布在各层
+        for (int i = 0; i < kTimers; i++)
+        {
+            loop->AddTimer(&timers[i], (i * 7919) % 3600000 + 1);
+        }
+
+        // 延期，相当于连接活跃时刷新超时
+        for (int i = 0; i < kTimers; i++)
+        {
+            loop->AddTimer(&timers[i], 30000);
+        }
+
+        // 取消
+        for (int i = 0; i < kTimers; i++)
+        {
+            loop->CancelTimer(&timers[i]);
+        }
+
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "add/readd/cancel " << kTimers << " timers : " << ns / 1000000 << " ms, "
+                  << ns / (kTimers * 3) << " ns/op" << std::endl;
+
+        done.set_value();
+    });
+
+    done.get_future().wait();
+}
+
+int main(int argc, const char **argv)
+{
+    eventloop_thread.Run();
+    EventLoop *loop = eventloop_thread.Loop();
+
+    TestRunAfter(loop);
+    TestRunEvery(loop);
+    TestAddCancel(loop);
+
+    return 0;
+}
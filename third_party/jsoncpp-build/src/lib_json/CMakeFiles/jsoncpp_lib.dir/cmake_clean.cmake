@@ -0,0 +1,17 @@
+file(REMOVE_RECURSE
+  "../../bin/libjsoncpp.pdb"
+  "../../lib/libjsoncpp.so"
+  "../../lib/libjsoncpp.so.1.9.4"
+  "../../lib/libjsoncpp.so.24"
+  "CMakeFiles/jsoncpp_lib.dir/json_reader.cpp.o"
+  "CMakeFiles/jsoncpp_lib.dir/json_reader.cpp.o.d"
+  "CMakeFiles/jsoncpp_lib.dir/json_value.cpp.o"
+  "CMakeFiles/jsoncpp_lib.dir/json_value.cpp.o.d"
+  "CMakeFiles/jsoncpp_lib.dir/json_writer.cpp.o"
+  "CMakeFiles/jsoncpp_lib.dir/json_writer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jsoncpp_lib.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,21 @@
+
+# Consider dependencies only in project.
+set(CMAKE_DEPENDS_IN_PROJECT_ONLY OFF)
+
+# The set of languages for which implicit dependencies are needed:
+set(CMAKE_DEPENDS_LANGUAGES
+  )
+
+# The set of dependency files which are needed:
+set(CMAKE_DEPENDS_DEPENDENCY_FILES
+  "/root/repo/third_party/jsoncpp/src/lib_json/json_reader.cpp" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_reader.cpp.o" "gcc" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_reader.cpp.o.d"
+  "/root/repo/third_party/jsoncpp/src/lib_json/json_value.cpp" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_value.cpp.o" "gcc" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_value.cpp.o.d"
+  "/root/repo/third_party/jsoncpp/src/lib_json/json_writer.cpp" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_writer.cpp.o" "gcc" "src/lib_json/CMakeFiles/jsoncpp_object.dir/json_writer.cpp.o.d"
+  )
+
+# Targets to which this target links.
+set(CMAKE_TARGET_LINKED_INFO_FILES
+  )
+
+# Fortran module output directory.
+set(CMAKE_Fortran_TARGET_MODULE_DIR "")
@@ -0,0 +1,13 @@
+file(REMOVE_RECURSE
+  "CMakeFiles/jsoncpp_object.dir/json_reader.cpp.o"
+  "CMakeFiles/jsoncpp_object.dir/json_reader.cpp.o.d"
+  "CMakeFiles/jsoncpp_object.dir/json_value.cpp.o"
+  "CMakeFiles/jsoncpp_object.dir/json_value.cpp.o.d"
+  "CMakeFiles/jsoncpp_object.dir/json_writer.cpp.o"
+  "CMakeFiles/jsoncpp_object.dir/json_writer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jsoncpp_object.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()
@@ -0,0 +1,15 @@
+file(REMOVE_RECURSE
+  "../../bin/libjsoncpp_static.pdb"
+  "../../lib/libjsoncpp_static.a"
+  "CMakeFiles/jsoncpp_static.dir/json_reader.cpp.o"
+  "CMakeFiles/jsoncpp_static.dir/json_reader.cpp.o.d"
+  "CMakeFiles/jsoncpp_static.dir/json_value.cpp.o"
+  "CMakeFiles/jsoncpp_static.dir/json_value.cpp.o.d"
+  "CMakeFiles/jsoncpp_static.dir/json_writer.cpp.o"
+  "CMakeFiles/jsoncpp_static.dir/json_writer.cpp.o.d"
+)
+
+# Per-language clean rules from dependency scanning.
+foreach(lang CXX)
+  include(CMakeFiles/jsoncpp_static.dir/cmake_clean_${lang}.cmake OPTIONAL)
+endforeach()